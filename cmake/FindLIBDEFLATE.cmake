@@ -0,0 +1,18 @@
+# Finds the libdeflate library. This module defines:
+#   - LIBDEFLATE_INCLUDE_DIR, directory containing headers
+#   - LIBDEFLATE_LIBRARIES, the libdeflate library path
+#   - LIBDEFLATE_FOUND, whether libdeflate has been found
+
+find_path(LIBDEFLATE_INCLUDE_DIR libdeflate.h)
+find_library(LIBDEFLATE_LIBRARIES NAMES deflate libdeflate)
+
+if(LIBDEFLATE_INCLUDE_DIR AND LIBDEFLATE_LIBRARIES)
+  message(STATUS "Found libdeflate: ${LIBDEFLATE_LIBRARIES}")
+  set(LIBDEFLATE_FOUND TRUE)
+else()
+  set(LIBDEFLATE_FOUND FALSE)
+endif()
+
+if(LIBDEFLATE_FIND_REQUIRED AND NOT LIBDEFLATE_FOUND)
+  message(FATAL_ERROR "Could not find the libdeflate library.")
+endif()
@@ -0,0 +1,18 @@
+# Finds the zfp library. This module defines:
+#   - ZFP_INCLUDE_DIR, directory containing headers
+#   - ZFP_LIBRARIES, the zfp library path
+#   - ZFP_FOUND, whether zfp has been found
+
+find_path(ZFP_INCLUDE_DIR zfp.h)
+find_library(ZFP_LIBRARIES NAMES zfp)
+
+if(ZFP_INCLUDE_DIR AND ZFP_LIBRARIES)
+  message(STATUS "Found zfp: ${ZFP_LIBRARIES}")
+  set(ZFP_FOUND TRUE)
+else()
+  set(ZFP_FOUND FALSE)
+endif()
+
+if(ZFP_FIND_REQUIRED AND NOT ZFP_FOUND)
+  message(FATAL_ERROR "Could not find the zfp library.")
+endif()
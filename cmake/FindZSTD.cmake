@@ -0,0 +1,18 @@
+# Finds the zstd library. This module defines:
+#   - ZSTD_INCLUDE_DIR, directory containing headers
+#   - ZSTD_LIBRARIES, the zstd library path
+#   - ZSTD_FOUND, whether zstd has been found
+
+find_path(ZSTD_INCLUDE_DIR zstd.h)
+find_library(ZSTD_LIBRARIES NAMES zstd)
+
+if(ZSTD_INCLUDE_DIR AND ZSTD_LIBRARIES)
+  message(STATUS "Found zstd: ${ZSTD_LIBRARIES}")
+  set(ZSTD_FOUND TRUE)
+else()
+  set(ZSTD_FOUND FALSE)
+endif()
+
+if(ZSTD_FIND_REQUIRED AND NOT ZSTD_FOUND)
+  message(FATAL_ERROR "Could not find the zstd library.")
+endif()
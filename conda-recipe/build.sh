@@ -49,6 +49,9 @@ cmake .. \
         -DWITH_BLOSC=ON \
         -DWITH_ZLIB=ON \
         -DWITH_BZIP2=ON \
+        -DWITH_LIBDEFLATE=ON \
+        -DWITH_ZSTD=ON \
+        -DWITH_ZFP=ON \
 \
         -DBUILD_Z5_PYTHON=ON \
         -DPYTHON_EXECUTABLE=${PYTHON} \
@@ -1,5 +1,6 @@
 #pragma once
 #include "z5/dataset.hxx"
+#include "z5/util/strided_copy.hxx"
 #include "andres/marray.hxx"
 
 namespace z5 {
@@ -8,23 +9,23 @@ namespace z5 {
     void writeScalar(const Dataset & ds, ITER roiBeginIter, ITER roiShapeIter, const T val) {
 
         // get the offset and shape of the request and check if it is valid
-        types::ShapeType offset(roiBeginIter, roiBeginIter+ds.dimension());
-        types::ShapeType shape(roiShapeIter, roiShapeIter+ds.dimension());
+        types::CoordinateType offset(roiBeginIter, roiBeginIter+ds.dimension());
+        types::CoordinateType shape(roiShapeIter, roiShapeIter+ds.dimension());
         ds.checkRequestShape(offset, shape);
         ds.checkRequestType(typeid(T));
 
         // get the chunks that are involved in this request
-        std::vector<types::ShapeType> chunkRequests;
-        ds.getChunkRequests(offset, shape, chunkRequests);
+        util::ChunkRange chunkRange;
+        ds.getChunkRange(offset, shape, chunkRange);
 
-        types::ShapeType localOffset, localShape, chunkShape;
-        types::ShapeType inChunkOffset;
+        types::CoordinateType localOffset, localShape, chunkShape;
+        types::CoordinateType inChunkOffset;
         // out buffer holding data for a single chunk
         andres::Marray<T> buffer(ds.maxChunkShape().begin(), ds.maxChunkShape().end(), val);
-        types::ShapeType bufferShape(buffer.shapeBegin(), buffer.shapeEnd());
+        types::CoordinateType bufferShape(buffer.shapeBegin(), buffer.shapeEnd());
 
         // iterate over the chunks and write the buffer
-        for(const auto & chunkId : chunkRequests) {
+        for(const auto & chunkId : chunkRange) {
 
             bool completeOvlp = ds.getCoordinatesInRequest(
                 chunkId, offset, shape, localOffset, localShape, inChunkOffset
@@ -48,10 +49,14 @@ namespace z5 {
             // to preserve the data that will not be written
             else {
                 // load the current data into the buffer
-                ds.readChunk(chunkId, &buffer(0));
+                ds.readChunkForUpdate(chunkId, &buffer(0));
                 // overwrite the data that is covered by the view
                 auto bufView = buffer.view(inChunkOffset.begin(), localShape.begin());
-                bufView = val;
+                types::CoordinateType bufStrides(bufView.dimension());
+                for(unsigned d = 0; d < bufView.dimension(); ++d) {
+                    bufStrides[d] = bufView.strides(d);
+                }
+                util::fillStridedRegion(&bufView(0), bufStrides.data(), localShape.data(), localShape.size(), val);
                 ds.writeChunk(chunkId, &buffer(0));
             }
         }
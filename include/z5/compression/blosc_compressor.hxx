@@ -2,9 +2,12 @@
 
 #ifdef WITH_BLOSC
 
+#include <algorithm>
+#include <thread>
 #include <blosc.h>
 #include "z5/compression/compressor_base.hxx"
 #include "z5/metadata.hxx"
+#include "z5/util/threadpool.hxx"
 
 namespace z5 {
 namespace compression {
@@ -17,38 +20,47 @@ namespace compression {
             init(metadata);
         }
 
-        void compress(const T * dataIn, std::vector<T> & dataOut, size_t sizeIn) const {
+        // bring the vector overloads of the base class into scope
+        using CompressorBase<T>::compress;
 
-            size_t sizeOut = sizeIn * sizeof(T) + BLOSC_MAX_OVERHEAD;
-            dataOut.clear();
-            dataOut.resize(sizeOut / sizeof(T));
+        size_t compress(const T * dataIn, size_t sizeIn, char * dataOut, size_t capacity) const {
 
             // compress the data
             int sizeCompressed = blosc_compress_ctx(
                 clevel_, shuffle_,
                 sizeof(T),
                 sizeIn * sizeof(T), dataIn,
-                &dataOut[0], sizeOut,
+                dataOut, capacity,
                 compressor_.c_str(),
-                0, // blosc blocksize, 0 means automatic value
-                1  // number of internal threads -> we set this to 1 for now
+                blocksize_, // blosc blocksize, 0 means automatic value
+                effectiveThreads()
             );
 
             // check for errors
             if(sizeCompressed <= 0) {
                 throw std::runtime_error("Blosc compression failed");
             }
+            return sizeCompressed;
+        }
 
-            // resize the out data
-            dataOut.resize(sizeCompressed / sizeof(T) + BLOSC_MAX_OVERHEAD);
+        size_t maxCompressedSize(size_t sizeIn) const {
+            return sizeIn * sizeof(T) + BLOSC_MAX_OVERHEAD;
         }
 
-        void decompress(const std::vector<T> & dataIn, T * dataOut, size_t sizeOut) const {
+        // bring the vector overload of the base class into scope
+        using CompressorBase<T>::decompress;
+
+        void decompress(const char * dataIn, size_t sizeIn, T * dataOut, size_t sizeOut) const {
+
+            // blosc reads the header without checking the input size
+            if(sizeIn < BLOSC_MAX_OVERHEAD) {
+                throw std::runtime_error("Blosc decompression failed");
+            }
 
             // decompress the data
             int sizeDecompressed = blosc_decompress_ctx(
-                &dataIn[0], dataOut,
-                sizeOut * sizeof(T), 1 // number of internal threads
+                dataIn, dataOut,
+                sizeOut * sizeof(T), effectiveThreads()
             );
 
             // check for errors
@@ -65,12 +77,27 @@ namespace compression {
             codec = compressor_;
         }
 
+        // numberOfThreads <= 0 means using all available cores
+        virtual void setNumberOfThreads(const int numberOfThreads) {
+            nThreads_ = (numberOfThreads > 0) ? numberOfThreads :
+                std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+        }
+        virtual int numberOfThreads() const {return nThreads_;}
+
     private:
         // set the compression parameters from metadata
         void init(const DatasetMetadata & metadata) {
             clevel_ = metadata.compressorLevel;
             shuffle_ = metadata.compressorShuffle;
             compressor_ = metadata.codec;
+            blocksize_ = metadata.compressorBlocksize;
+            setNumberOfThreads(metadata.compressorThreads);
+        }
+
+        // if we are called from a thread pool, the chunks are already
+        // processed in parallel and we don't use additional threads
+        inline int effectiveThreads() const {
+            return util::ThreadPool::isWorkerThread() ? 1 : nThreads_;
         }
 
         // the blosc compressor
@@ -79,6 +106,10 @@ namespace compression {
         int clevel_;
         // blsoc shuffle
         int shuffle_;
+        // blosc blocksize
+        int blocksize_;
+        // number of internal threads
+        int nThreads_;
     };
 
 } // namespace compression
@@ -2,6 +2,10 @@
 
 #ifdef WITH_BZIP2
 
+#include <algorithm>
+#include <cstdlib>
+#include <sstream>
+#include <vector>
 #include <bzlib.h>
 
 #include "z5/compression/compressor_base.hxx"
@@ -9,6 +13,83 @@
 
 namespace z5 {
 namespace compression {
+namespace bzip2_detail {
+
+    // bzip2 has no way to reset a stream, so we keep the memory of the
+    // stream state (several MB for compression) per thread and hand it out
+    // again on the next init instead of allocating it for every chunk
+    class StateAllocator {
+
+    public:
+        StateAllocator() {
+        }
+
+        ~StateAllocator() {
+            for(auto & block : freeBlocks_) {
+                std::free(block.first);
+            }
+        }
+
+        static void * allocate(void * opaque, int n, int m) {
+            auto & self = *static_cast<StateAllocator *>(opaque);
+            const size_t size = static_cast<size_t>(n) * m;
+            for(auto it = self.freeBlocks_.begin(); it != self.freeBlocks_.end(); ++it) {
+                if(it->second == size) {
+                    void * ptr = it->first;
+                    self.freeBlocks_.erase(it);
+                    self.usedBlocks_.emplace_back(ptr, size);
+                    return ptr;
+                }
+            }
+            void * ptr = std::malloc(size);
+            if(ptr) {
+                self.usedBlocks_.emplace_back(ptr, size);
+            }
+            return ptr;
+        }
+
+        static void deallocate(void * opaque, void * ptr) {
+            auto & self = *static_cast<StateAllocator *>(opaque);
+            for(auto it = self.usedBlocks_.begin(); it != self.usedBlocks_.end(); ++it) {
+                if(it->first == ptr) {
+                    // keep a bounded number of blocks
+                    if(self.freeBlocks_.size() < maxFreeBlocks) {
+                        self.freeBlocks_.push_back(*it);
+                    } else {
+                        std::free(ptr);
+                    }
+                    self.usedBlocks_.erase(it);
+                    return;
+                }
+            }
+            std::free(ptr);
+        }
+
+        // set the allocation functions of the stream
+        inline void attach(bz_stream & bzs) {
+            bzs.opaque = this;
+            bzs.bzalloc = &StateAllocator::allocate;
+            bzs.bzfree = &StateAllocator::deallocate;
+        }
+
+        StateAllocator(const StateAllocator &) = delete;
+        StateAllocator & operator=(const StateAllocator &) = delete;
+
+    private:
+        // compression and decompression need at most 4 blocks each
+        static const size_t maxFreeBlocks = 8;
+        std::vector<std::pair<void *, size_t>> freeBlocks_;
+        std::vector<std::pair<void *, size_t>> usedBlocks_;
+    };
+
+
+    inline StateAllocator & threadStateAllocator() {
+        static thread_local StateAllocator allocator;
+        return allocator;
+    }
+
+}
+
 
     // TODO gzip encoding
     template<typename T>
@@ -19,31 +100,18 @@ namespace compression {
             init(metadata);
         }
 
-        void compress(const T * dataIn, std::vector<T> & dataOut, size_t sizeIn) const {
+        // bring the vector overloads of the base class into scope
+        using CompressorBase<T>::compress;
+        using CompressorBase<T>::compressReversedEndianness;
 
-            // resize the out data to input size
-            dataOut.clear();
-            dataOut.resize(sizeIn);
+        size_t compress(const T * dataIn, size_t sizeIn, char * dataOut, size_t capacity) const {
 
             // FIXME unfortunately the utility api does not support passing
-            // const pointer for the in data
-            // compress buffer to buffer with bzip
-            // last two arguments:
-            // verbosity: 0 -> not verbose
-            // workFactor: 30 -> default value
-            //unsigned int compressionSize = dataOut.size() * sizeof(T);
-            //auto status = BZ2_bzBuffToBuffCompress(
-            //    (char *) &dataOut[0], &compressionSize,
-            //    (const char *) dataIn, sizeIn * sizeof(T),
-            //    clevel_, 0, 30
-            //);
+            // const pointer for the in data, so we use the low - level API
 
-            // low - level API
             // open the bzip2 stream and set pointer values
             bz_stream bzs;
-            bzs.opaque = NULL;
-            bzs.bzalloc = NULL;
-            bzs.bzfree = NULL;
+            bzip2_detail::threadStateAllocator().attach(bzs);
 
             if(BZ2_bzCompressInit(&bzs, clevel_, 0, 30) != BZ_OK) {
                 throw(std::runtime_error("Initializing bzip compression failed"));
@@ -54,25 +122,15 @@ namespace compression {
             bzs.next_in = (char*) dataIn;
             bzs.avail_in = sizeIn * sizeof(T);
 
-            // let zlib compress the bytes blockwise
+            // the out data can hold the compression bound, so we can compress in one go
+            bzs.next_out = dataOut;
+            bzs.avail_out = capacity;
             int ret;
-            size_t currentPosition = 0;
-            size_t total_out;
             do {
-                // set the stream out-pointer to the current position of the out-data
-                // and set the available out size to the remaining size in the vector not written at
-                //zs.next_out = reinterpret_cast<Bytef*>(&dataOut[currentPosition]);
-                bzs.next_out = (char*) &dataOut[currentPosition];
-                bzs.avail_out = std::distance(dataOut.begin() + currentPosition, dataOut.end()) * sizeof(T);
-
                 ret = BZ2_bzCompress(&bzs, BZ_FINISH);
+            } while(ret == BZ_FINISH_OK && bzs.avail_out > 0);
 
-                // combine the 32bit counts to get thr total out number
-                total_out = (static_cast<size_t>(bzs.total_out_hi32) << 32) + bzs.total_out_lo32;
-                // get the current position in the out vector
-                currentPosition = total_out / sizeof(T);
-            } while(ret == BZ_OK);
-
+            const size_t totalOut = totalOutBytes(bzs);
             BZ2_bzCompressEnd(&bzs);
 
     		if (ret != BZ_STREAM_END) {          // an error occurred that was not EOF
@@ -80,14 +138,64 @@ namespace compression {
     		    oss << "Exception during bzip compression: (" << ret << ") ";
     		    throw(std::runtime_error(oss.str()));
     		}
+            return totalOut;
+        }
+
+
+        // compress with reversed endianness, the input is swapped block by block
+        // into a small buffer that is fed to the bzip2 stream
+        size_t compressReversedEndianness(const T * dataIn, size_t sizeIn, char * dataOut, size_t capacity) const {
+
+            // open the bzip2 stream and set pointer values
+            bz_stream bzs;
+            bzip2_detail::threadStateAllocator().attach(bzs);
+
+            if(BZ2_bzCompressInit(&bzs, clevel_, 0, 30) != BZ_OK) {
+                throw(std::runtime_error("Initializing bzip compression failed"));
+            }
+            bzs.avail_in = 0;
+            bzs.next_out = dataOut;
+            bzs.avail_out = capacity;
+
+            // we swap blocks of 64 KB
+            const size_t blockSize = (1 << 16) / sizeof(T) + 1;
+            auto block = util::BufferPool<T>::acquire(std::min(sizeIn, blockSize));
+            size_t inPosition = 0;
+            int ret;
+            do {
+                // swap the next block if the stream has consumed the last one
+                if(bzs.avail_in == 0 && inPosition < sizeIn) {
+                    const size_t blockLen = std::min(block.size(), sizeIn - inPosition);
+                    util::reverseEndianness(dataIn + inPosition, block.data(), blockLen);
+                    bzs.next_in = (char*) block.data();
+                    bzs.avail_in = blockLen * sizeof(T);
+                    inPosition += blockLen;
+                }
+                ret = BZ2_bzCompress(&bzs, inPosition == sizeIn ? BZ_FINISH : BZ_RUN);
+            } while((ret == BZ_RUN_OK || ret == BZ_FINISH_OK) && bzs.avail_out > 0);
+
+            const size_t totalOut = totalOutBytes(bzs);
+            BZ2_bzCompressEnd(&bzs);
 
-            dataOut.resize(currentPosition);
+    		if (ret != BZ_STREAM_END) {          // an error occurred that was not EOF
+    		    std::ostringstream oss;
+    		    oss << "Exception during bzip compression: (" << ret << ") ";
+    		    throw(std::runtime_error(oss.str()));
+    		}
+            return totalOut;
         }
 
 
-        void decompress(const std::vector<T> & dataIn, T * dataOut, size_t sizeOut) const {
+        size_t maxCompressedSize(size_t sizeIn) const {
+            // the bound given in the bzip2 manual is 1 % larger than the input plus 600 bytes
+            const size_t nBytes = sizeIn * sizeof(T);
+            return nBytes + nBytes / 100 + 601;
+        }
+
+        // bring the vector overload of the base class into scope
+        using CompressorBase<T>::decompress;
 
-            unsigned int decompressionSize = dataIn.size() * sizeof(T);
+        void decompress(const char * dataIn, size_t sizeIn, T * dataOut, size_t sizeOut) const {
 
             // FIXME unfortunately the utility api does not support passing
             // const pointer for the in data
@@ -104,9 +212,7 @@ namespace compression {
 
             // open the zlib stream
             bz_stream bzs;
-            bzs.opaque = NULL;
-            bzs.bzalloc = NULL;
-            bzs.bzfree = NULL;
+            bzip2_detail::threadStateAllocator().attach(bzs);
 
             // init the zlib stream
             // last two arguments:
@@ -118,45 +224,46 @@ namespace compression {
             }
 
             // set the stream input to the beginning of the input data
-            bzs.next_in = (char*) &dataIn[0];
-            bzs.avail_in = dataIn.size() * sizeof(T);
+            bzs.next_in = (char*) dataIn;
+            bzs.avail_in = sizeIn;
 
-            // let zlib decompress the bytes blockwise
+            // let bzip2 decompress the bytes blockwise
+            char * out = reinterpret_cast<char*>(dataOut);
+            const size_t outBytes = sizeOut * sizeof(T);
+            size_t totalOut = 0;
             int ret;
-            size_t currentPosition = 0;
-            size_t currentLength;
-            size_t total_out;
 
             do {
-                // set the stream outout to the output dat at the current position
+                // set the stream output to the output data at the current position
                 // and set the available size to the remaining bytes in the output data
-                // reinterpret_cast because (Bytef*) throws warning
-                bzs.next_out = reinterpret_cast<char*>(dataOut + currentPosition);
-                bzs.avail_out = (sizeOut - currentPosition) * sizeof(T);
+                bzs.next_out = out + totalOut;
+                bzs.avail_out = outBytes - totalOut;
+                const unsigned int availIn = bzs.avail_in;
+                const size_t previousOut = totalOut;
 
                 ret = BZ2_bzDecompress(&bzs);
+                totalOut = totalOutBytes(bzs);
 
-                // combine the 32bit counts to get thr total out number
-                total_out = (static_cast<size_t>(bzs.total_out_hi32) << 32) + bzs.total_out_lo32;
-
-                // get the current position in the out data
-                currentPosition = total_out / sizeof(T);
+                // bzip2 does not always switch to BZ_STREAM_END if the last block
+                // fills the output exactly, so we also stop once the output is full
+                if(totalOut == outBytes) {
+                    break;
+                }
 
-                // FIXME for some reason bzip2 does not switch to BZ_STREAM_END properly,
-                // so we also break if we have reached the end of the input
-                if(currentPosition == sizeOut) {
+                // if bzip2 did not make any progress, the input is truncated
+                if(bzs.avail_in == availIn && totalOut == previousOut) {
                     break;
                 }
             } while(ret == BZ_OK);
 
             BZ2_bzDecompressEnd(&bzs);
 
-            // FIXME this will fail if we break out from the loop above
-            //if(ret != BZ_STREAM_END) {
-    		//    std::ostringstream oss;
-    		//    oss << "Exception during bzip compression: (" << ret << ") ";
-    		//    throw(std::runtime_error(oss.str()));
-            //}
+            if((ret != BZ_OK && ret != BZ_STREAM_END) || totalOut != outBytes) {
+    		    std::ostringstream oss;
+    		    oss << "Exception during bzip decompression: (" << ret << ") ";
+    		    oss << "decompressed " << totalOut << " of " << outBytes << " bytes";
+    		    throw(std::runtime_error(oss.str()));
+            }
 
 		}
 
@@ -169,6 +276,11 @@ namespace compression {
         }
 
     private:
+        // combine the 32bit counts to get the total out number
+        static inline size_t totalOutBytes(const bz_stream & bzs) {
+            return (static_cast<size_t>(bzs.total_out_hi32) << 32) + bzs.total_out_lo32;
+        }
+
         void init(const DatasetMetadata & metadata) {
             // TODO clevel = compressorLevel -1 ???
             clevel_ = metadata.compressorLevel;
@@ -0,0 +1,396 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <map>
+#include <numeric>
+#include <type_traits>
+
+#include "z5/compression/compressor_base.hxx"
+#include "z5/metadata.hxx"
+
+// compressed segmentation format of neuroglancer:
+// https://github.com/google/neuroglancer/blob/master/src/neuroglancer/sliceview/compressed_segmentation/README.md
+
+namespace z5 {
+namespace compression {
+namespace compressed_segmentation_detail {
+
+    // layout of a chunk in the compressed segmentation format:
+    // the last (up to) three axes are the spatial axes x, y, z (x is the last and fastest axis),
+    // all leading axes are flattened into channels, which are encoded independently
+    struct Geometry {
+
+        Geometry(const types::ShapeType & chunkShape, const types::ShapeType & blockShape, const size_t size) {
+            volumeShape.fill(1);
+            this->blockShape.fill(1);
+            nChannels = 1;
+
+            const size_t chunkSize = std::accumulate(chunkShape.begin(), chunkShape.end(), 1, std::multiplies<size_t>());
+            if(size == chunkSize) {
+                const size_t nDim = chunkShape.size();
+                for(size_t d = 0; d < nDim; ++d) {
+                    if(d < 3) {
+                        volumeShape[d] = chunkShape[nDim - 1 - d];
+                    } else {
+                        nChannels *= chunkShape[nDim - 1 - d];
+                    }
+                }
+                const size_t nBlockDim = std::min(blockShape.size(), size_t(3));
+                for(size_t d = 0; d < nBlockDim; ++d) {
+                    this->blockShape[d] = blockShape[blockShape.size() - 1 - d];
+                }
+            } else {
+                // the chunks at the upper border of N5 datasets are truncated and their shape
+                // is not known to the compressor, so they are encoded as a flat volume with blocks
+                // of the same volume (encoder and decoder agree on this from the number of elements)
+                volumeShape[0] = size;
+                this->blockShape[0] = std::accumulate(blockShape.begin(), blockShape.end(), 1, std::multiplies<size_t>());
+            }
+
+            channelSize = 1;
+            blockVolume = 1;
+            nBlocks = 1;
+            for(size_t d = 0; d < 3; ++d) {
+                this->blockShape[d] = std::max(std::min(this->blockShape[d], volumeShape[d]), size_t(1));
+                gridShape[d] = volumeShape[d] / this->blockShape[d] + (volumeShape[d] % this->blockShape[d] == 0 ? 0 : 1);
+                channelSize *= volumeShape[d];
+                blockVolume *= this->blockShape[d];
+                nBlocks *= gridShape[d];
+            }
+        }
+
+        // shapes in x, y, z order
+        std::array<size_t, 3> volumeShape;
+        std::array<size_t, 3> blockShape;
+        std::array<size_t, 3> gridShape;
+        size_t nChannels;
+        size_t channelSize;
+        size_t blockVolume;
+        size_t nBlocks;
+    };
+
+
+    // number of bits used to encode the indices into a table with the given number of entries
+    inline uint32_t encodedBits(const size_t tableSize) {
+        if(tableSize <= 1) {
+            return 0;
+        }
+        uint32_t bits = 1;
+        while((size_t(1) << bits) < tableSize) {
+            bits *= 2;
+        }
+        return bits;
+    }
+
+    inline bool isValidBits(const uint32_t bits) {
+        return bits == 0 || bits == 1 || bits == 2 || bits == 4 || bits == 8 || bits == 16 || bits == 32;
+    }
+
+    // number of 32 bit words needed for the encoded values of a block
+    inline size_t encodedWords(const uint32_t bits, const size_t blockVolume) {
+        return (bits * blockVolume + 31) / 32;
+    }
+
+    // the format consists of little endian 32 bit words,
+    // which are not necessarily aligned in the byte buffers
+    inline uint32_t getWord(const char * data, const size_t pos) {
+        uint32_t word;
+        std::memcpy(&word, data + 4 * pos, 4);
+        return word;
+    }
+
+    inline void putWord(char * data, const size_t pos, const uint32_t word) {
+        std::memcpy(data + 4 * pos, &word, 4);
+    }
+
+
+    // call f(x, y, z, voxel) for all voxels of the block that are inside of the volume,
+    // voxel is the index of the voxel in the (full) block
+    template<typename F>
+    inline void forEachVoxel(const Geometry & g, const std::array<size_t, 3> & blockBegin, F && f) {
+        std::array<size_t, 3> blockEnd;
+        for(size_t d = 0; d < 3; ++d) {
+            blockEnd[d] = std::min(blockBegin[d] + g.blockShape[d], g.volumeShape[d]);
+        }
+        for(size_t z = blockBegin[2]; z < blockEnd[2]; ++z) {
+            for(size_t y = blockBegin[1]; y < blockEnd[1]; ++y) {
+                const size_t voxelOffset = ((z - blockBegin[2]) * g.blockShape[1] + (y - blockBegin[1])) * g.blockShape[0] - blockBegin[0];
+                const size_t dataOffset = (z * g.volumeShape[1] + y) * g.volumeShape[0];
+                for(size_t x = blockBegin[0]; x < blockEnd[0]; ++x) {
+                    f(dataOffset + x, voxelOffset + x);
+                }
+            }
+        }
+    }
+
+
+    // call f(blockIndex, blockBegin) for all blocks of a channel, x is the fastest axis
+    template<typename F>
+    inline void forEachBlock(const Geometry & g, F && f) {
+        size_t blockIndex = 0;
+        std::array<size_t, 3> blockBegin;
+        for(size_t bz = 0; bz < g.gridShape[2]; ++bz) {
+            blockBegin[2] = bz * g.blockShape[2];
+            for(size_t by = 0; by < g.gridShape[1]; ++by) {
+                blockBegin[1] = by * g.blockShape[1];
+                for(size_t bx = 0; bx < g.gridShape[0]; ++bx, ++blockIndex) {
+                    blockBegin[0] = bx * g.blockShape[0];
+                    f(blockIndex, blockBegin);
+                }
+            }
+        }
+    }
+
+}
+
+
+    // compressed segmentation, the label compression of neuroglancer:
+    // every chunk is divided into small blocks, for each block we store a table of the
+    // labels in the block and the indices into this table, bit-packed with the minimal number of bits;
+    // identical tables of different blocks are only stored once.
+    // only supported for uint32 and uint64 data
+    template<typename T>
+    class CompressedSegmentationCompressor : public CompressorBase<T> {
+
+    public:
+        CompressedSegmentationCompressor(const DatasetMetadata & metadata) {
+            if(!std::is_same<T, uint32_t>::value && !std::is_same<T, uint64_t>::value) {
+                throw std::runtime_error("Compressed segmentation is only supported for uint32 and uint64 data");
+            }
+            init(metadata);
+        }
+
+        // bring the vector overloads of the base class into scope
+        using CompressorBase<T>::compress;
+        using CompressorBase<T>::compressReversedEndianness;
+
+        size_t compress(const T * dataIn, size_t sizeIn, char * dataOut, size_t capacity) const {
+            const compressed_segmentation_detail::Geometry g(chunkShape_, blockShape_, sizeIn);
+            if(capacity < maxCompressedSize(g)) {
+                throw std::runtime_error("Exception during compressed segmentation compression: out buffer too small");
+            }
+
+            // the channel offsets (in words) are followed by the channel data
+            size_t pos = g.nChannels;
+            for(size_t c = 0; c < g.nChannels; ++c) {
+                compressed_segmentation_detail::putWord(dataOut, c, pos);
+                pos += encodeChannel(dataIn + c * g.channelSize, g, dataOut + 4 * pos);
+            }
+            return 4 * pos;
+        }
+
+        size_t maxCompressedSize(size_t sizeIn) const {
+            return maxCompressedSize(compressed_segmentation_detail::Geometry(chunkShape_, blockShape_, sizeIn));
+        }
+
+        // bring the vector overload of the base class into scope
+        using CompressorBase<T>::decompress;
+
+        void decompress(const char * dataIn, size_t sizeIn, T * dataOut, size_t sizeOut) const {
+            const compressed_segmentation_detail::Geometry g(chunkShape_, blockShape_, sizeOut);
+            const size_t nWords = sizeIn / 4;
+            if(nWords < g.nChannels) {
+                throw std::runtime_error("Exception during compressed segmentation decompression: invalid data");
+            }
+            for(size_t c = 0; c < g.nChannels; ++c) {
+                const size_t offset = compressed_segmentation_detail::getWord(dataIn, c);
+                if(offset > nWords) {
+                    throw std::runtime_error("Exception during compressed segmentation decompression: invalid data");
+                }
+                decodeChannel(dataIn + 4 * offset, nWords - offset, g, dataOut + c * g.channelSize);
+            }
+        }
+
+        // the unique labels are the union of the label tables,
+        // so we only need to read the block headers and the tables
+        bool uniqueValues(const char * dataIn, size_t sizeIn, size_t sizeOut, std::vector<T> & values) const {
+            const compressed_segmentation_detail::Geometry g(chunkShape_, blockShape_, sizeOut);
+            const size_t nWords = sizeIn / 4;
+            if(nWords < g.nChannels) {
+                throw std::runtime_error("Exception during compressed segmentation decompression: invalid data");
+            }
+
+            values.clear();
+            std::vector<std::pair<size_t, uint32_t>> tables;
+            std::vector<size_t> starts;
+            for(size_t c = 0; c < g.nChannels; ++c) {
+                const size_t offset = compressed_segmentation_detail::getWord(dataIn, c);
+                const size_t end = (c + 1 < g.nChannels) ? compressed_segmentation_detail::getWord(dataIn, c + 1) : nWords;
+                if(offset > end || end > nWords || end - offset < 2 * g.nBlocks) {
+                    throw std::runtime_error("Exception during compressed segmentation decompression: invalid data");
+                }
+                const char * channel = dataIn + 4 * offset;
+
+                // the tables and encoded values are stored back to back, so the size of a table
+                // is bounded by the next table or encoded values (or the end of the channel)
+                tables.clear();
+                starts.assign(1, end - offset);
+                for(size_t b = 0; b < g.nBlocks; ++b) {
+                    const uint32_t header = compressed_segmentation_detail::getWord(channel, 2 * b);
+                    tables.emplace_back(header & 0xffffff, header >> 24);
+                    starts.push_back(tables.back().first);
+                    starts.push_back(compressed_segmentation_detail::getWord(channel, 2 * b + 1));
+                }
+                std::sort(tables.begin(), tables.end());
+                tables.erase(std::unique(tables.begin(), tables.end()), tables.end());
+                std::sort(starts.begin(), starts.end());
+
+                for(const auto & table : tables) {
+                    const size_t tableEnd = *std::upper_bound(starts.begin(), starts.end(), table.first);
+                    if(tableEnd > end - offset) {
+                        throw std::runtime_error("Exception during compressed segmentation decompression: invalid data");
+                    }
+                    const size_t tableSize = std::min((tableEnd - table.first) / wordsPerValue,
+                                                      size_t(1) << table.second);
+                    const size_t n = values.size();
+                    values.resize(n + tableSize);
+                    std::memcpy(values.data() + n, channel + 4 * table.first, tableSize * sizeof(T));
+                }
+            }
+
+            std::sort(values.begin(), values.end());
+            values.erase(std::unique(values.begin(), values.end()), values.end());
+            return true;
+        }
+
+        virtual types::Compressor type() const {
+            return types::compressedSegmentation;
+        }
+
+        virtual void getCodec(std::string & codec) const {
+            codec = "compressed_segmentation";
+        }
+
+    private:
+        // the labels are stored as one (uint32) or two (uint64) words
+        static const size_t wordsPerValue = (sizeof(T) + 3) / 4;
+
+        void init(const DatasetMetadata & metadata) {
+            chunkShape_ = metadata.chunkShape;
+            blockShape_ = metadata.compressorBlockShape;
+        }
+
+        // worst case: 32 bits per voxel and a separate table for each block, with one entry per voxel
+        size_t maxCompressedSize(const compressed_segmentation_detail::Geometry & g) const {
+            const size_t wordsPerBlock = 2 + g.blockVolume + g.blockVolume * wordsPerValue;
+            return 4 * g.nChannels * (1 + g.nBlocks * wordsPerBlock);
+        }
+
+        // encode one channel, returns the number of words written
+        size_t encodeChannel(const T * dataIn, const compressed_segmentation_detail::Geometry & g, char * dataOut) const {
+            using namespace compressed_segmentation_detail;
+
+            // the block headers (2 words per block) are followed by the encoded values and tables
+            size_t pos = 2 * g.nBlocks;
+            std::map<std::vector<T>, uint32_t> tableOffsets;
+            std::vector<T> table;
+            auto labels = util::BufferPool<T>::acquire(g.blockVolume);
+            auto encoded = util::BufferPool<uint32_t>::acquire(0);
+
+            forEachBlock(g, [&](const size_t blockIndex, const std::array<size_t, 3> & blockBegin) {
+
+                // get the labels of this block and make the table
+                size_t nLabels = 0;
+                forEachVoxel(g, blockBegin, [&](const size_t dataIndex, const size_t) {
+                    labels.data()[nLabels++] = dataIn[dataIndex];
+                });
+                table.assign(labels.data(), labels.data() + nLabels);
+                std::sort(table.begin(), table.end());
+                table.erase(std::unique(table.begin(), table.end()), table.end());
+
+                // encode the table indices, the voxels in the padding of blocks at
+                // the volume border keep index 0
+                const uint32_t bits = encodedBits(table.size());
+                const size_t nEncoded = encodedWords(bits, g.blockVolume);
+                const size_t valuesOffset = pos;
+                if(bits > 0) {
+                    encoded.vector().assign(nEncoded, 0);
+                    uint32_t * encodedData = encoded.data();
+                    size_t labelIndex = 0;
+                    T lastLabel = table[0];
+                    uint32_t lastIndex = 0;
+                    forEachVoxel(g, blockBegin, [&](const size_t, const size_t voxel) {
+                        const T label = labels.data()[labelIndex++];
+                        // neighboring voxels have the same label most of the time
+                        if(label != lastLabel) {
+                            lastIndex = std::lower_bound(table.begin(), table.end(), label) - table.begin();
+                            lastLabel = label;
+                        }
+                        const size_t bitPosition = voxel * bits;
+                        encodedData[bitPosition / 32] |= lastIndex << (bitPosition % 32);
+                    });
+                    std::memcpy(dataOut + 4 * pos, encodedData, 4 * nEncoded);
+                    pos += nEncoded;
+                }
+
+                // write the table if we haven't written the same table already
+                uint32_t tableOffset;
+                auto tableIt = tableOffsets.find(table);
+                if(tableIt == tableOffsets.end()) {
+                    if(pos >= (1 << 24)) {
+                        throw std::runtime_error("Exception during compressed segmentation compression: chunk too large");
+                    }
+                    tableOffset = pos;
+                    std::memcpy(dataOut + 4 * pos, table.data(), table.size() * sizeof(T));
+                    pos += table.size() * wordsPerValue;
+                    tableOffsets.emplace(table, tableOffset);
+                } else {
+                    tableOffset = tableIt->second;
+                }
+
+                putWord(dataOut, 2 * blockIndex, tableOffset | (bits << 24));
+                putWord(dataOut, 2 * blockIndex + 1, valuesOffset);
+            });
+            return pos;
+        }
+
+        // decode one channel of nWords words
+        void decodeChannel(const char * dataIn, const size_t nWords,
+                           const compressed_segmentation_detail::Geometry & g, T * dataOut) const {
+            using namespace compressed_segmentation_detail;
+            if(nWords < 2 * g.nBlocks) {
+                throw std::runtime_error("Exception during compressed segmentation decompression: invalid data");
+            }
+
+            forEachBlock(g, [&](const size_t blockIndex, const std::array<size_t, 3> & blockBegin) {
+                const uint32_t header = getWord(dataIn, 2 * blockIndex);
+                const size_t tableOffset = header & 0xffffff;
+                const uint32_t bits = header >> 24;
+                const size_t valuesOffset = getWord(dataIn, 2 * blockIndex + 1);
+                if(!isValidBits(bits) || tableOffset + wordsPerValue > nWords ||
+                   valuesOffset + encodedWords(bits, g.blockVolume) > nWords) {
+                    throw std::runtime_error("Exception during compressed segmentation decompression: invalid data");
+                }
+                const char * table = dataIn + 4 * tableOffset;
+                const size_t tableSize = (nWords - tableOffset) / wordsPerValue;
+
+                if(bits == 0) {
+                    T label;
+                    std::memcpy(&label, table, sizeof(T));
+                    forEachVoxel(g, blockBegin, [&](const size_t dataIndex, const size_t) {
+                        dataOut[dataIndex] = label;
+                    });
+                    return;
+                }
+
+                const char * values = dataIn + 4 * valuesOffset;
+                const uint32_t mask = (bits == 32) ? 0xffffffff : (uint32_t(1) << bits) - 1;
+                forEachVoxel(g, blockBegin, [&](const size_t dataIndex, const size_t voxel) {
+                    const size_t bitPosition = voxel * bits;
+                    const uint32_t index = (getWord(values, bitPosition / 32) >> (bitPosition % 32)) & mask;
+                    if(index >= tableSize) {
+                        throw std::runtime_error("Exception during compressed segmentation decompression: invalid data");
+                    }
+                    std::memcpy(dataOut + dataIndex, table + index * sizeof(T), sizeof(T));
+                });
+            });
+        }
+
+        types::ShapeType chunkShape_;
+        types::ShapeType blockShape_;
+    };
+
+}
+}
@@ -2,6 +2,9 @@
 
 #include <vector>
 #include "z5/types/types.hxx"
+#include "z5/util/buffer_pool.hxx"
+#include "z5/util/byteswap.hxx"
+#include "z5/util/trace.hxx"
 
 namespace z5 {
 namespace compression {
@@ -15,11 +18,80 @@ namespace compression {
         // API -> must be implemented by child classes
         //
 
-        virtual void compress(const T *, std::vector<T> &, size_t) const = 0;
-        virtual void decompress(const std::vector<T> &, T *, size_t) const = 0;
+        // compress sizeIn elements into the (caller-owned) out bytes,
+        // which must hold at least maxCompressedSize(sizeIn) bytes;
+        // returns the number of bytes written
+        virtual size_t compress(const T *, size_t, char *, size_t) const = 0;
+        // upper bound of the compressed size in bytes for the given number of elements
+        virtual size_t maxCompressedSize(size_t) const = 0;
+        // decompress from a (non-owning) span of bytes,
+        // e.g. the memory mapped chunk file
+        virtual void decompress(const char *, size_t, T *, size_t) const = 0;
         virtual types::Compressor type() const = 0;
         virtual void getCodec(std::string &) const = 0;
 
+        //
+        // API -> may be implemented by child classes
+        //
+
+        // compress the data with reversed endianness (needed for N5)
+        // the default implementation swaps a copy of the full input, child classes
+        // that compress in a stream should swap block by block instead
+        virtual size_t compressReversedEndianness(const T * dataIn, size_t sizeIn, char * dataOut, size_t capacity) const {
+            auto dataTmp = util::BufferPool<T>::acquire(sizeIn);
+            util::TraceScope traceSwap("byteswap");
+            util::reverseEndianness(dataIn, dataTmp.data(), sizeIn);
+            traceSwap.stop();
+            return compress(dataTmp.data(), sizeIn, dataOut, capacity);
+        }
+
+        // decompress data that was compressed with compressReversedEndianness
+        // to the native endianness (needed for N5)
+        virtual void decompressReversedEndianness(const char * dataIn, size_t sizeIn, T * dataOut, size_t sizeOut) const {
+            decompress(dataIn, sizeIn, dataOut, sizeOut);
+            util::TraceScope traceSwap("byteswap");
+            util::reverseEndiannessInplace(dataOut, sizeOut);
+        }
+
+        // number of threads used internally for a single chunk,
+        // compressors that are not multi-threaded ignore this
+        virtual void setNumberOfThreads(const int) {}
+        virtual int numberOfThreads() const {return 1;}
+
+        // get the unique values of a compressed chunk with sizeOut elements
+        // without decompressing it fully; returns false if the compressor
+        // does not support this
+        virtual bool uniqueValues(const char *, size_t, size_t, std::vector<T> &) const {return false;}
+
+        //
+        // convenience functions
+        //
+
+        // compress to a vector, the last element is padded
+        // if the number of bytes is not a multiple of sizeof(T)
+        inline void compress(const T * dataIn, std::vector<T> & dataOut, size_t sizeIn) const {
+            const size_t capacity = maxCompressedSize(sizeIn);
+            dataOut.resize(elementsForBytes(capacity));
+            const size_t nBytes = compress(dataIn, sizeIn, reinterpret_cast<char *>(dataOut.data()), capacity);
+            dataOut.resize(elementsForBytes(nBytes));
+        }
+
+        inline void compressReversedEndianness(const T * dataIn, std::vector<T> & dataOut, size_t sizeIn) const {
+            const size_t capacity = maxCompressedSize(sizeIn);
+            dataOut.resize(elementsForBytes(capacity));
+            const size_t nBytes = compressReversedEndianness(dataIn, sizeIn, reinterpret_cast<char *>(dataOut.data()), capacity);
+            dataOut.resize(elementsForBytes(nBytes));
+        }
+
+        inline void decompress(const std::vector<T> & dataIn, T * dataOut, size_t sizeOut) const {
+            decompress((const char *) &dataIn[0], dataIn.size() * sizeof(T), dataOut, sizeOut);
+        }
+
+    private:
+        static inline size_t elementsForBytes(const size_t nBytes) {
+            return nBytes / sizeof(T) + (nBytes % sizeof(T) == 0 ? 0 : 1);
+        }
+
     };
 
 
@@ -1,5 +1,8 @@
 #pragma once
 
+#include <algorithm>
+#include <cstring>
+
 #include "z5/compression/compressor_base.hxx"
 
 namespace z5 {
@@ -13,14 +16,35 @@ namespace compression {
         RawCompressor() {
         }
 
-        void compress(const T * dataIn, std::vector<T> & dataOut, size_t sizeIn) const {
+        // bring the vector overloads of the base class into scope
+        using CompressorBase<T>::compress;
+        using CompressorBase<T>::compressReversedEndianness;
+
+        size_t compress(const T * dataIn, size_t sizeIn, char * dataOut, size_t) const {
             // TODO FIXME don't copy data - swap pointers?
-            dataOut.assign(dataIn, dataIn + sizeIn);
+            std::memcpy(dataOut, dataIn, sizeIn * sizeof(T));
+            return sizeIn * sizeof(T);
+        }
+
+        // swap directly into the out data, no temporary needed
+        size_t compressReversedEndianness(const T * dataIn, size_t sizeIn, char * dataOut, size_t) const {
+            util::reverseEndianness(dataIn, reinterpret_cast<T *>(dataOut), sizeIn);
+            return sizeIn * sizeof(T);
         }
 
-        void decompress(const std::vector<T> & dataIn, T * dataOut, size_t) const {
+        size_t maxCompressedSize(size_t sizeIn) const {
+            return sizeIn * sizeof(T);
+        }
+
+        // bring the vector overload of the base class into scope
+        using CompressorBase<T>::decompress;
+
+        void decompress(const char * dataIn, size_t sizeIn, T * dataOut, size_t sizeOut) const {
+            if(sizeIn < sizeOut * sizeof(T)) {
+                throw std::runtime_error("Exception during raw decompression: wrong chunk size");
+            }
             // TODO FIXME don't copy data - swap pointers?
-            std::copy(dataIn.begin(), dataIn.end(), dataOut);
+            std::memcpy(dataOut, dataIn, sizeOut * sizeof(T));
         }
 
         virtual types::Compressor type() const {
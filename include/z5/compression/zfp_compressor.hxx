@@ -0,0 +1,215 @@
+#pragma once
+
+#ifdef WITH_ZFP
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <numeric>
+#include <type_traits>
+#include <zfp.h>
+
+#include "z5/compression/compressor_base.hxx"
+#include "z5/metadata.hxx"
+
+// zfp documentation:
+// https://zfp.readthedocs.io/en/latest/
+
+namespace z5 {
+namespace compression {
+namespace zfp_detail {
+
+    struct FieldDeleter {
+        void operator()(zfp_field * field) const {zfp_field_free(field);}
+    };
+    struct StreamDeleter {
+        void operator()(zfp_stream * zfp) const {zfp_stream_close(zfp);}
+    };
+    struct BitStreamDeleter {
+        void operator()(bitstream * stream) const {stream_close(stream);}
+    };
+
+    typedef std::unique_ptr<zfp_field, FieldDeleter> Field;
+    typedef std::unique_ptr<zfp_stream, StreamDeleter> Stream;
+    typedef std::unique_ptr<bitstream, BitStreamDeleter> BitStream;
+
+
+    // make the zfp field for a chunk with size elements; zfp compresses blocks of 4^d values,
+    // so it needs the shape of the chunk: the last axis is x, singleton axes are dropped and
+    // more than 4 axes are merged into the slowest one.
+    // the chunks at the upper border of N5 datasets are truncated and their shape is not
+    // known to the compressor, so they are compressed as 1d data (the decoder gets
+    // the shape from the zfp header)
+    inline zfp_field * makeField(const zfp_type type, const types::ShapeType & chunkShape, const size_t size) {
+        std::array<size_t, 4> dims;
+        unsigned nDims = 0;
+        const size_t chunkSize = std::accumulate(chunkShape.begin(), chunkShape.end(), 1, std::multiplies<size_t>());
+        if(size == chunkSize) {
+            for(auto it = chunkShape.rbegin(); it != chunkShape.rend(); ++it) {
+                if(*it == 1) {
+                    continue;
+                }
+                if(nDims < 4) {
+                    dims[nDims++] = *it;
+                } else {
+                    dims[3] *= *it;
+                }
+            }
+        }
+        if(nDims == 0) {
+            dims[0] = size;
+            nDims = 1;
+        }
+
+        switch(nDims) {
+            case 1: return zfp_field_1d(nullptr, type, dims[0]);
+            case 2: return zfp_field_2d(nullptr, type, dims[0], dims[1]);
+            case 3: return zfp_field_3d(nullptr, type, dims[0], dims[1], dims[2]);
+            default: return zfp_field_4d(nullptr, type, dims[0], dims[1], dims[2], dims[3]);
+        }
+    }
+
+}
+
+
+    // lossy compression of floating point data with zfp, in the
+    // fixed accuracy, rate or precision mode or in the lossless reversible mode
+    template<typename T>
+    class ZfpCompressor : public CompressorBase<T> {
+
+    public:
+        ZfpCompressor(const DatasetMetadata & metadata) {
+            if(!std::is_same<T, float>::value && !std::is_same<T, double>::value) {
+                throw std::runtime_error("Zfp compression is only supported for float32 and float64 data");
+            }
+            init(metadata);
+        }
+
+        // bring the vector overloads of the base class into scope
+        using CompressorBase<T>::compress;
+        using CompressorBase<T>::compressReversedEndianness;
+
+        size_t compress(const T * dataIn, size_t sizeIn, char * dataOut, size_t capacity) const {
+            zfp_detail::Field field(zfp_detail::makeField(type_, chunkShape_, sizeIn));
+            zfp_field_set_pointer(field.get(), const_cast<T *>(dataIn));
+            zfp_detail::Stream zfp(openStream(field.get()));
+
+            // the bit stream writes whole 64 bit words
+            zfp_detail::BitStream stream(stream_open(dataOut, capacity - capacity % sizeof(uint64_t)));
+            zfp_stream_set_bit_stream(zfp.get(), stream.get());
+            zfp_stream_rewind(zfp.get());
+
+            // we write the full header (mode, type and shape),
+            // so that the chunks can be decoded without the metadata (as for numcodecs zfpy)
+            if(zfp_write_header(zfp.get(), field.get(), ZFP_HEADER_FULL) == 0) {
+                throw std::runtime_error("Exception during zfp compression: writing the header failed");
+            }
+            const size_t nBytes = zfp_compress(zfp.get(), field.get());
+            if(nBytes == 0) {
+                throw std::runtime_error("Exception during zfp compression");
+            }
+            return nBytes;
+        }
+
+        // the zfp stream does not depend on the byte order of the data,
+        // so we compress the native values (swapping them would destroy the floating point values);
+        // decompressReversedEndianness decodes to native values accordingly
+        size_t compressReversedEndianness(const T * dataIn, size_t sizeIn, char * dataOut, size_t capacity) const {
+            return compress(dataIn, sizeIn, dataOut, capacity);
+        }
+
+        size_t maxCompressedSize(size_t sizeIn) const {
+            zfp_detail::Field field(zfp_detail::makeField(type_, chunkShape_, sizeIn));
+            zfp_detail::Stream zfp(openStream(field.get()));
+            // the maximum size includes the header, we add one word to be safe
+            return zfp_stream_maximum_size(zfp.get(), field.get()) + sizeof(uint64_t);
+        }
+
+        // bring the vector overload of the base class into scope
+        using CompressorBase<T>::decompress;
+
+        void decompress(const char * dataIn, size_t sizeIn, T * dataOut, size_t sizeOut) const {
+            if(sizeIn < sizeof(uint64_t)) {
+                throw std::runtime_error("Exception during zfp decompression: invalid header");
+            }
+            // the bit stream reads whole 64 bit words, so we copy
+            // unaligned data (e.g. mapped N5 chunks after the header)
+            auto aligned = util::BufferPool<uint64_t>::acquire();
+            if(reinterpret_cast<uintptr_t>(dataIn) % sizeof(uint64_t) != 0) {
+                aligned.vector().resize(sizeIn / sizeof(uint64_t) + 1);
+                std::memcpy(aligned.data(), dataIn, sizeIn);
+                dataIn = reinterpret_cast<const char *>(aligned.data());
+            }
+
+            // mode, type and shape are read from the header
+            zfp_detail::Field field(zfp_field_alloc());
+            zfp_detail::Stream zfp(zfp_stream_open(nullptr));
+            zfp_detail::BitStream stream(stream_open(const_cast<char *>(dataIn), sizeIn));
+            zfp_stream_set_bit_stream(zfp.get(), stream.get());
+            zfp_stream_rewind(zfp.get());
+
+            if(zfp_read_header(zfp.get(), field.get(), ZFP_HEADER_FULL) == 0) {
+                throw std::runtime_error("Exception during zfp decompression: invalid header");
+            }
+            if(zfp_field_type(field.get()) != type_ || zfp_field_size(field.get(), nullptr) != sizeOut) {
+                throw std::runtime_error("Exception during zfp decompression: wrong chunk size");
+            }
+            zfp_field_set_pointer(field.get(), dataOut);
+            if(zfp_decompress(zfp.get(), field.get()) == 0) {
+                throw std::runtime_error("Exception during zfp decompression");
+            }
+        }
+
+        // see compressReversedEndianness
+        void decompressReversedEndianness(const char * dataIn, size_t sizeIn, T * dataOut, size_t sizeOut) const {
+            decompress(dataIn, sizeIn, dataOut, sizeOut);
+        }
+
+        virtual types::Compressor type() const {
+            return types::zfp;
+        }
+
+        virtual void getCodec(std::string & codec) const {
+            codec = "zfp";
+        }
+
+    private:
+        void init(const DatasetMetadata & metadata) {
+            chunkShape_ = metadata.chunkShape;
+            mode_ = metadata.zfpMode();
+            tolerance_ = metadata.compressorTolerance;
+            rate_ = metadata.compressorRate;
+            precision_ = metadata.compressorPrecision;
+        }
+
+        // open a zfp stream with the compression mode of this dataset
+        zfp_stream * openStream(const zfp_field * field) const {
+            zfp_stream * zfp = zfp_stream_open(nullptr);
+            switch(mode_) {
+                case zfp_mode_fixed_accuracy:
+                    zfp_stream_set_accuracy(zfp, tolerance_); break;
+                case zfp_mode_fixed_rate:
+                    zfp_stream_set_rate(zfp, rate_, type_, zfp_field_dimensionality(field), 0); break;
+                case zfp_mode_fixed_precision:
+                    zfp_stream_set_precision(zfp, precision_); break;
+                default:
+                    zfp_stream_set_reversible(zfp); break;
+            }
+            return zfp;
+        }
+
+        static const zfp_type type_ = std::is_same<T, double>::value ? zfp_type_double : zfp_type_float;
+
+        types::ShapeType chunkShape_;
+        // the zfp mode and its parameters
+        int mode_;
+        double tolerance_;
+        double rate_;
+        int precision_;
+    };
+
+} // namespace compression
+} // namespace z5
+
+#endif
@@ -3,18 +3,171 @@
 #ifdef WITH_ZLIB
 
 #include <zlib.h>
+#ifdef WITH_LIBDEFLATE
+#include <libdeflate.h>
+#endif
+
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <vector>
 
 #include "z5/compression/compressor_base.hxx"
 #include "z5/metadata.hxx"
+#include "z5/util/buffer_pool.hxx"
+#include "z5/util/threadpool.hxx"
 
 // zlib manual:
 // https://zlib.net/manual.html
+// if WITH_LIBDEFLATE is set, we decompress with libdeflate, which is faster because it
+// decompresses buffer to buffer in one go; compression always uses zlib, so that
+// the compressed data is the same for both builds:
+// https://github.com/ebiggers/libdeflate
 
 // calls to ZLIB interface following
 // https://blog.cppse.nl/deflate-and-gzip-compress-and-decompress-functions
 
 namespace z5 {
 namespace compression {
+namespace zlib_detail {
+
+    // zlib stream that is initialized once per thread and reset for every chunk,
+    // so that the internal state (several hundred KB for deflate) is not
+    // allocated and freed for every chunk;
+    // the stream is re-initialized if the parameters change
+    class DeflateStream {
+
+    public:
+        DeflateStream() : initialized_(false) {
+        }
+
+        ~DeflateStream() {
+            if(initialized_) {
+                deflateEnd(&zs_);
+            }
+        }
+
+        z_stream & get(const int level, const int windowBits, const int memLevel) {
+            if(initialized_ && level == level_ && windowBits == windowBits_ && memLevel == memLevel_) {
+                if(deflateReset(&zs_) != Z_OK) {
+                    throw(std::runtime_error("Resetting zLib deflate failed"));
+                }
+                return zs_;
+            }
+            if(initialized_) {
+                deflateEnd(&zs_);
+                initialized_ = false;
+            }
+            memset(&zs_, 0, sizeof(zs_));
+            if(deflateInit2(&zs_, level, Z_DEFLATED, windowBits, memLevel, Z_DEFAULT_STRATEGY) != Z_OK) {
+                throw(std::runtime_error("Initializing zLib deflate failed"));
+            }
+            initialized_ = true;
+            level_ = level;
+            windowBits_ = windowBits;
+            memLevel_ = memLevel;
+            return zs_;
+        }
+
+        DeflateStream(const DeflateStream &) = delete;
+        DeflateStream & operator=(const DeflateStream &) = delete;
+
+    private:
+        z_stream zs_;
+        bool initialized_;
+        int level_, windowBits_, memLevel_;
+    };
+
+
+    class InflateStream {
+
+    public:
+        InflateStream() : initialized_(false) {
+        }
+
+        ~InflateStream() {
+            if(initialized_) {
+                inflateEnd(&zs_);
+            }
+        }
+
+        z_stream & get(const int windowBits) {
+            if(initialized_ && windowBits == windowBits_) {
+                if(inflateReset(&zs_) != Z_OK) {
+                    throw(std::runtime_error("Resetting zLib inflate failed"));
+                }
+                return zs_;
+            }
+            if(initialized_) {
+                inflateEnd(&zs_);
+                initialized_ = false;
+            }
+            memset(&zs_, 0, sizeof(zs_));
+            if(inflateInit2(&zs_, windowBits) != Z_OK) {
+                throw(std::runtime_error("Initializing zLib inflate failed"));
+            }
+            initialized_ = true;
+            windowBits_ = windowBits;
+            return zs_;
+        }
+
+        InflateStream(const InflateStream &) = delete;
+        InflateStream & operator=(const InflateStream &) = delete;
+
+    private:
+        z_stream zs_;
+        bool initialized_;
+        int windowBits_;
+    };
+
+
+    #ifdef WITH_LIBDEFLATE
+    // libdeflate decompressor, which is allocated once per thread
+    class Decompressor {
+
+    public:
+        Decompressor() : decompressor_(libdeflate_alloc_decompressor()) {
+            if(decompressor_ == nullptr) {
+                throw(std::runtime_error("Initializing libdeflate decompressor failed"));
+            }
+        }
+
+        ~Decompressor() {
+            libdeflate_free_decompressor(decompressor_);
+        }
+
+        libdeflate_decompressor * get() {
+            return decompressor_;
+        }
+
+        Decompressor(const Decompressor &) = delete;
+        Decompressor & operator=(const Decompressor &) = delete;
+
+    private:
+        libdeflate_decompressor * decompressor_;
+    };
+
+    inline Decompressor & threadDecompressor() {
+        static thread_local Decompressor decompressor;
+        return decompressor;
+    }
+    #endif
+
+
+    inline DeflateStream & threadDeflateStream() {
+        static thread_local DeflateStream stream;
+        return stream;
+    }
+
+    inline InflateStream & threadInflateStream() {
+        static thread_local InflateStream stream;
+        return stream;
+    }
+
+}
+
 
     template<typename T>
     class ZlibCompressor : public CompressorBase<T> {
@@ -24,105 +177,101 @@ namespace compression {
             init(metadata);
         }
 
-        void compress(const T * dataIn, std::vector<T> & dataOut, size_t sizeIn) const {
+        // bring the vector overloads of the base class into scope
+        using CompressorBase<T>::compress;
+        using CompressorBase<T>::compressReversedEndianness;
 
-            // open the zlib stream
-            z_stream zs;
-            memset(&zs, 0, sizeof(zs));
+        size_t compress(const T * dataIn, size_t sizeIn, char * dataOut, size_t capacity) const {
 
-            // resize the out data to input size
-            dataOut.clear();
-            dataOut.resize(sizeIn);
-
-            // init the zlib stream
-            if(useZlibEncoding_) {
-                if(deflateInit(&zs, clevel_) != Z_OK){throw(std::runtime_error("Initializing zLib deflate failed"));}
-            } else {
-                if(deflateInit2(&zs, clevel_, Z_DEFLATED, gzipWindowsize + 16, gzipCFactor, Z_DEFAULT_STRATEGY) != Z_OK) {
-                    throw(std::runtime_error("Initializing zLib deflate failed"));
-                }
+            if(useParallelCompression(sizeIn)) {
+                return compressParallel(reinterpret_cast<const Bytef*>(dataIn), sizeIn * sizeof(T), dataOut, capacity);
             }
 
+            // get the (reset) zlib stream of this thread
+            z_stream & zs = deflateStream();
+
             // set the stream in-pointer to the input data and the input size
             // to the size of the input in bytes
             zs.next_in = (Bytef*) dataIn;
             zs.avail_in = sizeIn * sizeof(T);
 
-            // let zlib compress the bytes blockwise
-            int ret;
-            size_t currentPosition = 0;
-            do {
-                // set the stream out-pointer to the current position of the out-data
-                // and set the available out size to the remaining size in the vector not written at
-                //zs.next_out = reinterpret_cast<Bytef*>(&dataOut[currentPosition]);
-                zs.next_out = (Bytef*) &dataOut[currentPosition];
-                zs.avail_out = std::distance(dataOut.begin() + currentPosition, dataOut.end()) * sizeof(T);
-
-                ret = deflate(&zs, Z_FINISH);
-
-                // get the current position in the out vector
-                currentPosition = zs.total_out / sizeof(T);
-
-            } while(ret == Z_OK);
-
-            deflateEnd(&zs);
+            // the out data can hold the compression bound, so we can compress in one go
+            zs.next_out = reinterpret_cast<Bytef*>(dataOut);
+            zs.avail_out = capacity;
+            int ret = deflate(&zs, Z_FINISH);
 
     		if (ret != Z_STREAM_END) {          // an error occurred that was not EOF
     		    std::ostringstream oss;
-    		    oss << "Exception during zlib compression: (" << ret << ") " << zs.msg;
+    		    oss << "Exception during zlib compression: (" << ret << ") " << (zs.msg ? zs.msg : "");
     		    throw(std::runtime_error(oss.str()));
     		}
-
-            dataOut.resize(currentPosition);
-
+            return zs.total_out;
         }
 
 
-        void decompress(const std::vector<T> & dataIn, T * dataOut, size_t sizeOut) const {
-
-            // open the zlib stream
-            z_stream zs;
-            memset(&zs, 0, sizeof(zs));
+        // compress with reversed endianness, the input is swapped block by block
+        // into a small buffer that is fed to the zlib stream
+        size_t compressReversedEndianness(const T * dataIn, size_t sizeIn, char * dataOut, size_t capacity) const {
 
-            // init the zlib stream
-            if(useZlibEncoding_) {
-                if(inflateInit(&zs) != Z_OK){throw(std::runtime_error("Initializing zLib inflate failed"));}
-            } else {
-                if(inflateInit2(&zs, gzipWindowsize + 16) != Z_OK){throw(std::runtime_error("Initializing zLib inflate failed"));}
+            // the blocks of the parallel compression are primed with the
+            // preceding data, so we swap the full chunk first
+            if(useParallelCompression(sizeIn)) {
+                auto swapped = util::BufferPool<T>::acquire(sizeIn);
+                util::reverseEndianness(dataIn, swapped.data(), sizeIn);
+                return compressParallel(reinterpret_cast<const Bytef*>(swapped.data()), sizeIn * sizeof(T), dataOut, capacity);
             }
 
-            // set the stream input to the beginning of the input data
-            zs.next_in = (Bytef*) &dataIn[0];
-            zs.avail_in = dataIn.size() * sizeof(T);
+            // get the (reset) zlib stream of this thread
+            z_stream & zs = deflateStream();
+            zs.next_out = reinterpret_cast<Bytef*>(dataOut);
+            zs.avail_out = capacity;
 
-            // let zlib decompress the bytes blockwise
+            // we swap blocks of 64 KB
+            const size_t blockSize = (1 << 16) / sizeof(T) + 1;
+            auto block = util::BufferPool<T>::acquire(std::min(sizeIn, blockSize));
+            size_t inPosition = 0;
             int ret;
-            size_t currentPosition = 0;
-            size_t currentLength;
             do {
-                // set the stream outout to the output dat at the current position
-                // and set the available size to the remaining bytes in the output data
-                // reinterpret_cast because (Bytef*) throws warning
-                zs.next_out = reinterpret_cast<Bytef*>(dataOut + currentPosition);
-                zs.avail_out = (sizeOut - currentPosition) * sizeof(T);
+                // swap the next block if the stream has consumed the last one
+                if(zs.avail_in == 0 && inPosition < sizeIn) {
+                    const size_t blockLen = std::min(block.size(), sizeIn - inPosition);
+                    util::reverseEndianness(dataIn + inPosition, block.data(), blockLen);
+                    zs.next_in = (Bytef*) block.data();
+                    zs.avail_in = blockLen * sizeof(T);
+                    inPosition += blockLen;
+                }
+                ret = deflate(&zs, inPosition == sizeIn ? Z_FINISH : Z_NO_FLUSH);
+            } while(ret == Z_OK);
 
-                ret = inflate(&zs, Z_FINISH);
+    		if (ret != Z_STREAM_END) {          // an error occurred that was not EOF
+    		    std::ostringstream oss;
+    		    oss << "Exception during zlib compression: (" << ret << ") " << (zs.msg ? zs.msg : "");
+    		    throw(std::runtime_error(oss.str()));
+    		}
+            return zs.total_out;
+        }
 
-                // get the current position in the out data
-                currentPosition = zs.total_out / sizeof(T);
 
-            } while(ret == Z_OK);
+        size_t maxCompressedSize(size_t sizeIn) const {
+            // the bound zlib's deflateBound gives for non-default stream parameters,
+            // plus the size of the gzip header and trailer
+            const size_t nBytes = sizeIn * sizeof(T);
+            // the blocks of the parallel compression end with a sync flush,
+            // which adds a few bytes per block
+            const size_t flushBytes = (nThreads_ > 1) ? 16 * (nBytes / parallelBlockSize + 1) : 0;
+            return nBytes + ((nBytes + 7) >> 3) + ((nBytes + 63) >> 6) + 5 + 18 + flushBytes;
+        }
 
-            inflateEnd(&zs);
+        // bring the vector overload of the base class into scope
+        using CompressorBase<T>::decompress;
 
-            // FIXME for some reasion this always failes with a -5 error (Z_BUF_ERROR)
-            // but the tests seem to work just fine...
-			//if (ret != Z_STREAM_END) {          // an error occurred that was not EOF
-    		//	std::ostringstream oss;
-    		//	oss << "Exception during zlib decompression: (" << ret << ") " << zs.msg;
-    		//	throw(std::runtime_error(oss.str()));
-    		//}
-		}
+        void decompress(const char * dataIn, size_t sizeIn, T * dataOut, size_t sizeOut) const {
+            #ifdef WITH_LIBDEFLATE
+            decompressLibdeflate(dataIn, sizeIn, dataOut, sizeOut);
+            #else
+            decompressZlib(dataIn, sizeIn, dataOut, sizeOut);
+            #endif
+        }
 
         virtual types::Compressor type() const {
             return types::zlib;
@@ -132,21 +281,216 @@ namespace compression {
             codec = useZlibEncoding_ ? "zlib" : "gzip";
         }
 
+        // number of threads used to compress large chunks
+        // numberOfThreads <= 0 means using all available cores
+        virtual void setNumberOfThreads(const int numberOfThreads) {
+            nThreads_ = (numberOfThreads > 0) ? numberOfThreads :
+                std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+            // the pool is created with the new number of threads when it is needed
+            threadpool_.reset();
+        }
+        virtual int numberOfThreads() const {return nThreads_;}
+
     private:
+        // we know the size of the decompressed chunk, so we can inflate in one go
+        // NOTE chunks written by older versions of z5 were cut to a multiple of sizeof(T),
+        // which drops up to sizeof(T) - 1 bytes of the zlib / gzip trailer; such chunks end
+        // with Z_BUF_ERROR after the full output and are accepted (without checksum), like
+        // the old decompression did
+        void decompressZlib(const char * dataIn, size_t sizeIn, T * dataOut, size_t sizeOut) const {
+
+            // get the (reset) zlib stream of this thread
+            z_stream & zs = zlib_detail::threadInflateStream().get(
+                useZlibEncoding_ ? gzipWindowsize : gzipWindowsize + 16
+            );
+
+            zs.next_in = (Bytef*) dataIn;
+            zs.avail_in = sizeIn;
+            zs.next_out = reinterpret_cast<Bytef*>(dataOut);
+            zs.avail_out = sizeOut * sizeof(T);
+
+            const int ret = inflate(&zs, Z_FINISH);
+            const bool truncatedTrailer = ret == Z_BUF_ERROR && zs.avail_in == 0 && zs.total_out == sizeOut * sizeof(T);
+            if(ret != Z_STREAM_END && !truncatedTrailer) {
+                std::ostringstream oss;
+                oss << "Exception during zlib decompression: (" << ret << ") " << (zs.msg ? zs.msg : "");
+                throw(std::runtime_error(oss.str()));
+            }
+            if(zs.total_out != sizeOut * sizeof(T)) {
+                throw std::runtime_error("Exception during zlib decompression: wrong chunk size");
+            }
+        }
+
+        #ifdef WITH_LIBDEFLATE
+        // one-shot buffer to buffer decompression with libdeflate,
+        // trailing bytes after the stream (element padding) are ignored;
+        // libdeflate rejects chunks with a truncated trailer (see decompressZlib),
+        // so these errors are passed on to zlib, which reads these chunks or throws
+        void decompressLibdeflate(const char * dataIn, size_t sizeIn, T * dataOut, size_t sizeOut) const {
+            libdeflate_decompressor * decompressor = zlib_detail::threadDecompressor().get();
+            size_t inBytes;
+            const auto ret = useZlibEncoding_ ?
+                libdeflate_zlib_decompress_ex(decompressor, dataIn, sizeIn, dataOut, sizeOut * sizeof(T), &inBytes, nullptr) :
+                libdeflate_gzip_decompress_ex(decompressor, dataIn, sizeIn, dataOut, sizeOut * sizeof(T), &inBytes, nullptr);
+            if(ret == LIBDEFLATE_INSUFFICIENT_SPACE) {
+                throw std::runtime_error("Exception during zlib decompression: wrong chunk size");
+            } else if(ret == LIBDEFLATE_BAD_DATA || ret == LIBDEFLATE_SHORT_OUTPUT) {
+                decompressZlib(dataIn, sizeIn, dataOut, sizeOut);
+            } else if(ret != LIBDEFLATE_SUCCESS) {
+                std::ostringstream oss;
+                oss << "Exception during zlib decompression: (libdeflate " << ret << ") invalid data";
+                throw(std::runtime_error(oss.str()));
+            }
+        }
+        #endif
+
+        // if we are called from a thread pool, the chunks are already
+        // processed in parallel and we don't use additional threads;
+        // chunks that fit into a single block are compressed serially
+        inline bool useParallelCompression(const size_t sizeIn) const {
+            return nThreads_ > 1 && sizeIn * sizeof(T) > parallelBlockSize && !util::ThreadPool::isWorkerThread();
+        }
+
+        // the pool for the parallel compression, which is kept for all chunks
+        // (the worker threads also keep their deflate streams)
+        util::ThreadPool & threadpool() const {
+            std::lock_guard<std::mutex> lock(threadpoolMutex_);
+            if(!threadpool_) {
+                threadpool_.reset(new util::ThreadPool(nThreads_));
+            }
+            return *threadpool_;
+        }
+
+        // pigz-style parallel compression: the data is split into blocks, which are deflated
+        // independently (primed with the preceding 32 KB as dictionary) and end with a sync flush;
+        // the blocks are joined into a single gzip / zlib stream that any inflater can read
+        size_t compressParallel(const Bytef * dataIn, const size_t nBytes, char * dataOut, const size_t capacity) const {
+            const size_t blockSize = parallelBlockSize;
+            const size_t nBlocks = nBytes / blockSize + (nBytes % blockSize == 0 ? 0 : 1);
+            const int memLevel = useZlibEncoding_ ? 8 : gzipCFactor;
+
+            // the blocks are compressed to slots of a buffer from the buffer pool
+            // that can hold the compressed block and the sync flush marker
+            const size_t slotSize = compressBound(blockSize) + 16;
+            auto blocks = util::BufferPool<char>::acquire(nBlocks * slotSize);
+            std::vector<size_t> blockBytes(nBlocks);
+            std::vector<uLong> checksums(nBlocks);
+
+            util::parallel_foreach(threadpool(), nBlocks, [&](const int, const size_t blockId){
+                const size_t begin = blockId * blockSize;
+                const size_t len = std::min(blockSize, nBytes - begin);
+                const bool lastBlock = blockId == nBlocks - 1;
+
+                // raw deflate stream of the worker thread, the header and trailer are written below
+                z_stream & zs = zlib_detail::threadDeflateStream().get(clevel_, -gzipWindowsize, memLevel);
+                if(begin > 0) {
+                    const size_t dictSize = std::min(begin, static_cast<size_t>(1 << gzipWindowsize));
+                    if(deflateSetDictionary(&zs, dataIn + begin - dictSize, dictSize) != Z_OK) {
+                        throw(std::runtime_error("Setting zLib dictionary failed"));
+                    }
+                }
+
+                zs.next_in = const_cast<Bytef*>(dataIn + begin);
+                zs.avail_in = len;
+                zs.next_out = reinterpret_cast<Bytef*>(blocks.data() + blockId * slotSize);
+                zs.avail_out = slotSize;
+
+                const int ret = deflate(&zs, lastBlock ? Z_FINISH : Z_SYNC_FLUSH);
+                if(ret != (lastBlock ? Z_STREAM_END : Z_OK) || zs.avail_in != 0 || zs.avail_out == 0) {
+                    std::ostringstream oss;
+                    oss << "Exception during zlib compression: (" << ret << ") " << (zs.msg ? zs.msg : "");
+                    throw(std::runtime_error(oss.str()));
+                }
+                blockBytes[blockId] = zs.total_out;
+
+                checksums[blockId] = useZlibEncoding_ ? adler32(adler32(0L, Z_NULL, 0), dataIn + begin, len) :
+                                                        crc32(crc32(0L, Z_NULL, 0), dataIn + begin, len);
+            });
+
+            // combine the checksums of the blocks
+            uLong checksum = useZlibEncoding_ ? adler32(0L, Z_NULL, 0) : crc32(0L, Z_NULL, 0);
+            size_t compressedBytes = 0;
+            for(size_t blockId = 0; blockId < nBlocks; ++blockId) {
+                const size_t len = std::min(blockSize, nBytes - blockId * blockSize);
+                checksum = useZlibEncoding_ ? adler32_combine(checksum, checksums[blockId], len) :
+                                              crc32_combine(checksum, checksums[blockId], len);
+                compressedBytes += blockBytes[blockId];
+            }
+
+            // header and trailer as written by zlib
+            const size_t headerBytes = useZlibEncoding_ ? 2 : 10;
+            const size_t trailerBytes = useZlibEncoding_ ? 4 : 8;
+            if(headerBytes + compressedBytes + trailerBytes > capacity) {
+                throw std::runtime_error("Exception during zlib compression: out buffer too small");
+            }
+
+            unsigned char * out = reinterpret_cast<unsigned char*>(dataOut);
+            if(useZlibEncoding_) {
+                const unsigned levelFlags = (clevel_ >= 0 && clevel_ < 2) ? 0 : (clevel_ >= 0 && clevel_ < 6) ? 1 :
+                                            (clevel_ == 6 || clevel_ < 0) ? 2 : 3;
+                const unsigned cmf = 0x78;
+                unsigned flg = levelFlags << 6;
+                flg += 31 - ((cmf << 8) + flg) % 31;
+                out[0] = cmf;
+                out[1] = flg;
+            } else {
+                const unsigned char header[10] = {0x1f, 0x8b, 8, 0, 0, 0, 0, 0,
+                                                  static_cast<unsigned char>(clevel_ == 9 ? 2 : (clevel_ == 1 ? 4 : 0)), 3};
+                std::memcpy(out, header, 10);
+            }
+
+            size_t pos = headerBytes;
+            for(size_t blockId = 0; blockId < nBlocks; ++blockId) {
+                std::memcpy(out + pos, blocks.data() + blockId * slotSize, blockBytes[blockId]);
+                pos += blockBytes[blockId];
+            }
+
+            if(useZlibEncoding_) {
+                // adler32 in big endian
+                for(int i = 3; i >= 0; --i) {
+                    out[pos++] = (checksum >> (8 * i)) & 0xff;
+                }
+            } else {
+                // crc32 and input size (modulo 2^32) in little endian
+                for(int i = 0; i < 4; ++i) {
+                    out[pos++] = (checksum >> (8 * i)) & 0xff;
+                }
+                for(int i = 0; i < 4; ++i) {
+                    out[pos++] = (nBytes >> (8 * i)) & 0xff;
+                }
+            }
+            return pos;
+        }
+
+        // deflateInit uses the default window size and memory level
+        inline z_stream & deflateStream() const {
+            return useZlibEncoding_ ?
+                zlib_detail::threadDeflateStream().get(clevel_, gzipWindowsize, 8) :
+                zlib_detail::threadDeflateStream().get(clevel_, gzipWindowsize + 16, gzipCFactor);
+        }
+
         void init(const DatasetMetadata & metadata) {
             // TODO clevel = compressorLevel -1 ???
             clevel_ = metadata.compressorLevel;
             useZlibEncoding_ = (metadata.codec == "zlib") ? true : false;
+            setNumberOfThreads(metadata.compressorThreads);
         }
 
         // compression level
         int clevel_;
         // use zlib or gzip encoding
         bool useZlibEncoding_;
+        // number of threads for the parallel compression
+        int nThreads_;
+        // pool for the parallel compression, created when it is first needed
+        mutable std::unique_ptr<util::ThreadPool> threadpool_;
+        mutable std::mutex threadpoolMutex_;
 
         const static int gzipWindowsize = 15;
         //static int gzipBsize = 8096;
         const static int gzipCFactor = 9;
+        // block size of the parallel compression (the same as pigz)
+        const static size_t parallelBlockSize = 128 * 1024;
     };
 
 } // namespace compression
@@ -0,0 +1,152 @@
+#pragma once
+
+#ifdef WITH_ZSTD
+
+#include <sstream>
+#include <zstd.h>
+
+#include "z5/compression/compressor_base.hxx"
+#include "z5/metadata.hxx"
+
+// zstd manual:
+// https://facebook.github.io/zstd/zstd_manual.html
+
+namespace z5 {
+namespace compression {
+namespace zstd_detail {
+
+    // zstd contexts that are created once per thread and reused for every chunk,
+    // so that the internal state is not allocated and freed for every chunk
+    class Contexts {
+
+    public:
+        Contexts() : cctx_(ZSTD_createCCtx()), dctx_(ZSTD_createDCtx()) {
+            if(cctx_ == nullptr || dctx_ == nullptr) {
+                ZSTD_freeCCtx(cctx_);
+                ZSTD_freeDCtx(dctx_);
+                throw std::runtime_error("Creating zstd contexts failed");
+            }
+        }
+
+        ~Contexts() {
+            ZSTD_freeCCtx(cctx_);
+            ZSTD_freeDCtx(dctx_);
+        }
+
+        // get the compression context with the given parameters,
+        // the parameters are sticky, so we only reset the session
+        // if they did not change
+        ZSTD_CCtx * compressionContext(const int level, const bool longDistanceMatching) {
+            if(!initialized_ || level != level_ || longDistanceMatching != longDistanceMatching_) {
+                ZSTD_CCtx_reset(cctx_, ZSTD_reset_session_and_parameters);
+                check(ZSTD_CCtx_setParameter(cctx_, ZSTD_c_compressionLevel, level));
+                check(ZSTD_CCtx_setParameter(cctx_, ZSTD_c_enableLongDistanceMatching, longDistanceMatching ? 1 : 0));
+                initialized_ = true;
+                level_ = level;
+                longDistanceMatching_ = longDistanceMatching;
+            } else {
+                ZSTD_CCtx_reset(cctx_, ZSTD_reset_session_only);
+            }
+            return cctx_;
+        }
+
+        ZSTD_DCtx * decompressionContext() {
+            ZSTD_DCtx_reset(dctx_, ZSTD_reset_session_only);
+            return dctx_;
+        }
+
+        static inline size_t check(const size_t ret) {
+            if(ZSTD_isError(ret)) {
+                std::ostringstream oss;
+                oss << "Exception during zstd (de)compression: " << ZSTD_getErrorName(ret);
+                throw std::runtime_error(oss.str());
+            }
+            return ret;
+        }
+
+        Contexts(const Contexts &) = delete;
+        Contexts & operator=(const Contexts &) = delete;
+
+    private:
+        ZSTD_CCtx * cctx_;
+        ZSTD_DCtx * dctx_;
+        bool initialized_ = false;
+        int level_;
+        bool longDistanceMatching_;
+    };
+
+
+    inline Contexts & threadContexts() {
+        static thread_local Contexts contexts;
+        return contexts;
+    }
+
+}
+
+
+    template<typename T>
+    class ZstdCompressor : public CompressorBase<T> {
+
+    public:
+        ZstdCompressor(const DatasetMetadata & metadata) {
+            init(metadata);
+        }
+
+        // bring the vector overloads of the base class into scope
+        using CompressorBase<T>::compress;
+        using CompressorBase<T>::compressReversedEndianness;
+
+        // NOTE we use the default implementation of compressReversedEndianness (swapping a
+        // pooled copy), because streaming the swapped blocks results in different frames
+
+        size_t compress(const T * dataIn, size_t sizeIn, char * dataOut, size_t capacity) const {
+            ZSTD_CCtx * cctx = zstd_detail::threadContexts().compressionContext(clevel_, longDistanceMatching_);
+            return zstd_detail::Contexts::check(
+                ZSTD_compress2(cctx, dataOut, capacity, dataIn, sizeIn * sizeof(T))
+            );
+        }
+
+
+        size_t maxCompressedSize(size_t sizeIn) const {
+            return ZSTD_compressBound(sizeIn * sizeof(T));
+        }
+
+        // bring the vector overload of the base class into scope
+        using CompressorBase<T>::decompress;
+
+        void decompress(const char * dataIn, size_t sizeIn, T * dataOut, size_t sizeOut) const {
+            ZSTD_DCtx * dctx = zstd_detail::threadContexts().decompressionContext();
+            // the input may be padded to full elements, so we only pass the frame itself
+            const size_t frameSize = zstd_detail::Contexts::check(ZSTD_findFrameCompressedSize(dataIn, sizeIn));
+            const size_t nBytes = zstd_detail::Contexts::check(
+                ZSTD_decompressDCtx(dctx, dataOut, sizeOut * sizeof(T), dataIn, frameSize)
+            );
+            if(nBytes != sizeOut * sizeof(T)) {
+                throw std::runtime_error("Exception during zstd decompression: wrong chunk size");
+            }
+        }
+
+        virtual types::Compressor type() const {
+            return types::zstd;
+        }
+
+        virtual void getCodec(std::string & codec) const {
+            codec = "zstd";
+        }
+
+    private:
+        void init(const DatasetMetadata & metadata) {
+            clevel_ = metadata.compressorLevel;
+            longDistanceMatching_ = metadata.compressorLongDistanceMatching;
+        }
+
+        // compression level
+        int clevel_;
+        // use long distance matching
+        bool longDistanceMatching_;
+    };
+
+} // namespace compression
+} // namespace z5
+
+#endif
@@ -6,12 +6,20 @@
 #include "z5/handle/handle.hxx"
 #include "z5/types/types.hxx"
 #include "z5/util/util.hxx"
+#include "z5/util/buffer_pool.hxx"
+#include "z5/util/chunk_cache.hxx"
+#include "z5/util/chunk_range.hxx"
+#include "z5/util/io_stats.hxx"
+#include "z5/util/trace.hxx"
 
 // different compression backends
 #include "z5/compression/raw_compressor.hxx"
+#include "z5/compression/compressed_segmentation_compressor.hxx"
 #include "z5/compression/blosc_compressor.hxx"
 #include "z5/compression/zlib_compressor.hxx"
 #include "z5/compression/bzip2_compressor.hxx"
+#include "z5/compression/zstd_compressor.hxx"
+#include "z5/compression/zfp_compressor.hxx"
 
 // different io backends
 #include "z5/io/io_zarr.hxx"
@@ -30,29 +38,46 @@ namespace z5 {
 
         // we need to use void pointer here to have a generic API
         // write a chunk
-        virtual void writeChunk(const types::ShapeType &, const void *) const = 0;
+        virtual void writeChunk(const types::CoordinateType &, const void *) const = 0;
         // read a chunk
-        virtual void readChunk(const types::ShapeType &, void *) const = 0;
+        virtual void readChunk(const types::CoordinateType &, void *) const = 0;
+        // read a chunk that is partially overwritten and written right after (read-modify-write),
+        // the chunk is not put into the cache, because the write invalidates it anyway
+        virtual void readChunkForUpdate(const types::CoordinateType &, void *) const = 0;
 
         // helper functions for multiarray API
-        virtual void checkRequestShape(const types::ShapeType &, const types::ShapeType &) const = 0;
+        // (the coordinates can also be passed as types::ShapeType)
+        virtual void checkRequestShape(const types::CoordinateType &, const types::CoordinateType &) const = 0;
         virtual void checkRequestType(const std::type_info &) const = 0;
         virtual void getChunkRequests(
-            const types::ShapeType &,
-            const types::ShapeType &,
+            const types::CoordinateType &,
+            const types::CoordinateType &,
             std::vector<types::ShapeType> &) const = 0;
+        virtual void getChunkRange(
+            const types::CoordinateType &,
+            const types::CoordinateType &,
+            util::ChunkRange &,
+            const util::TraversalOrder order=util::cOrder) const = 0;
         virtual bool getCoordinatesInRequest(
-            const types::ShapeType &,
-            const types::ShapeType &,
-            const types::ShapeType &,
+            const types::CoordinateType &,
+            const types::CoordinateType &,
+            const types::CoordinateType &,
+            types::CoordinateType &,
+            types::CoordinateType &,
+            types::CoordinateType &) const = 0;
+        virtual bool getCoordinatesInRequest(
+            const types::CoordinateType &,
+            const types::CoordinateType &,
+            const types::CoordinateType &,
             types::ShapeType &,
             types::ShapeType &,
             types::ShapeType &) const = 0;
 
         // size and shape of an actual chunk
-        virtual size_t getChunkSize(const types::ShapeType &) const = 0;
-        virtual void getChunkShape(const types::ShapeType &, types::ShapeType &) const = 0;
-        virtual size_t getChunkShape(const types::ShapeType &, const unsigned) const = 0;
+        virtual size_t getChunkSize(const types::CoordinateType &) const = 0;
+        virtual void getChunkShape(const types::CoordinateType &, types::CoordinateType &) const = 0;
+        virtual void getChunkShape(const types::CoordinateType &, types::ShapeType &) const = 0;
+        virtual size_t getChunkShape(const types::CoordinateType &, const unsigned) const = 0;
 
         // maximal chunk size and shape
         virtual size_t maxChunkSize() const = 0;
@@ -75,6 +100,65 @@ namespace z5 {
         virtual types::Compressor getCompressor() const = 0;
         virtual void getCodec(std::string &) const = 0;
         virtual const handle::Dataset & handle() const = 0;
+
+        // cache for decoded chunks, the size is given in bytes
+        // and a cache size of 0 disables the cache
+        virtual void setCacheSize(const size_t) = 0;
+        virtual size_t cacheSize() const = 0;
+        virtual void clearCache() = 0;
+        virtual size_t cacheHits() const = 0;
+        virtual size_t cacheMisses() const = 0;
+        virtual void resetCacheCounters() = 0;
+
+        // read the chunk files via memory mapping instead of
+        // copying them to a buffer first
+        virtual void setUseMmap(const bool) = 0;
+        virtual bool useMmap() const = 0;
+
+        // number of threads the compressor uses for a single chunk
+        // (supported by blosc and by zlib / gzip compression of chunks larger
+        // than 128 KB, <= 0 means using all available cores);
+        // calls from the worker threads of chunk-parallel reads / writes
+        // always use a single thread per chunk
+        virtual void setCompressorThreads(const int) = 0;
+        virtual int compressorThreads() const = 0;
+
+        // statistics of the chunk I/O (chunks, bytes and time per stage);
+        // only recorded if z5 is built with WITH_INSTRUMENTATION, otherwise all zero
+        virtual util::IoStats ioStats() const = 0;
+        virtual void resetIoStats() = 0;
+        // the counters, so that the stages outside of the dataset (copying) can be recorded
+        virtual util::IoCounters & ioCounters() const = 0;
+
+        // read-ahead of the chunks in multiarray::readSubarray: the compressed chunks are read
+        // by the prefetch threads while the chunks that were read before are decoded and copied;
+        // the size is the budget for the chunks that are read ahead in bytes,
+        // a size of 0 disables prefetching
+        virtual void setPrefetchSize(const size_t) = 0;
+        virtual size_t prefetchSize() const = 0;
+        virtual void setPrefetchThreads(const int) = 0;
+        virtual int prefetchThreads() const = 0;
+    };
+
+
+    // compressed data of a chunk that was read ahead of decoding it,
+    // see DatasetTyped::fetchChunk and DatasetTyped::decodeChunk
+    template<typename T>
+    struct FetchedChunk {
+        types::CoordinateType chunkId;
+        // the chunk was in the cache when it was fetched, so nothing was read
+        bool cached = false;
+        // the chunk exists, otherwise it is filled with the fill value
+        bool exists = false;
+        // write generation of the chunk in the cache when it was fetched
+        size_t generation = 0;
+        // the compressed data, either read to the buffer or mapped
+        std::vector<T> data;
+        io::MappedChunk mapped;
+
+        inline size_t nBytes() const {
+            return mapped.isMapped() ? mapped.size() : data.size() * sizeof(T);
+        }
     };
 
 
@@ -87,7 +171,7 @@ namespace z5 {
         // create a new array with metadata
         DatasetTyped(
             const handle::Dataset & handle,
-            const DatasetMetadata & metadata) : handle_(handle) {
+            const DatasetMetadata & metadata) : handle_(handle), useMmap_(false), prefetchSize_(0), prefetchThreads_(4) {
 
             // make sure that the file does not exist already
             if(handle.exists()) {
@@ -102,7 +186,7 @@ namespace z5 {
 
 
         // open existing array
-        DatasetTyped(const handle::Dataset & handle) : handle_(handle) {
+        DatasetTyped(const handle::Dataset & handle) : handle_(handle), useMmap_(false), prefetchSize_(0), prefetchThreads_(4) {
 
             // make sure that the file exists
             if(!handle.exists()) {
@@ -116,7 +200,7 @@ namespace z5 {
         }
 
 
-        virtual inline void writeChunk(const types::ShapeType & chunkIndices, const void * dataIn) const {
+        virtual inline void writeChunk(const types::CoordinateType & chunkIndices, const void * dataIn) const {
             handle::Chunk chunk(handle_, chunkIndices, isZarr_);
             writeChunk(chunk, dataIn);
         }
@@ -124,13 +208,101 @@ namespace z5 {
 
         // read a chunk
         // IMPORTANT we assume that the data pointer is already initialized up to chunkSize_
-        virtual inline void readChunk(const types::ShapeType & chunkIndices, void * dataOut) const {
+        virtual inline void readChunk(const types::CoordinateType & chunkIndices, void * dataOut) const {
+            handle::Chunk chunk(handle_, chunkIndices, isZarr_);
+            readChunk(chunk, dataOut, true);
+        }
+
+
+        virtual inline void readChunkForUpdate(const types::CoordinateType & chunkIndices, void * dataOut) const {
             handle::Chunk chunk(handle_, chunkIndices, isZarr_);
-            readChunk(chunk, dataOut);
+            readChunk(chunk, dataOut, false);
         }
 
 
-        virtual void checkRequestShape(const types::ShapeType & offset, const types::ShapeType & shape) const {
+        // read a chunk in two stages, so that the chunks can be read from the storage
+        // ahead of decoding them (see multiarray/chunk_prefetch.hxx):
+        // fetchChunk reads the compressed chunk, unless it is cached, and
+        // decodeChunk decompresses it to the out data (or fills it)
+        inline void fetchChunk(const types::CoordinateType & chunkIndices, FetchedChunk<T> & fetched) const {
+            handle::Chunk chunk(handle_, chunkIndices, isZarr_);
+            checkChunk(chunk);
+            util::TraceScope trace("fetch_chunk", chunkIndices);
+
+            fetched.chunkId = chunkIndices;
+            fetched.mapped.unmap();
+            fetched.cached = cache_ && cache_->contains(chunkIndices);
+            fetched.generation = cache_ ? cache_->writeGeneration(chunkIndices) : 0;
+            // the buffer is resized by the read, we only clear it if it is not used,
+            // so that it is not value-initialized again for every chunk
+            fetched.exists = fetched.cached ? false : readCompressed(chunk, fetched.data, fetched.mapped);
+            if(!fetched.exists || fetched.mapped.isMapped()) {
+                fetched.data.clear();
+            }
+            // mapping only opens the file, so we ask the kernel to read it now
+            if(fetched.exists) {
+                fetched.mapped.willNeed();
+            }
+        }
+
+
+        inline void decodeChunk(const FetchedChunk<T> & fetched, void * dataOut) const {
+            handle::Chunk chunk(handle_, fetched.chunkId, isZarr_);
+            util::TraceScope trace("decode_chunk", fetched.chunkId);
+
+            if(cache_ && cache_->get(fetched.chunkId, static_cast<T*>(dataOut))) {
+                return;
+            }
+
+            // the chunk was evicted from the cache after it was fetched, so we read it now
+            if(fetched.cached) {
+                const size_t generation = cache_ ? cache_->writeGeneration(fetched.chunkId) : 0;
+                auto dataTmp = util::BufferPool<T>::acquire();
+                io::MappedChunk mappedTmp;
+                const bool chunkExists = readCompressed(chunk, dataTmp.vector(), mappedTmp);
+                decodeCompressed(chunk, chunkExists, dataTmp.vector(), mappedTmp, dataOut, true, generation);
+                return;
+            }
+            decodeCompressed(chunk, fetched.exists, fetched.data, fetched.mapped, dataOut, true, fetched.generation);
+        }
+
+
+        // read the sorted unique values of a chunk, using the fast path
+        // of the compressor if it has one (e.g. the label tables of compressed segmentation)
+        inline void readChunkUniqueValues(const types::CoordinateType & chunkIndices, std::vector<T> & values) const {
+            handle::Chunk chunk(handle_, chunkIndices, isZarr_);
+            checkChunk(chunk);
+
+            // chunks that don't exist only contain the fill value
+            auto dataTmp = util::BufferPool<T>::acquire();
+            if(!io_->read(chunk, dataTmp.vector())) {
+                values.assign(1, fillValue_);
+                return;
+            }
+
+            size_t chunkSize = isZarr_ ? chunkSize_ : io_->getChunkSize(chunk);
+            const bool reverseEndianness = sizeof(T) > 1 && !isZarr_;
+            const char * compressed = reinterpret_cast<const char *>(dataTmp.data());
+            const size_t compressedSize = dataTmp.size() * sizeof(T);
+            if(compressor_->uniqueValues(compressed, compressedSize, chunkSize, values)) {
+                // reverse the endianness for N5 data, which changes the order of the values
+                if(reverseEndianness) {
+                    util::reverseEndiannessInplace(values.data(), values.size());
+                }
+            } else {
+                values.resize(chunkSize);
+                if(reverseEndianness) {
+                    compressor_->decompressReversedEndianness(compressed, compressedSize, values.data(), chunkSize);
+                } else {
+                    compressor_->decompress(compressed, compressedSize, values.data(), chunkSize);
+                }
+            }
+            std::sort(values.begin(), values.end());
+            values.erase(std::unique(values.begin(), values.end()), values.end());
+        }
+
+
+        virtual void checkRequestShape(const types::CoordinateType & offset, const types::CoordinateType & shape) const {
             if(offset.size() != shape_.size() || shape.size() != shape_.size()) {
                 throw std::runtime_error("Request has wrong dimension");
             }
@@ -154,14 +326,26 @@ namespace z5 {
 
 
         virtual void getChunkRequests(
-            const types::ShapeType & offset,
-            const types::ShapeType & shape,
+            const types::CoordinateType & offset,
+            const types::CoordinateType & shape,
             std::vector<types::ShapeType> & chunkRequests) const {
+            util::ChunkRange chunkRange;
+            getChunkRange(offset, shape, chunkRange);
+            chunkRange.toVector(chunkRequests);
+        }
+
+        // get the range of chunks that are involved in the request, without
+        // materializing the chunk ids
+        virtual void getChunkRange(
+            const types::CoordinateType & offset,
+            const types::CoordinateType & shape,
+            util::ChunkRange & chunkRange,
+            const util::TraversalOrder order=util::cOrder) const {
 
             size_t nDim = offset.size();
             // iterate over the dimension and find the min and max chunk ids
-            types::ShapeType minChunkIds(nDim);
-            types::ShapeType maxChunkIds(nDim);
+            types::CoordinateType minChunkIds(nDim);
+            types::CoordinateType maxChunkIds(nDim);
             size_t endCoordinate, endId;
             for(int d = 0; d < nDim; ++d) {
                 // integer division is ok for both min and max-id, because
@@ -172,22 +356,39 @@ namespace z5 {
                 maxChunkIds[d] = (endCoordinate % chunkShape_[d] == 0) ? endId - 1 : endId;
             }
 
-            util::makeRegularGrid(minChunkIds, maxChunkIds, chunkRequests);
+            chunkRange.reset(minChunkIds, maxChunkIds, order);
         }
 
         virtual bool getCoordinatesInRequest(
-            const types::ShapeType & chunkId,
-            const types::ShapeType & offset,
-            const types::ShapeType & shape,
+            const types::CoordinateType & chunkId,
+            const types::CoordinateType & offset,
+            const types::CoordinateType & shape,
             types::ShapeType & localOffset,
             types::ShapeType & localShape,
             types::ShapeType & inChunkOffset) const {
+            types::CoordinateType localOffsetTmp, localShapeTmp, inChunkOffsetTmp;
+            bool completeOvlp = getCoordinatesInRequest(
+                chunkId, offset, shape, localOffsetTmp, localShapeTmp, inChunkOffsetTmp
+            );
+            localOffset.assign(localOffsetTmp.begin(), localOffsetTmp.end());
+            localShape.assign(localShapeTmp.begin(), localShapeTmp.end());
+            inChunkOffset.assign(inChunkOffsetTmp.begin(), inChunkOffsetTmp.end());
+            return completeOvlp;
+        }
+
+        virtual bool getCoordinatesInRequest(
+            const types::CoordinateType & chunkId,
+            const types::CoordinateType & offset,
+            const types::CoordinateType & shape,
+            types::CoordinateType & localOffset,
+            types::CoordinateType & localShape,
+            types::CoordinateType & inChunkOffset) const {
 
             localOffset.resize(offset.size());
             localShape.resize(offset.size());
             inChunkOffset.resize(offset.size());
 
-            types::ShapeType chunkShape;
+            types::CoordinateType chunkShape;
             getChunkShape(chunkId, chunkShape);
 
             bool completeOvlp = true;
@@ -239,17 +440,22 @@ namespace z5 {
             return completeOvlp;
         }
 
-        virtual void getChunkShape(const types::ShapeType & chunkId, types::ShapeType & chunkShape) const {
+        virtual void getChunkShape(const types::CoordinateType & chunkId, types::CoordinateType & chunkShape) const {
+            handle::Chunk chunk(handle_, chunkId, isZarr_);
+            getChunkShape(chunk, chunkShape);
+        }
+
+        virtual void getChunkShape(const types::CoordinateType & chunkId, types::ShapeType & chunkShape) const {
             handle::Chunk chunk(handle_, chunkId, isZarr_);
             getChunkShape(chunk, chunkShape);
         }
         
-        virtual size_t getChunkShape(const types::ShapeType & chunkId, const unsigned dim) const {
+        virtual size_t getChunkShape(const types::CoordinateType & chunkId, const unsigned dim) const {
             handle::Chunk chunk(handle_, chunkId, isZarr_);
             return getChunkShape(chunk, dim);
         }
         
-        virtual size_t getChunkSize(const types::ShapeType & chunkId) const {
+        virtual size_t getChunkSize(const types::CoordinateType & chunkId) const {
             handle::Chunk chunk(handle_, chunkId, isZarr_);
             return getChunkSize(chunk);
         }
@@ -278,6 +484,61 @@ namespace z5 {
         };
         virtual const handle::Dataset & handle() const {return handle_;}
 
+        // chunk cache
+        // NOTE changing the cache size is not thread-safe, but reading / writing
+        // chunks through the cache is
+        virtual void setCacheSize(const size_t maxBytes) {
+            if(maxBytes == 0) {
+                cache_.reset();
+            } else if(cache_) {
+                cache_->setMaxBytes(maxBytes);
+            } else {
+                cache_.reset(new util::ChunkCache<T>(maxBytes));
+            }
+        }
+        virtual size_t cacheSize() const {return cache_ ? cache_->maxBytes() : 0;}
+        virtual void clearCache() {
+            if(cache_) {
+                cache_->clear();
+            }
+        }
+        virtual size_t cacheHits() const {return cache_ ? cache_->hits() : 0;}
+        virtual size_t cacheMisses() const {return cache_ ? cache_->misses() : 0;}
+        virtual void resetCacheCounters() {
+            if(cache_) {
+                cache_->resetCounters();
+            }
+        }
+
+        // memory mapped reads
+        // NOTE changing this is not thread-safe
+        virtual void setUseMmap(const bool useMmap) {useMmap_ = useMmap;}
+        virtual bool useMmap() const {return useMmap_;}
+
+        // compressor threads
+        // NOTE changing this is not thread-safe
+        virtual void setCompressorThreads(const int numberOfThreads) {
+            compressor_->setNumberOfThreads(numberOfThreads);
+        }
+        virtual int compressorThreads() const {return compressor_->numberOfThreads();}
+
+        // chunk prefetching
+        // NOTE changing this is not thread-safe
+        virtual void setPrefetchSize(const size_t maxBytes) {prefetchSize_ = maxBytes;}
+        virtual size_t prefetchSize() const {return prefetchSize_;}
+        virtual void setPrefetchThreads(const int numberOfThreads) {
+            if(numberOfThreads < 1) {
+                throw std::runtime_error("Need at least one prefetch thread");
+            }
+            prefetchThreads_ = numberOfThreads;
+        }
+        virtual int prefetchThreads() const {return prefetchThreads_;}
+
+        // I/O statistics
+        virtual util::IoStats ioStats() const {return ioCounters_.stats();}
+        virtual void resetIoStats() {ioCounters_.reset();}
+        virtual util::IoCounters & ioCounters() const {return ioCounters_;}
+
         // delete copy constructor and assignment operator
         // because the compressor cannot be copied by default
         // and we don't really need this to be copyable afaik
@@ -310,6 +571,8 @@ namespace z5 {
             switch(metadata.compressor) {
                 case types::raw:
             	    compressor_.reset(new compression::RawCompressor<T>()); break;
+                case types::compressedSegmentation:
+            	    compressor_.reset(new compression::CompressedSegmentationCompressor<T>(metadata)); break;
                 #ifdef WITH_BLOSC
                 case types::blosc:
             	    compressor_.reset(new compression::BloscCompressor<T>(metadata)); break;
@@ -322,6 +585,14 @@ namespace z5 {
                 case types::bzip2:
             	    compressor_.reset(new compression::Bzip2Compressor<T>(metadata)); break;
                 #endif
+                #ifdef WITH_ZSTD
+                case types::zstd:
+            	    compressor_.reset(new compression::ZstdCompressor<T>(metadata)); break;
+                #endif
+                #ifdef WITH_ZFP
+                case types::zfp:
+            	    compressor_.reset(new compression::ZfpCompressor<T>(metadata)); break;
+                #endif
             }
 
             // chunk writer
@@ -348,62 +619,117 @@ namespace z5 {
 
             // make sure that we have a valid chunk
             checkChunk(chunk);
+            util::TraceScope trace("write_chunk", chunk.chunkIndices());
 
-            // get the correct chunk size and declare the out data
+            // get the correct chunk size and the out data from the buffer pool
             size_t chunkSize = isZarr_ ? chunkSize_ : io_->getChunkSize(chunk);
-            std::vector<T> dataOut;
+            const size_t capacity = compressor_->maxCompressedSize(chunkSize);
+            auto dataOut = util::BufferPool<char>::acquire(capacity);
+            size_t nBytes;
 
             // reverse the endianness if necessary
+            Z5_STAGE_TIMER(compressTimer, ioCounters_.compressNs);
+            util::TraceScope traceCompress("compress", chunk.chunkIndices());
             if(sizeof(T) > 1 && !isZarr_) {
 
-                // copy the data and reverse endianness
-                std::vector<T> dataTmp(static_cast<const T*>(dataIn), static_cast<const T*>(dataIn) + chunkSize);
-                util::reverseEndiannessInplace<T>(dataTmp.begin(), dataTmp.end());
-
-                // compress the data
-                compressor_->compress(&dataTmp[0], dataOut, chunkSize);
+                // compress the data, the compressor takes care of reversing the endianness
+                nBytes = compressor_->compressReversedEndianness(static_cast<const T*>(dataIn), chunkSize, dataOut.data(), capacity);
 
             } else {
 
                 // compress the data
-                compressor_->compress(static_cast<const T*>(dataIn), dataOut, chunkSize);
+                nBytes = compressor_->compress(static_cast<const T*>(dataIn), chunkSize, dataOut.data(), capacity);
 
             }
+            Z5_STAGE_STOP(compressTimer);
+            traceCompress.stop();
+            Z5_COUNT(ioCounters_.uncompressedBytesWritten, chunkSize * sizeof(T));
+            Z5_COUNT(ioCounters_.compressedBytesWritten, nBytes);
 
             // write the data
-            io_->write(chunk, dataOut);
+            Z5_STAGE_TIMER(writeTimer, ioCounters_.writeNs);
+            io_->write(chunk, dataOut.data(), nBytes);
+            Z5_STAGE_STOP(writeTimer);
+            Z5_COUNT(ioCounters_.chunksWritten, 1);
+
+            // the cached chunk is outdated now
+            if(cache_) {
+                cache_->erase(chunk.chunkIndices());
+            }
         }
 
 
-        inline void readChunk(const handle::Chunk & chunk, void * dataOut) const {
+        // read a chunk, if cacheChunk is true a chunk that is not cached is put into the cache
+        inline void readChunk(const handle::Chunk & chunk, void * dataOut, const bool cacheChunk) const {
 
             // make sure that we have a valid chunk
             checkChunk(chunk);
+            util::TraceScope trace("read_chunk", chunk.chunkIndices());
 
-            // read the data
-            std::vector<T> dataTmp;
-            auto chunkExists = io_->read(chunk, dataTmp);
+            // check if we have this chunk in the cache already
+            if(cache_ && cache_->get(chunk.chunkIndices(), static_cast<T*>(dataOut))) {
+                return;
+            }
+            // the write generation must be queried before the chunk is read, see ChunkCache::put
+            const size_t generation = cache_ ? cache_->writeGeneration(chunk.chunkIndices()) : 0;
+
+            // read the data, either by mapping the chunk file and decompressing
+            // from the mapped memory or by reading it to a buffer from the buffer pool
+            auto dataTmp = util::BufferPool<T>::acquire();
+            io::MappedChunk mappedTmp;
+            const bool chunkExists = readCompressed(chunk, dataTmp.vector(), mappedTmp);
+            decodeCompressed(chunk, chunkExists, dataTmp.vector(), mappedTmp, dataOut, cacheChunk, generation);
+        }
+
+
+        // read the compressed chunk, to the buffer or by mapping it;
+        // returns false if the chunk does not exist
+        inline bool readCompressed(const handle::Chunk & chunk, std::vector<T> & buffer, io::MappedChunk & mapped) const {
+            Z5_STAGE_TIMER(readTimer, ioCounters_.readNs);
+            return useMmap_ ? io_->read(chunk, mapped) : io_->read(chunk, buffer);
+        }
+
+
+        // decompress the compressed chunk (from the mapped memory, if it was mapped)
+        // or fill it if it does not exist and put it into the cache if cacheChunk is true
+        // (the generation is the write generation of the chunk before it was read)
+        inline void decodeCompressed(const handle::Chunk & chunk, const bool chunkExists,
+                                     const std::vector<T> & buffer, const io::MappedChunk & mapped,
+                                     void * dataOut, const bool cacheChunk, const size_t generation) const {
+            size_t chunkSize = isZarr_ ? chunkSize_ : io_->getChunkSize(chunk);
 
             // if the chunk exists, decompress it
             // otherwise we return the chunk with fill value
             if(chunkExists) {
 
-                size_t chunkSize = isZarr_ ? chunkSize_ : io_->getChunkSize(chunk);
-                compressor_->decompress(dataTmp, static_cast<T*>(dataOut), chunkSize);
+                const bool isMapped = mapped.isMapped();
+                const char * compressed = isMapped ? mapped.data() : reinterpret_cast<const char *>(buffer.data());
+                const size_t compressedSize = isMapped ? mapped.size() : buffer.size() * sizeof(T);
+                Z5_COUNT(ioCounters_.chunksRead, 1);
+                Z5_COUNT(ioCounters_.compressedBytesRead, compressedSize);
+                Z5_COUNT(ioCounters_.uncompressedBytesRead, chunkSize * sizeof(T));
 
-                // reverse the endianness for N5 data
+                // reverse the endianness for N5 data, the compressor takes care of this
                 // TODO actually check that the file endianness is different than the system endianness
+                Z5_STAGE_TIMER(decompressTimer, ioCounters_.decompressNs);
+                util::TraceScope traceDecompress("decompress", chunk.chunkIndices());
                 if(sizeof(T) > 1 && !isZarr_) { // we don't need to convert single bit numbers
-                    util::reverseEndiannessInplace<T>(
-                        static_cast<T*>(dataOut), static_cast<T*>(dataOut) + chunkSize);
+                    compressor_->decompressReversedEndianness(compressed, compressedSize, static_cast<T*>(dataOut), chunkSize);
+                } else {
+                    compressor_->decompress(compressed, compressedSize, static_cast<T*>(dataOut), chunkSize);
                 }
 
             }
 
             else {
-                size_t chunkSize = isZarr_ ? chunkSize_ : io_->getChunkSize(chunk);
+                Z5_COUNT(ioCounters_.chunksFilled, 1);
+                util::TraceScope traceFill("fill", chunk.chunkIndices());
                 std::fill(static_cast<T*>(dataOut), static_cast<T*>(dataOut) + chunkSize, fillValue_);
             }
+
+            if(cache_ && cacheChunk) {
+                cache_->put(chunk.chunkIndices(), static_cast<const T*>(dataOut), chunkSize, generation);
+            }
         }
 
 
@@ -424,7 +750,8 @@ namespace z5 {
         }
 
 
-        inline void getChunkShape(const handle::Chunk & chunk, types::ShapeType & chunkShape) const {
+        template<typename SHAPE>
+        inline void getChunkShape(const handle::Chunk & chunk, SHAPE & chunkShape) const {
             chunkShape.resize(shape_.size());
             // zarr has a fixed chunkShpae, whereas n5 has variable chunk shape
             if(isZarr_) {
@@ -439,7 +766,7 @@ namespace z5 {
             if(isZarr_) {
                 return maxChunkShape(dim);
             } else {
-                std::vector<size_t> tmpShape;
+                types::CoordinateType tmpShape;
                 getChunkShape(chunk, tmpShape);
                 return tmpShape[dim];
             }
@@ -450,7 +777,7 @@ namespace z5 {
             if(isZarr_) {
                 return maxChunkSize();
             } else {
-                std::vector<size_t> tmpShape;
+                types::CoordinateType tmpShape;
                 getChunkShape(chunk, tmpShape);
                 return std::accumulate(tmpShape.begin(), tmpShape.end(), 1, std::multiplies<size_t>());
             }
@@ -470,6 +797,20 @@ namespace z5 {
         // unique prtr chunk writer
         std::unique_ptr<io::ChunkIoBase<T>> io_;
 
+        // cache for decoded chunks (nullptr if the cache is disabled)
+        std::unique_ptr<util::ChunkCache<T>> cache_;
+
+        // flag to read the chunks via memory mapping
+        bool useMmap_;
+
+        // counters for the I/O statistics
+        mutable util::IoCounters ioCounters_;
+
+        // budget for the chunks that are read ahead (0 disables prefetching)
+        // and number of threads that read them
+        size_t prefetchSize_;
+        int prefetchThreads_;
+
         // flag to store whether the chunks are in zarr or n5 encoding
         bool isZarr_;
 
@@ -488,4 +829,14 @@ namespace z5 {
         types::ShapeType chunksPerDimension_;
     };
 
+
+    // read the sorted unique values of a chunk of a dataset with value type T
+    template<typename T>
+    inline void readChunkUniqueValues(const Dataset & ds,
+                                      const types::CoordinateType & chunkIndices,
+                                      std::vector<T> & values) {
+        ds.checkRequestType(typeid(T));
+        static_cast<const DatasetTyped<T> &>(ds).readChunkUniqueValues(chunkIndices, values);
+    }
+
 } // namespace::z5
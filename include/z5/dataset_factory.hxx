@@ -8,7 +8,8 @@ namespace fs = boost::filesystem;
 namespace z5 {
 
     // factory function to open an existing zarr-array
-    std::unique_ptr<Dataset> openDataset(const std::string & path) {
+    // (compressorThreads is the number of threads the compressor uses per chunk)
+    std::unique_ptr<Dataset> openDataset(const std::string & path, const int compressorThreads=1) {
 
         // read the data type from the metadata
         handle::Dataset h(path);
@@ -39,22 +40,26 @@ namespace z5 {
             case types::float64:
                 ptr.reset(new DatasetTyped<double>(h)); break;
         }
+        ptr->setCompressorThreads(compressorThreads);
         return ptr;
     }
 
 
     std::unique_ptr<Dataset> openDataset(
         const handle::Group & group,
-        const std::string & key
+        const std::string & key,
+        const int compressorThreads=1
     ) {
         auto path = group.path();
         path /= key;
-        return openDataset(path.string());
+        return openDataset(path.string(), compressorThreads);
     }
 
 
 
 
+    // factory function to create a new zarr-array;
+    // tolerance, rate and precision select the lossy modes of zfp (-1 if not used)
     std::unique_ptr<Dataset> createDataset(
         const std::string & path,
         const std::string & dtype,
@@ -65,7 +70,11 @@ namespace z5 {
         const std::string & compressor="blosc",
         const std::string & codec="lz4",
         const int compressorLevel=5,
-        const int compressorShuffle=1
+        const int compressorShuffle=1,
+        const int compressorBlocksize=0,
+        const double compressorTolerance=-1,
+        const double compressorRate=-1,
+        const int compressorPrecision=-1
     ) {
 
         // get the internal data type
@@ -88,8 +97,12 @@ namespace z5 {
             internalDtype, shape,
             chunkShape, createAsZarr,
             fillValue, internalCompressor,
-            codec, compressorLevel, compressorShuffle
+            codec, compressorLevel, compressorShuffle,
+            compressorBlocksize
         );
+        metadata.compressorTolerance = compressorTolerance;
+        metadata.compressorRate = compressorRate;
+        metadata.compressorPrecision = compressorPrecision;
 
         // make array handle
         handle::Dataset h(path);
@@ -133,14 +146,20 @@ namespace z5 {
         const std::string & compressor="blosc",
         const std::string & codec="lz4",
         const int compressorLevel=5,
-        const int compressorShuffle=1
+        const int compressorShuffle=1,
+        const int compressorBlocksize=0,
+        const double compressorTolerance=-1,
+        const double compressorRate=-1,
+        const int compressorPrecision=-1
     ) {
         auto path = group.path();
         path /= key;
         return createDataset(path.string(),
             dtype, shape, chunkShape,
             createAsZarr, fillValue, compressor,
-            codec, compressorLevel, compressorShuffle
+            codec, compressorLevel, compressorShuffle,
+            compressorBlocksize, compressorTolerance,
+            compressorRate, compressorPrecision
         );
     }
 
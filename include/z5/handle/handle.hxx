@@ -90,12 +90,12 @@ namespace handle {
 
     public:
 
-        Chunk(const Dataset & handle, const types::ShapeType & chunkIndices, const bool zarrFormat)
+        Chunk(const Dataset & handle, const types::CoordinateType & chunkIndices, const bool zarrFormat)
             : Handle(pathFromDatasetAndIndices(handle, chunkIndices, zarrFormat)), chunkIndices_(chunkIndices), zarrFormat_(zarrFormat){
 
         }
 
-        inline const types::ShapeType & chunkIndices() const {
+        inline const types::CoordinateType & chunkIndices() const {
             return chunkIndices_;
         }
 
@@ -104,9 +104,9 @@ namespace handle {
         }
 
         // compute the chunk shape, clipped if overhanging the boundary
-        template<typename T> // need to template this to work with arbitrary index out vectors
+        template<typename SHAPE> // need to template this to work with arbitrary index out vectors
         inline void boundedChunkShape(
-            const types::ShapeType & shape, const types::ShapeType & chunkShape, std::vector<T> & shapeOut
+            const types::ShapeType & shape, const types::ShapeType & chunkShape, SHAPE & shapeOut
         ) const {
             int nDim = shape.size();
             // we trust that all other dimensions are correct
@@ -139,7 +139,7 @@ namespace handle {
         // chunk indices and flag for the format
         static fs::path pathFromDatasetAndIndices(
             const Dataset & handle,
-            const types::ShapeType & chunkIndices,
+            const types::CoordinateType & chunkIndices,
             const bool zarrFormat
         ) {
             fs::path ret(handle.path());
@@ -164,7 +164,7 @@ namespace handle {
         }
 
 
-        types::ShapeType chunkIndices_;
+        types::CoordinateType chunkIndices_;
         bool zarrFormat_;
     };
 
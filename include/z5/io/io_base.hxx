@@ -1,6 +1,7 @@
 #pragma once
 
 #include "z5/handle/handle.hxx"
+#include "z5/io/mapped_chunk.hxx"
 
 namespace z5 {
 namespace io {
@@ -10,9 +11,18 @@ namespace io {
 
     public:
         virtual bool read(const handle::Chunk &, std::vector<T> &) const = 0;
-        virtual void write(const handle::Chunk &, const std::vector<T> &) const = 0;
+        // memory map the chunk file instead of reading it into a vector
+        virtual bool read(const handle::Chunk &, MappedChunk &) const = 0;
+        // write the (compressed) bytes of the chunk
+        virtual void write(const handle::Chunk &, const char *, size_t) const = 0;
         virtual void getChunkShape(const handle::Chunk &, types::ShapeType &) const = 0;
+        virtual void getChunkShape(const handle::Chunk &, types::CoordinateType &) const = 0;
         virtual size_t getChunkSize(const handle::Chunk &) const = 0;
+
+        // convenience function
+        inline void write(const handle::Chunk & chunk, const std::vector<T> & data) const {
+            write(chunk, (const char *) &data[0], data.size() * sizeof(T));
+        }
     };
 
 
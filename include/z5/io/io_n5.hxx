@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstring>
 #include <ios>
 
 #ifndef BOOST_FILESYSTEM_NO_DEPERECATED
@@ -9,6 +10,7 @@
 #include <boost/filesystem/fstream.hpp>
 
 #include "z5/io/io_base.hxx"
+#include "z5/util/trace.hxx"
 #include "z5/types/types.hxx"
 #include "z5/util/util.hxx"
 
@@ -34,70 +36,102 @@ namespace io {
 
         inline bool read(const handle::Chunk & chunk, std::vector<T> & data) const {
 
-            // if the chunk exists, we read it
-            if(chunk.exists()) {
-
-                // this might speed up the I/O by decoupling C++ buffers from C buffers
-                std::ios_base::sync_with_stdio(false);
-                // open input stream and read the header
-                fs::ifstream file(chunk.path(), std::ios::binary);
-                types::ShapeType chunkShape;
-                size_t fileSize = readHeader(file, chunkShape);
+            // open input stream, if this fails the chunk does not exist
+            // (we don't check for existence first to save a stat call)
+            util::TraceScope traceOpen("open", chunk.chunkIndices());
+            fs::ifstream file(chunk.path(), std::ios::binary);
+            traceOpen.stop();
+            if(!file.is_open()) {
+                return false;
+            }
+            util::TraceScope traceRead("read", chunk.chunkIndices());
+
+            // read the header and check it against the expected chunk shape
+            types::CoordinateType chunkShape;
+            readHeader(file, chunkShape);
+            checkChunkShape(chunk, chunkShape);
+
+            // the compressed data reaches to the end of the file, it can be
+            // larger than the uncompressed chunk (e.g. for random data)
+            const std::streampos dataBegin = file.tellg();
+            file.seekg(0, std::ios::end);
+            const size_t dataSize = file.tellg() - dataBegin;
+            file.seekg(dataBegin);
+
+            // resize the data vector
+            size_t vectorSize = dataSize / sizeof(T) + (dataSize % sizeof(T) == 0 ? 0 : 1);
+            data.resize(vectorSize);
+
+            // read the file
+            file.read((char*) data.data(), dataSize);
+            file.close();
 
-                // resize the data vector
-                size_t vectorSize = fileSize / sizeof(T) + (fileSize % sizeof(T) == 0 ? 0 : sizeof(T));
-                data.resize(vectorSize);
+            // return true, because we have read an existing chunk
+            return true;
+        }
 
-                // read the file
-                file.read((char*) &data[0], fileSize);
-                file.close();
 
-                // return true, because we have read an existing chunk
-                return true;
+        inline bool read(const handle::Chunk & chunk, MappedChunk & data) const {
 
-            } else {
+            // if the chunk exists, we map it and parse the header in place
+            util::TraceScope traceOpen("open", chunk.chunkIndices());
+            if(!data.map(chunk.path())) {
                 return false;
             }
-
+            traceOpen.stop();
+            types::CoordinateType chunkShape;
+            data.skip(readHeader(data.data(), data.size(), chunkShape));
+            checkChunkShape(chunk, chunkShape);
+            return true;
         }
 
 
-        inline void write(const handle::Chunk & chunk, const std::vector<T> & data) const {
+        // bring the vector overload of the base class into scope
+        using ChunkIoBase<T>::write;
+
+        inline void write(const handle::Chunk & chunk, const char * data, size_t nBytes) const {
+            util::TraceScope traceWrite("write", chunk.chunkIndices());
             // create the parent folder
             chunk.createTopDir();
-            // this might speed up the I/O by decoupling C++ buffers from C buffers
-            std::ios_base::sync_with_stdio(false);
             fs::ofstream file(chunk.path(), std::ios::binary);
             // write the header
             writeHeader(chunk, file);
-            file.write((char*) &data[0], data.size() * sizeof(T));
+            file.write(data, nBytes);
             file.close();
         }
 
 
+        // the chunk shape is determined by the dataset geometry, so we don't need
+        // to read the header here (it is checked when the chunk is read)
         inline void getChunkShape(const handle::Chunk & chunk, types::ShapeType & shape) const {
-            if(chunk.exists()) {
-                std::ios_base::sync_with_stdio(false);
-                fs::ifstream file(chunk.path(), std::ios::binary);
-                readHeader(file, shape);
-                file.close();
-            }
-            else {
-                chunk.boundedChunkShape(shape_, chunkShape_, shape);
-            }
+            chunk.boundedChunkShape(shape_, chunkShape_, shape);
+        }
+
+        inline void getChunkShape(const handle::Chunk & chunk, types::CoordinateType & shape) const {
+            chunk.boundedChunkShape(shape_, chunkShape_, shape);
         }
 
 
         inline size_t getChunkSize(const handle::Chunk & chunk) const {
-            types::ShapeType shape;
+            types::CoordinateType shape;
             getChunkShape(chunk, shape);
             return std::accumulate(shape.begin(), shape.end(), 1, std::multiplies<size_t>());
         }
 
     private:
 
+        // check the shape read from the chunk header against the
+        // shape expected from the dataset geometry
+        inline void checkChunkShape(const handle::Chunk & chunk, const types::CoordinateType & headerShape) const {
+            types::CoordinateType expectedShape;
+            chunk.boundedChunkShape(shape_, chunkShape_, expectedShape);
+            if(headerShape != expectedShape) {
+                throw std::runtime_error("Shape in N5 chunk header does not match the expected chunk shape");
+            }
+        }
+
         // TODO allow for reading the mode
-        size_t readHeader(fs::ifstream & file, types::ShapeType & shape) const {
+        void readHeader(fs::ifstream & file, types::CoordinateType & shape) const {
             // read the mode
             uint16_t mode;
             file.read((char *) &mode, 2);
@@ -114,7 +148,7 @@ namespace io {
 
             // TODO need to invert the dimensions here
             // read tempory shape with uint32 entries
-            std::vector<uint32_t> shapeTmp(nDims);
+            util::SmallVector<uint32_t, 8> shapeTmp(nDims);
             for(int d = 0; d < nDims; ++d) {
                 file.read((char *) &shapeTmp[d], 4);
             }
@@ -125,10 +159,42 @@ namespace io {
             std::copy(shapeTmp.begin(), shapeTmp.end(), shape.begin());
 
             // TODO need to read the actual size if we allow for varlength mode
+        }
+
+        // parse the header from the mapped file and return the header size in bytes
+        size_t readHeader(const char * bytes, const size_t nBytes, types::CoordinateType & shape) const {
+            if(nBytes < 4) {
+                throw std::runtime_error("N5 chunk is too small to contain a header");
+            }
 
-            // calculate the file size
-            size_t fileSize = std::accumulate(shape.begin(), shape.end(), 1, std::multiplies<size_t>());
-            return fileSize * sizeof(T);
+            // read the mode
+            uint16_t mode;
+            std::memcpy(&mode, bytes, 2);
+            util::reverseEndiannessInplace(mode);
+            // TODO support varlength mode
+            if(mode != 0) {
+                throw std::runtime_error("Zarr++ only supports reading N5 chunks in default mode");
+            }
+
+            // read the number of dimensions
+            uint16_t nDims;
+            std::memcpy(&nDims, bytes + 2, 2);
+            util::reverseEndiannessInplace(nDims);
+
+            const size_t headerSize = 4 + 4 * nDims;
+            if(nBytes < headerSize) {
+                throw std::runtime_error("N5 chunk is too small to contain a header");
+            }
+
+            // read the shape with uint32 entries
+            shape.resize(nDims);
+            uint32_t shapeTmp;
+            for(int d = 0; d < nDims; ++d) {
+                std::memcpy(&shapeTmp, bytes + 4 + 4 * d, 4);
+                util::reverseEndiannessInplace(shapeTmp);
+                shape[d] = shapeTmp;
+            }
+            return headerSize;
         }
 
         void writeHeader(const handle::Chunk & chunk, fs::ofstream & file) const {
@@ -144,7 +210,7 @@ namespace io {
 
             // TODO need to invert the dimensions here
             // get the bounded chunk shape and write it to file
-            std::vector<uint32_t> shapeOut(shape_.size());
+            util::SmallVector<uint32_t, 8> shapeOut(shape_.size());
             chunk.boundedChunkShape(shape_, chunkShape_, shapeOut);
             util::reverseEndiannessInplace<uint32_t>(shapeOut.begin(), shapeOut.end());
             for(int d = 0; d < shape_.size(); ++d) {
@@ -9,6 +9,7 @@
 #include <boost/filesystem/fstream.hpp>
 
 #include "z5/io/io_base.hxx"
+#include "z5/util/trace.hxx"
 
 namespace fs = boost::filesystem;
 
@@ -25,45 +26,51 @@ namespace io {
 
         inline bool read(const handle::Chunk & chunk, std::vector<T> & data) const {
 
-            // if the chunk exists, we read it
-            if(chunk.exists()) {
-                
+            // open input stream, if this fails the chunk does not exist
+            // (we don't check for existence first to save a stat call)
+            util::TraceScope traceOpen("open", chunk.chunkIndices());
+            fs::ifstream file(chunk.path(), std::ios::binary);
+            traceOpen.stop();
+            if(!file.is_open()) {
+                return false;
+            }
+            util::TraceScope traceRead("read", chunk.chunkIndices());
 
-                // this might speed up the I/O by decoupling C++ buffers from C buffers
-                std::ios_base::sync_with_stdio(false);
-                // open input stream and read the filesize
-                fs::ifstream file(chunk.path(), std::ios::binary);
-                file.seekg(0, std::ios::end);
-                size_t fileSize = file.tellg();
-                file.seekg(0, std::ios::beg);
-                
+            // read the filesize
+            file.seekg(0, std::ios::end);
+            size_t fileSize = file.tellg();
+            file.seekg(0, std::ios::beg);
 
-                // resize the data vector
-                size_t vectorSize = fileSize / sizeof(T) + (fileSize % sizeof(T) == 0 ? 0 : sizeof(T));
-                data.resize(vectorSize);
+            // resize the data vector
+            size_t vectorSize = fileSize / sizeof(T) + (fileSize % sizeof(T) == 0 ? 0 : 1);
+            data.resize(vectorSize);
 
-                // read the file
-                file.read((char*) &data[0], fileSize);
-                file.close();
+            // read the file
+            file.read((char*) &data[0], fileSize);
+            file.close();
 
-                // return true, because we have read an existing chunk
-                return true;
+            // return true, because we have read an existing chunk
+            return true;
+        }
 
-            } else {
-                // return false, because the chunk does not exist
-                return false;
-            }
+        inline bool read(const handle::Chunk & chunk, MappedChunk & data) const {
+            // if the chunk exists, we map it
+            util::TraceScope traceOpen("open", chunk.chunkIndices());
+            return data.map(chunk.path());
         }
 
-        inline void write(const handle::Chunk & chunk, const std::vector<T> & data) const {
-            // this might speed up the I/O by decoupling C++ buffers from C buffers
-            std::ios_base::sync_with_stdio(false);
+        // bring the vector overload of the base class into scope
+        using ChunkIoBase<T>::write;
+
+        inline void write(const handle::Chunk & chunk, const char * data, size_t nBytes) const {
+            util::TraceScope traceWrite("write", chunk.chunkIndices());
             fs::ofstream file(chunk.path(), std::ios::binary);
-            file.write((char*) &data[0], data.size() * sizeof(T));
+            file.write(data, nBytes);
             file.close();
         }
 
         inline void getChunkShape(const handle::Chunk &, types::ShapeType &) const {}
+        inline void getChunkShape(const handle::Chunk &, types::CoordinateType &) const {}
         inline size_t getChunkSize(const handle::Chunk &) const {}
 
     };
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <stdexcept>
+
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#ifndef BOOST_FILESYSTEM_NO_DEPERECATED
+#define BOOST_FILESYSTEM_NO_DEPERECATED
+#endif
+#include <boost/filesystem.hpp>
+
+namespace fs = boost::filesystem;
+
+namespace z5 {
+namespace io {
+
+    // read-only memory mapping of a chunk file
+    // the (compressed) chunk data is exposed as a non-owning byte span,
+    // that starts after an optional header (used for N5)
+    // NOTE the mapping is only valid as long as the file is not truncated
+    // or removed by somebody else while it is mapped
+    class MappedChunk {
+
+    public:
+        MappedChunk() : data_(nullptr), size_(0), isMapped_(false) {
+        }
+
+        // map the file at path and return false if it does not exist,
+        // empty files are mapped to an empty span (without a memory mapping)
+        // NOTE we open the file directly, so that reading a chunk does not need an additional stat
+        inline bool map(const fs::path & path) {
+            unmap();
+            boost::interprocess::file_mapping mapping;
+            try {
+                boost::interprocess::file_mapping tmp(path.string().c_str(), boost::interprocess::read_only);
+                mapping.swap(tmp);
+            } catch(const boost::interprocess::interprocess_exception & e) {
+                if(e.get_error_code() == boost::interprocess::not_found_error) {
+                    return false;
+                }
+                throw;
+            }
+            isMapped_ = true;
+
+            // the size is read from the open file, a region can't be mapped for an empty file
+            boost::interprocess::offset_t fileSize;
+            if(!boost::interprocess::ipcdetail::get_file_size(mapping.get_mapping_handle().handle, fileSize)) {
+                throw std::runtime_error("Could not read the size of the chunk file " + path.string());
+            }
+            if(fileSize == 0) {
+                return true;
+            }
+            boost::interprocess::mapped_region region(mapping, boost::interprocess::read_only);
+            region_.swap(region);
+            // we read the chunk once and sequentially
+            region_.advise(boost::interprocess::mapped_region::advice_sequential);
+            data_ = static_cast<const char *>(region_.get_address());
+            size_ = region_.get_size();
+            return true;
+        }
+
+        inline void unmap() {
+            boost::interprocess::mapped_region region;
+            region_.swap(region);
+            data_ = nullptr;
+            size_ = 0;
+            isMapped_ = false;
+        }
+
+        // ask the kernel to read the mapped file in the background
+        // (used to read chunks ahead of decoding them)
+        inline void willNeed() {
+            if(data_) {
+                region_.advise(boost::interprocess::mapped_region::advice_willneed);
+            }
+        }
+
+        // skip the first nBytes (i.e. the header) of the span
+        inline void skip(const size_t nBytes) {
+            if(nBytes > size_) {
+                throw std::runtime_error("Mapped chunk is smaller than its header");
+            }
+            data_ += nBytes;
+            size_ -= nBytes;
+        }
+
+        // the span is only valid if the file was mapped (data is null for empty files)
+        inline bool isMapped() const {return isMapped_;}
+        inline const char * data() const {return data_;}
+        inline size_t size() const {return size_;}
+
+        // delete copy constructor and assignment operator
+        MappedChunk(const MappedChunk &) = delete;
+        MappedChunk & operator=(const MappedChunk &) = delete;
+
+    private:
+        boost::interprocess::mapped_region region_;
+        const char * data_;
+        size_t size_;
+        bool isMapped_;
+    };
+
+}
+}
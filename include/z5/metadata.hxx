@@ -35,7 +35,8 @@ namespace z5 {
             const types::Compressor compressor=types::blosc,
             const std::string & codec="lz4",
             const int compressorLevel=5,
-            const int compressorShuffle=1
+            const int compressorShuffle=1,
+            const int compressorBlocksize=0
             ) : dtype(dtype),
                 shape(shape),
                 chunkShape(chunkShape),
@@ -44,7 +45,8 @@ namespace z5 {
                 compressor(compressor),
                 codec(codec),
                 compressorLevel(compressorLevel),
-                compressorShuffle(compressorShuffle)
+                compressorShuffle(compressorShuffle),
+                compressorBlocksize(compressorBlocksize)
         {
             checkShapes();
         }
@@ -77,13 +79,41 @@ namespace z5 {
 
             nlohmann::json compressionOpts;
             try {
-                compressionOpts["id"] = (compressor == types::raw) ? nullptr : types::compressorToZarr.at(compressor);
+                // uncompressed arrays have a null id
+                if(compressor == types::raw) {
+                    compressionOpts["id"] = nullptr;
+                } else {
+                    compressionOpts["id"] = types::compressorToZarr.at(compressor);
+                }
             } catch(std::out_of_range) {
                 throw std::runtime_error("z5.DatasetMetadata.toJsonZarr: wrong compressor for zarr format");
             }
-            compressionOpts["cname"] = codec;
-            compressionOpts["clevel"] = compressorLevel;
-            compressionOpts["shuffle"] = compressorShuffle;
+            if(compressor == types::compressedSegmentation) {
+                compressionOpts["block_size"] = compressorBlockShape;
+            }
+            #ifdef WITH_ZSTD
+            // zstd options in the numcodecs format
+            else if(compressor == types::zstd) {
+                compressionOpts["level"] = compressorLevel;
+                if(compressorLongDistanceMatching) {
+                    compressionOpts["long_distance_matching"] = true;
+                }
+            }
+            #endif
+            #ifdef WITH_ZFP
+            // zfp options in the numcodecs zfpy format
+            else if(compressor == types::zfp) {
+                zfpToJson(compressionOpts);
+            }
+            #endif
+            else {
+                compressionOpts["cname"] = codec;
+                compressionOpts["clevel"] = compressorLevel;
+                compressionOpts["shuffle"] = compressorShuffle;
+                if(compressor == types::blosc) {
+                    compressionOpts["blocksize"] = compressorBlocksize;
+                }
+            }
             j["compressor"] = compressionOpts;
 
             j["dtype"] = types::dtypeToZarr.at(dtype);
@@ -111,6 +141,35 @@ namespace z5 {
             } catch(std::out_of_range) {
                 throw std::runtime_error("z5.DatasetMetadata.toJsonN5: wrong compressor for N5 format");
             }
+
+            if(compressor == types::compressedSegmentation) {
+                nlohmann::json compressionOpts;
+                compressionOpts["type"] = "compressed_segmentation";
+                compressionOpts["blockSize"] = compressorBlockShape;
+                j["compression"] = compressionOpts;
+            }
+
+            #ifdef WITH_ZSTD
+            // zstd options in the format of the n5-zstandard compression
+            if(compressor == types::zstd) {
+                nlohmann::json compressionOpts;
+                compressionOpts["type"] = "zstd";
+                compressionOpts["level"] = compressorLevel;
+                if(compressorLongDistanceMatching) {
+                    compressionOpts["longDistanceMatching"] = true;
+                }
+                j["compression"] = compressionOpts;
+            }
+            #endif
+
+            #ifdef WITH_ZFP
+            if(compressor == types::zfp) {
+                nlohmann::json compressionOpts;
+                compressionOpts["type"] = "zfp";
+                zfpToJson(compressionOpts);
+                j["compression"] = compressionOpts;
+            }
+            #endif
         }
 
 
@@ -129,9 +188,39 @@ namespace z5 {
                 throw std::runtime_error("z5.DatasetMetadata.fromJsonZarr: wrong compressor for zarr format");
             }
 
+            if(compressor == types::compressedSegmentation) {
+                codec = "compressed_segmentation";
+                auto blockIt = compressionOpts.find("block_size");
+                if(blockIt != compressionOpts.end()) {
+                    compressorBlockShape = types::ShapeType(blockIt->begin(), blockIt->end());
+                }
+                return;
+            }
+
+            #ifdef WITH_ZSTD
+            if(compressor == types::zstd) {
+                codec = "zstd";
+                compressorLevel = compressionOpts["level"];
+                auto ldmIt = compressionOpts.find("long_distance_matching");
+                compressorLongDistanceMatching = ldmIt != compressionOpts.end() && ldmIt->get<bool>();
+                return;
+            }
+            #endif
+
+            #ifdef WITH_ZFP
+            if(compressor == types::zfp) {
+                codec = "zfp";
+                zfpFromJson(compressionOpts);
+                return;
+            }
+            #endif
+
             codec    = compressionOpts["cname"];
             compressorLevel   = compressionOpts["clevel"];
             compressorShuffle = compressionOpts["shuffle"];
+            // the blocksize is optional
+            auto blockIt = compressionOpts.find("blocksize");
+            compressorBlocksize = (blockIt != compressionOpts.end() && !blockIt->is_null()) ? blockIt->get<int>() : 0;
         }
 
 
@@ -153,8 +242,71 @@ namespace z5 {
             codec = (compressor == types::zlib) ? "gzip" : "";
             compressorLevel = 5; // TODO is this correcy ?
             fillValue = 0; // TODO is this correct ?
+
+            if(compressor == types::compressedSegmentation) {
+                codec = "compressed_segmentation";
+                auto optsIt = j.find("compression");
+                if(optsIt != j.end()) {
+                    auto blockIt = optsIt->find("blockSize");
+                    if(blockIt != optsIt->end()) {
+                        compressorBlockShape = types::ShapeType(blockIt->begin(), blockIt->end());
+                    }
+                }
+            }
+
+            #ifdef WITH_ZSTD
+            if(compressor == types::zstd) {
+                codec = "zstd";
+                compressorLevel = 3; // default level of zstd
+                auto optsIt = j.find("compression");
+                if(optsIt != j.end()) {
+                    auto levelIt = optsIt->find("level");
+                    if(levelIt != optsIt->end()) {
+                        compressorLevel = *levelIt;
+                    }
+                    auto ldmIt = optsIt->find("longDistanceMatching");
+                    compressorLongDistanceMatching = ldmIt != optsIt->end() && ldmIt->get<bool>();
+                }
+            }
+            #endif
+
+            #ifdef WITH_ZFP
+            if(compressor == types::zfp) {
+                codec = "zfp";
+                auto optsIt = j.find("compression");
+                if(optsIt != j.end()) {
+                    zfpFromJson(*optsIt);
+                }
+            }
+            #endif
+        }
+
+        #ifdef WITH_ZFP
+        void zfpToJson(nlohmann::json & compressionOpts) const {
+            compressionOpts["mode"] = zfpMode();
+            compressionOpts["tolerance"] = compressorTolerance;
+            compressionOpts["rate"] = compressorRate;
+            compressionOpts["precision"] = compressorPrecision;
         }
 
+        void zfpFromJson(const nlohmann::json & compressionOpts) {
+            auto readOpt = [&compressionOpts](const std::string & key) {
+                auto it = compressionOpts.find(key);
+                return (it != compressionOpts.end() && !it->is_null()) ? it->get<double>() : -1.;
+            };
+            compressorTolerance = readOpt("tolerance");
+            compressorRate = readOpt("rate");
+            compressorPrecision = static_cast<int>(readOpt("precision"));
+            // only keep the parameter of the mode, if it is given
+            const int mode = static_cast<int>(readOpt("mode"));
+            if(mode > 0) {
+                compressorTolerance = (mode == 4) ? compressorTolerance : -1;
+                compressorRate = (mode == 2) ? compressorRate : -1;
+                compressorPrecision = (mode == 3) ? compressorPrecision : -1;
+            }
+        }
+        #endif
+
     public:
         // metadata values that can be set
         types::Datatype dtype;
@@ -169,7 +321,23 @@ namespace z5 {
         int compressorLevel;
         types::Compressor compressor;
         std::string codec;
+        // for blosc: 0 -> no shuffle, 1 -> byte shuffle, 2 -> bit shuffle
         int compressorShuffle;
+        // for blosc: 0 -> automatic blocksize
+        int compressorBlocksize = 0;
+        // for zstd: use long distance matching
+        bool compressorLongDistanceMatching = false;
+        // for compressed segmentation: shape of the blocks that get a label table,
+        // for the last (up to) three axes in the axis order of the chunk shape
+        types::ShapeType compressorBlockShape = types::ShapeType({8, 8, 8});
+        // for zfp: parameter of the fixed accuracy, rate or precision mode (-1 if not used);
+        // if none is set, the lossless reversible mode is used
+        double compressorTolerance = -1;
+        double compressorRate = -1;
+        int compressorPrecision = -1;
+        // number of threads the compressor may use internally
+        // (runtime option, this is not stored in the metadata file)
+        int compressorThreads = 1;
         bool isZarr; // flag to specify whether we have a zarr or n5 array
 
         // metadata values that are fixed for now
@@ -177,6 +345,19 @@ namespace z5 {
         const std::string order = "C";
         const std::nullptr_t filters = nullptr;
 
+        // zfp mode for the parameters, with the values of zfp_mode:
+        // 2 -> fixed rate, 3 -> fixed precision, 4 -> fixed accuracy, 5 -> reversible
+        int zfpMode() const {
+            if(compressorTolerance >= 0) {
+                return 4;
+            } else if(compressorRate > 0) {
+                return 2;
+            } else if(compressorPrecision > 0) {
+                return 3;
+            }
+            return 5;
+        }
+
     private:
 
         // make sure that shapes agree
@@ -0,0 +1,279 @@
+#pragma once
+
+#include <algorithm>
+#include <functional>
+#include <list>
+#include <map>
+#include <numeric>
+
+#include "z5/dataset.hxx"
+#include "z5/types/types.hxx"
+#include "z5/multiarray/marray_access.hxx"
+#include "andres/marray.hxx"
+
+namespace z5 {
+namespace multiarray {
+
+    // write-back buffer for subarray writes:
+    // partially written chunks are kept in memory until they are complete,
+    // so that every chunk is only compressed and written once, instead of
+    // being read, updated and rewritten for every request that touches it.
+    // incomplete chunks are merged with the data on disk and written when
+    // flush() is called, when the writer is destroyed or when they need to be
+    // evicted (least recently written first) because the memory cap is exceeded;
+    // the cap is enforced for every chunk of a request, so the buffer only grows
+    // beyond it if a single chunk is larger than the cap.
+    // NOTE the writer is not thread-safe and data that is still buffered
+    // is not visible to reads from the dataset
+    template<typename T>
+    class BufferedWriter {
+
+    public:
+
+        BufferedWriter(const Dataset & ds, const size_t maxBytes) : ds_(ds), maxBytes_(maxBytes), currentBytes_(0), peakBytes_(0) {
+            ds_.checkRequestType(typeid(T));
+        }
+
+        // destructors must not throw, call flush() explicitly
+        // if you need to handle write errors
+        ~BufferedWriter() {
+            try {
+                flush();
+            } catch(...) {}
+        }
+
+        template<typename ITER>
+        void write(const andres::View<T> & in, ITER roiBeginIter) {
+
+            // get the offset and shape of the request and check if it is valid
+            types::CoordinateType offset(roiBeginIter, roiBeginIter+in.dimension());
+            types::CoordinateType shape(in.shapeBegin(), in.shapeEnd());
+            ds_.checkRequestShape(offset, shape);
+
+            // get the chunks that are involved in this request
+            util::ChunkRange chunkRange;
+            ds_.getChunkRange(offset, shape, chunkRange);
+
+            types::CoordinateType localOffset, localShape, inChunkOffset;
+            for(const auto & chunkId : chunkRange) {
+
+                bool completeOvlp = ds_.getCoordinatesInRequest(
+                    chunkId, offset, shape, localOffset, localShape, inChunkOffset
+                );
+                auto view = in.constView(localOffset.begin(), localShape.begin());
+
+                // the chunk is completely covered -> we can write it right away
+                // and drop everything that was buffered for it
+                if(completeOvlp) {
+                    erase(chunkId);
+                    if(access_detail::isContiguous(view)) {
+                        ds_.writeChunk(chunkId, &view(0));
+                        continue;
+                    }
+                    ds_.getChunkShape(chunkId, chunkShape_);
+                    if(bufferShape_ != chunkShape_) {
+                        buffer_.resize(andres::SkipInitialization, chunkShape_.begin(), chunkShape_.end());
+                        bufferShape_ = chunkShape_;
+                    }
+                    access_detail::copyView(view, buffer_);
+                    ds_.writeChunk(chunkId, &buffer_(0));
+                    continue;
+                }
+
+                // otherwise copy the data to the buffered chunk and write it
+                // once it is complete
+                auto & entry = getEntry(chunkId);
+                auto bufView = entry.data.view(inChunkOffset.begin(), localShape.begin());
+                access_detail::copyView(view, bufView);
+                markWritten(entry, inChunkOffset, localShape);
+
+                if(entry.nWritten == entry.mask.size()) {
+                    ds_.writeChunk(chunkId, &entry.data(0));
+                    erase(chunkId);
+                }
+            }
+
+            // evict the last chunk if it is larger than the memory cap on its own
+            while(currentBytes_ > maxBytes_ && !lru_.empty()) {
+                writeBack(lru_.back());
+            }
+        }
+
+        // write all buffered chunks to disc
+        void flush() {
+            while(!lru_.empty()) {
+                writeBack(lru_.back());
+            }
+        }
+
+        inline size_t currentBytes() const {return currentBytes_;}
+        inline size_t maxBytes() const {return maxBytes_;}
+        // the maximal number of bytes that were buffered at once
+        inline size_t peakBytes() const {return peakBytes_;}
+        inline size_t numberOfBufferedChunks() const {return entries_.size();}
+
+        // delete copy constructor and assignment operator
+        BufferedWriter(const BufferedWriter &) = delete;
+        BufferedWriter & operator=(const BufferedWriter &) = delete;
+
+    private:
+
+        struct ChunkEntry {
+            andres::Marray<T> data;
+            // which values of the chunk have been written already
+            std::vector<bool> mask;
+            size_t nWritten;
+            std::list<types::CoordinateType>::iterator lruPosition;
+        };
+
+        inline size_t entryBytes(const size_t chunkSize) const {
+            return chunkSize * sizeof(T) + chunkSize / 8;
+        }
+
+        inline size_t entryBytes(const ChunkEntry & entry) const {
+            return entryBytes(entry.mask.size());
+        }
+
+        // get the entry for this chunk and make it the most recently used one
+        ChunkEntry & getEntry(const types::CoordinateType & chunkId) {
+            auto it = entries_.find(chunkId);
+            if(it != entries_.end()) {
+                lru_.splice(lru_.begin(), lru_, it->second.lruPosition);
+                return it->second;
+            }
+
+            // make room for the new chunk before we allocate it, evicting the
+            // least recently written chunks if it would exceed the memory cap
+            ds_.getChunkShape(chunkId, chunkShape_);
+            const size_t nBytes = entryBytes(std::accumulate(chunkShape_.begin(), chunkShape_.end(),
+                                                             size_t(1), std::multiplies<size_t>()));
+            while(currentBytes_ + nBytes > maxBytes_ && !lru_.empty()) {
+                writeBack(lru_.back());
+            }
+
+            auto & entry = entries_[chunkId];
+            entry.data.resize(andres::SkipInitialization, chunkShape_.begin(), chunkShape_.end());
+            entry.mask.assign(entry.data.size(), false);
+            entry.nWritten = 0;
+            markOutOfBounds(chunkId, entry);
+            lru_.push_front(chunkId);
+            entry.lruPosition = lru_.begin();
+            currentBytes_ += nBytes;
+            peakBytes_ = std::max(peakBytes_, currentBytes_);
+            return entry;
+        }
+
+        // zarr edge chunks have the full chunk shape, but the part outside of the
+        // dataset is never written, so we mark it as written already (and zero it,
+        // so that we don't write uninitialized memory), otherwise edge chunks
+        // would never be complete
+        void markOutOfBounds(const types::CoordinateType & chunkId, ChunkEntry & entry) {
+            if(!ds_.isZarr()) {
+                return;
+            }
+            const int nDim = chunkShape_.size();
+            types::CoordinateType inBoundsShape(nDim);
+            bool isEdgeChunk = false;
+            for(int d = 0; d < nDim; ++d) {
+                const size_t chunkBegin = chunkId[d] * ds_.maxChunkShape(d);
+                inBoundsShape[d] = std::min(chunkShape_[d], ds_.shape(d) - chunkBegin);
+                isEdgeChunk = isEdgeChunk || inBoundsShape[d] < chunkShape_[d];
+            }
+            if(!isEdgeChunk) {
+                return;
+            }
+            std::fill(&entry.data(0), &entry.data(0) + entry.data.size(), T());
+            entry.mask.assign(entry.mask.size(), true);
+            entry.nWritten = entry.mask.size();
+            markWritten(entry, types::CoordinateType(nDim, 0), inBoundsShape, false);
+        }
+
+        // mark the region [inChunkOffset, inChunkOffset + localShape) of the chunk as written
+        // (or as not written if written is false)
+        void markWritten(ChunkEntry & entry, const types::CoordinateType & inChunkOffset,
+                         const types::CoordinateType & localShape, const bool written=true) {
+            const int nDim = localShape.size();
+
+            // iterate over the region in C order, the innermost axis is handled by the inner loop
+            types::CoordinateType coord(nDim, 0);
+            const size_t innerLen = localShape[nDim - 1];
+            while(true) {
+                size_t linearIndex = 0;
+                for(int d = 0; d < nDim; ++d) {
+                    linearIndex = linearIndex * entry.data.shape(d) + inChunkOffset[d] + coord[d];
+                }
+                for(size_t i = 0; i < innerLen; ++i, ++linearIndex) {
+                    if(entry.mask[linearIndex] != written) {
+                        entry.mask[linearIndex] = written;
+                        if(written) {
+                            ++entry.nWritten;
+                        } else {
+                            --entry.nWritten;
+                        }
+                    }
+                }
+
+                // go to the next row
+                int d = nDim - 2;
+                for(; d >= 0; --d) {
+                    if(++coord[d] < localShape[d]) {
+                        break;
+                    }
+                    coord[d] = 0;
+                }
+                if(d < 0) {
+                    break;
+                }
+            }
+        }
+
+        // merge the buffered chunk with the data on disc, write it and remove it from the buffer
+        // (the chunk id is passed by value, because the callers pass references into lru_)
+        void writeBack(const types::CoordinateType chunkId) {
+            auto & entry = entries_.at(chunkId);
+            auto & data = entry.data;
+            if(entry.nWritten < entry.mask.size()) {
+                if(bufferShape_.size() != data.dimension() ||
+                   !std::equal(bufferShape_.begin(), bufferShape_.end(), data.shapeBegin())) {
+                    buffer_.resize(andres::SkipInitialization, data.shapeBegin(), data.shapeEnd());
+                    bufferShape_.assign(data.shapeBegin(), data.shapeEnd());
+                }
+                ds_.readChunkForUpdate(chunkId, &buffer_(0));
+                T * dataPtr = &data(0);
+                const T * existingPtr = &buffer_(0);
+                for(size_t i = 0; i < entry.mask.size(); ++i) {
+                    if(!entry.mask[i]) {
+                        dataPtr[i] = existingPtr[i];
+                    }
+                }
+            }
+            ds_.writeChunk(chunkId, &data(0));
+            erase(chunkId);
+        }
+
+        void erase(const types::CoordinateType & chunkId) {
+            auto it = entries_.find(chunkId);
+            if(it != entries_.end()) {
+                currentBytes_ -= entryBytes(it->second);
+                lru_.erase(it->second.lruPosition);
+                entries_.erase(it);
+            }
+        }
+
+        const Dataset & ds_;
+        size_t maxBytes_;
+        size_t currentBytes_;
+        size_t peakBytes_;
+
+        // the buffered chunks and their order of use (most recently used first)
+        std::map<types::CoordinateType, ChunkEntry> entries_;
+        std::list<types::CoordinateType> lru_;
+
+        // buffer for complete chunks and for merging with existing data
+        andres::Marray<T> buffer_;
+        types::CoordinateType bufferShape_;
+        types::CoordinateType chunkShape_;
+    };
+
+}
+}
@@ -0,0 +1,204 @@
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "z5/dataset.hxx"
+#include "z5/util/chunk_range.hxx"
+
+namespace z5 {
+namespace multiarray {
+
+    // reads the chunks of a request ahead of decoding them, so that the I/O
+    // (which dominates on network file systems with a high latency per file)
+    // overlaps with decompressing and copying the chunks that were read before:
+    // the compressed chunks are read by the prefetch threads and handed out by next()
+    // in the order they were read, until all chunks of the range were handed out.
+    // the chunks that are read ahead are bounded by maxBytes of compressed data
+    // (which can be exceeded by at most one chunk per prefetch thread) and
+    // by queueDepthPerThread chunks per prefetch thread and consumer
+    template<typename T>
+    class ChunkPrefetcher {
+
+    public:
+        typedef FetchedChunk<T> FetchedType;
+        static const size_t queueDepthPerThread = 4;
+
+        // handle to a fetched chunk, which is given back to the prefetcher
+        // when the handle goes out of scope
+        class Handle {
+
+        public:
+            Handle(ChunkPrefetcher * prefetcher, FetchedType * fetched) :
+                prefetcher_(prefetcher), fetched_(fetched) {
+            }
+
+            Handle(Handle && other) : prefetcher_(other.prefetcher_), fetched_(other.fetched_) {
+                other.fetched_ = nullptr;
+            }
+
+            ~Handle() {
+                if(fetched_) {
+                    prefetcher_->release(fetched_);
+                }
+            }
+
+            explicit operator bool() const {return fetched_ != nullptr;}
+            const FetchedType & operator*() const {return *fetched_;}
+            const FetchedType * operator->() const {return fetched_;}
+
+            Handle(const Handle &) = delete;
+            Handle & operator=(const Handle &) = delete;
+            Handle & operator=(Handle &&) = delete;
+
+        private:
+            ChunkPrefetcher * prefetcher_;
+            FetchedType * fetched_;
+        };
+
+        // numberOfConsumers is the number of threads that call next() concurrently
+        ChunkPrefetcher(const DatasetTyped<T> & ds,
+                        const util::ChunkRange & chunkRange,
+                        const size_t maxBytes,
+                        const int numberOfThreads,
+                        const int numberOfConsumers=1) :
+            ds_(ds), chunkRange_(chunkRange), maxBytes_(maxBytes),
+            maxChunks_(queueDepthPerThread * (std::max(numberOfThreads, 1) + std::max(numberOfConsumers, 1))),
+            nextFetch_(0), nHandedOut_(0), nOutstanding_(0), bytesAhead_(0), stop_(false) {
+            const size_t nThreads = std::min(static_cast<size_t>(std::max(numberOfThreads, 1)), chunkRange.size());
+            threads_.reserve(nThreads);
+            for(size_t t = 0; t < nThreads; ++t) {
+                threads_.emplace_back([this](){fetchLoop();});
+            }
+        }
+
+        ~ChunkPrefetcher() {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                stop_ = true;
+            }
+            canFetch_.notify_all();
+            for(auto & thread : threads_) {
+                thread.join();
+            }
+        }
+
+        // get the next chunk that was read, blocks until one is available;
+        // returns an empty handle if all chunks were handed out already and
+        // rethrows the exception if reading a chunk has failed
+        inline Handle next() {
+            std::unique_lock<std::mutex> lock(mutex_);
+            if(nHandedOut_ == chunkRange_.size()) {
+                return Handle(this, nullptr);
+            }
+            ready_.wait(lock, [this](){return !readyQueue_.empty() || error_;});
+            if(error_) {
+                std::rethrow_exception(error_);
+            }
+            FetchedType * fetched = readyQueue_.front();
+            readyQueue_.pop_front();
+            ++nHandedOut_;
+            return Handle(this, fetched);
+        }
+
+        ChunkPrefetcher(const ChunkPrefetcher &) = delete;
+        ChunkPrefetcher & operator=(const ChunkPrefetcher &) = delete;
+
+    private:
+
+        inline void release(FetchedType * fetched) {
+            const size_t nBytes = fetched->nBytes();
+            // don't keep the file mapped until the slot is reused
+            fetched->mapped.unmap();
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                bytesAhead_ -= nBytes;
+                --nOutstanding_;
+                free_.push_back(fetched);
+            }
+            canFetch_.notify_one();
+        }
+
+        inline void fetchLoop() {
+            types::CoordinateType chunkId;
+            while(true) {
+
+                // wait until we are allowed to read ahead and get a free slot
+                size_t chunkIndex;
+                FetchedType * fetched;
+                {
+                    std::unique_lock<std::mutex> lock(mutex_);
+                    canFetch_.wait(lock, [this](){
+                        return stop_ || nextFetch_ == chunkRange_.size() ||
+                               (nOutstanding_ < maxChunks_ && bytesAhead_ < maxBytes_);
+                    });
+                    if(stop_ || nextFetch_ == chunkRange_.size()) {
+                        return;
+                    }
+                    chunkIndex = nextFetch_++;
+                    ++nOutstanding_;
+                    if(free_.empty()) {
+                        slots_.emplace_back(new FetchedType());
+                        fetched = slots_.back().get();
+                    } else {
+                        fetched = free_.back();
+                        free_.pop_back();
+                    }
+                }
+
+                // read the chunk
+                try {
+                    chunkRange_.chunkAt(chunkIndex, chunkId);
+                    ds_.fetchChunk(chunkId, *fetched);
+                } catch(...) {
+                    {
+                        std::lock_guard<std::mutex> lock(mutex_);
+                        if(!error_) {
+                            error_ = std::current_exception();
+                        }
+                        stop_ = true;
+                    }
+                    ready_.notify_all();
+                    canFetch_.notify_all();
+                    return;
+                }
+
+                {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    bytesAhead_ += fetched->nBytes();
+                    readyQueue_.push_back(fetched);
+                }
+                ready_.notify_one();
+            }
+        }
+
+        const DatasetTyped<T> & ds_;
+        const util::ChunkRange & chunkRange_;
+        const size_t maxBytes_;
+        const size_t maxChunks_;
+
+        // the state of the queue, guarded by the mutex
+        size_t nextFetch_;
+        size_t nHandedOut_;
+        size_t nOutstanding_;
+        size_t bytesAhead_;
+        bool stop_;
+        std::exception_ptr error_;
+        std::deque<FetchedType *> readyQueue_;
+        std::vector<FetchedType *> free_;
+        std::vector<std::unique_ptr<FetchedType>> slots_;
+
+        std::mutex mutex_;
+        std::condition_variable canFetch_;
+        std::condition_variable ready_;
+        std::vector<std::thread> threads_;
+    };
+
+}
+}
@@ -1,7 +1,13 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
+
 #include "z5/dataset.hxx"
+#include "z5/multiarray/chunk_prefetch.hxx"
 #include "z5/types/types.hxx"
+#include "z5/util/threadpool.hxx"
+#include "z5/util/strided_copy.hxx"
 #include "andres/marray.hxx"
 
 // free functions to read and write from multiarrays
@@ -10,63 +16,498 @@
 namespace z5 {
 namespace multiarray {
 
+namespace access_detail {
+
+    // buffer and coordinate scratch space for a single chunk;
+    // each thread that reads / writes chunks needs its own instance
+    template<typename T>
+    struct ChunkBuffer {
+
+        ChunkBuffer(const Dataset & ds, const T initValue=T()) :
+            buffer(ds.maxChunkShape().begin(), ds.maxChunkShape().end(), initValue),
+            bufferShape(buffer.shapeBegin(), buffer.shapeEnd()) {
+        }
+
+        // resize the buffer if the shape of the current chunk is different
+        inline void resize(const types::CoordinateType & chunkShape) {
+            if(bufferShape != chunkShape) {
+                buffer.resize(andres::SkipInitialization, chunkShape.begin(), chunkShape.end());
+                bufferShape = chunkShape;
+            }
+        }
+
+        andres::Marray<T> buffer;
+        types::CoordinateType bufferShape;
+        types::CoordinateType localOffset, localShape, chunkShape;
+        types::CoordinateType inChunkOffset;
+        // id of the chunk that is processed, used for parallel access
+        types::CoordinateType chunkId;
+    };
+
+
+    // check if the view is contiguous in memory in C order,
+    // i.e. it can be used as the data pointer of a full chunk
+    template<typename T, bool isConst>
+    inline bool isContiguous(const andres::View<T, isConst> & view) {
+        size_t expectedStride = 1;
+        for(int d = view.dimension() - 1; d >= 0; --d) {
+            // singleton axes don't matter for the memory layout
+            if(view.shape(d) != 1 && view.strides(d) != expectedStride) {
+                return false;
+            }
+            expectedStride *= view.shape(d);
+        }
+        return true;
+    }
+
+
+    // copy the data of the src view to the dst view (of the same shape),
+    // moving contiguous runs with memcpy
+    template<typename T, bool isConst>
+    inline void copyView(const andres::View<T, isConst> & src, andres::View<T> & dst) {
+        const unsigned dim = src.dimension();
+        types::CoordinateType shape(src.shapeBegin(), src.shapeEnd());
+        types::CoordinateType srcStrides(dim), dstStrides(dim);
+        for(unsigned d = 0; d < dim; ++d) {
+            srcStrides[d] = src.strides(d);
+            dstStrides[d] = dst.strides(d);
+        }
+        util::copyStridedRegion(&src(0), srcStrides.data(), &dst(0), dstStrides.data(), shape.data(), dim);
+    }
+
+
+    // read the chunk data, decoding the chunk that was read ahead if we have it
+    template<typename T>
+    inline void readChunkData(const Dataset & ds,
+                              const types::CoordinateType & chunkId,
+                              T * dataOut,
+                              const FetchedChunk<T> * fetched) {
+        if(fetched) {
+            static_cast<const DatasetTyped<T> &>(ds).decodeChunk(*fetched, dataOut);
+        } else {
+            ds.readChunk(chunkId, dataOut);
+        }
+    }
+
+
+    // read a single chunk and copy the requested part into the out view
+    // (for arbitrary dimension)
+    template<typename T>
+    inline void readChunkGeneric(
+        const Dataset & ds,
+        const types::CoordinateType & chunkId,
+        const types::CoordinateType & offset,
+        const types::CoordinateType & shape,
+        andres::View<T> & out,
+        ChunkBuffer<T> & chunkBuffer,
+        const FetchedChunk<T> * fetched=nullptr
+    ) {
+        auto & buffer = chunkBuffer.buffer;
+        const auto & localShape = chunkBuffer.localShape;
+        const auto & inChunkOffset = chunkBuffer.inChunkOffset;
+
+        bool completeOvlp = ds.getCoordinatesInRequest(
+            chunkId, offset, shape, chunkBuffer.localOffset, chunkBuffer.localShape, chunkBuffer.inChunkOffset
+        );
+        auto view = out.view(chunkBuffer.localOffset.begin(), localShape.begin());
+
+        // request and chunk completely overlap and the view is contiguous
+        // -> we can decompress the chunk directly into the out data
+        if(completeOvlp && isContiguous(view)) {
+            readChunkData(ds, chunkId, &view(0), fetched);
+            return;
+        }
+
+        // get the current chunk-shape and resize the buffer if necessary
+        ds.getChunkShape(chunkId, chunkBuffer.chunkShape);
+        chunkBuffer.resize(chunkBuffer.chunkShape);
+
+        // read the current chunk into the buffer
+        readChunkData(ds, chunkId, &buffer(0), fetched);
+        Z5_STAGE_TIMER(copyTimer, ds.ioCounters().copyNs);
+        util::TraceScope traceCopy("copy", chunkId);
+
+        // request and chunk completely overlap, but the view is not contiguous
+        // -> copy the data from the buffer into the view
+        if(completeOvlp) {
+            copyView(buffer, view);
+        }
+        // request and chunk overlap only partially
+        // -> we can read the chunk data only partially
+        else {
+            // copy the data from the correct buffer-view to the out view
+            auto bufView = buffer.view(inChunkOffset.begin(), localShape.begin());
+            copyView(bufView, view);
+        }
+    }
+
+
+    // write the requested part of the in view to a single chunk
+    // (for arbitrary dimension)
+    template<typename T>
+    inline void writeChunkGeneric(
+        const Dataset & ds,
+        const types::CoordinateType & chunkId,
+        const types::CoordinateType & offset,
+        const types::CoordinateType & shape,
+        const andres::View<T> & in,
+        ChunkBuffer<T> & chunkBuffer
+    ) {
+        auto & buffer = chunkBuffer.buffer;
+        const auto & localShape = chunkBuffer.localShape;
+        const auto & inChunkOffset = chunkBuffer.inChunkOffset;
+
+        bool completeOvlp = ds.getCoordinatesInRequest(
+            chunkId, offset, shape, chunkBuffer.localOffset, chunkBuffer.localShape, chunkBuffer.inChunkOffset
+        );
+        auto view = in.constView(chunkBuffer.localOffset.begin(), localShape.begin());
+
+        // request and chunk overlap completely and the view is contiguous
+        // -> we can compress the chunk directly from the in data
+        if(completeOvlp && isContiguous(view)) {
+            ds.writeChunk(chunkId, &view(0));
+            return;
+        }
+
+        // resize buffer if necessary
+        ds.getChunkShape(chunkId, chunkBuffer.chunkShape);
+        chunkBuffer.resize(chunkBuffer.chunkShape);
+
+        // request and chunk overlap completely, but the view is not contiguous
+        // -> we need to copy to the buffer before writing the whole chunk
+        if(completeOvlp) {
+            Z5_STAGE_TIMER(copyTimer, ds.ioCounters().copyNs);
+            util::TraceScope traceCopy("copy", chunkId);
+            copyView(view, buffer);
+            Z5_STAGE_STOP(copyTimer);
+            traceCopy.stop();
+            ds.writeChunk(chunkId, &buffer(0));
+        }
+
+        // request and chunk overlap only partially
+        // -> we can only write partial data and need
+        // to preserve the data that will not be written
+        else {
+            // load the current data into the buffer
+            ds.readChunkForUpdate(chunkId, &buffer(0));
+            // overwrite the data that is covered by the view
+            Z5_STAGE_TIMER(copyTimer, ds.ioCounters().copyNs);
+            util::TraceScope traceCopy("copy", chunkId);
+            auto bufView = buffer.view(inChunkOffset.begin(), localShape.begin());
+            copyView(view, bufView);
+            Z5_STAGE_STOP(copyTimer);
+            traceCopy.stop();
+            ds.writeChunk(chunkId, &buffer(0));
+        }
+    }
+
+    //
+    // kernels for a dimension that is known at compile time
+    //
+
+    // geometry of a request with N dimensions
+    template<unsigned N>
+    struct RequestND {
+        typedef std::array<size_t, N> CoordType;
+
+        template<typename VIEW>
+        RequestND(const Dataset & ds,
+                  const types::CoordinateType & requestOffset,
+                  const types::CoordinateType & requestShape,
+                  const VIEW & view) {
+            for(unsigned d = 0; d < N; ++d) {
+                offset[d] = requestOffset[d];
+                shape[d] = requestShape[d];
+                maxChunkShape[d] = ds.maxChunkShape(d);
+                viewStrides[d] = view.strides(d);
+            }
+        }
+
+        // compute the overlap of the chunk with the request,
+        // returns true if the chunk is completely covered by the request
+        inline bool coordinatesInRequest(
+            const types::CoordinateType & chunkId,
+            const types::CoordinateType & chunkShape,
+            CoordType & localOffset,
+            CoordType & localShape,
+            CoordType & inChunkOffset
+        ) const {
+            bool completeOvlp = true;
+            for(unsigned d = 0; d < N; ++d) {
+                const size_t chunkBegin = chunkId[d] * maxChunkShape[d];
+                const size_t chunkEnd = chunkBegin + chunkShape[d];
+                const size_t begin = std::max(chunkBegin, offset[d]);
+                const size_t end = std::min(chunkEnd, offset[d] + shape[d]);
+                localOffset[d] = begin - offset[d];
+                inChunkOffset[d] = begin - chunkBegin;
+                localShape[d] = end - begin;
+                completeOvlp = completeOvlp && (localShape[d] == chunkShape[d]);
+            }
+            return completeOvlp;
+        }
+
+        // offset of the coordinate in the view data
+        inline size_t viewOffset(const CoordType & coord) const {
+            size_t ret = 0;
+            for(unsigned d = 0; d < N; ++d) {
+                ret += coord[d] * viewStrides[d];
+            }
+            return ret;
+        }
+
+        // check if the region of the view with the given shape
+        // is contiguous in memory in C order
+        inline bool isContiguous(const CoordType & regionShape) const {
+            size_t expectedStride = 1;
+            for(int d = N - 1; d >= 0; --d) {
+                if(regionShape[d] != 1 && viewStrides[d] != expectedStride) {
+                    return false;
+                }
+                expectedStride *= regionShape[d];
+            }
+            return true;
+        }
+
+        CoordType offset, shape, maxChunkShape, viewStrides;
+    };
+
+
+    // strides of a chunk in C order
+    template<unsigned N>
+    inline void chunkStrides(const types::CoordinateType & chunkShape, std::array<size_t, N> & strides) {
+        strides[N - 1] = 1;
+        for(int d = N - 2; d >= 0; --d) {
+            strides[d] = strides[d + 1] * chunkShape[d + 1];
+        }
+    }
+
+
+    template<unsigned N, typename T>
+    inline void readChunkND(
+        const Dataset & ds,
+        const types::CoordinateType & chunkId,
+        const RequestND<N> & request,
+        T * outData,
+        ChunkBuffer<T> & chunkBuffer,
+        const FetchedChunk<T> * fetched=nullptr
+    ) {
+        typedef typename RequestND<N>::CoordType CoordType;
+        CoordType localOffset, localShape, inChunkOffset;
+
+        ds.getChunkShape(chunkId, chunkBuffer.chunkShape);
+        const bool completeOvlp = request.coordinatesInRequest(
+            chunkId, chunkBuffer.chunkShape, localOffset, localShape, inChunkOffset
+        );
+        T * outBegin = outData + request.viewOffset(localOffset);
+
+        // request and chunk completely overlap and the out region is contiguous
+        // -> we can decompress the chunk directly into the out data
+        if(completeOvlp && request.isContiguous(localShape)) {
+            readChunkData(ds, chunkId, outBegin, fetched);
+            return;
+        }
+
+        // otherwise read the chunk into the buffer and copy the requested part
+        chunkBuffer.resize(chunkBuffer.chunkShape);
+        const T * bufferData = &chunkBuffer.buffer(0);
+        readChunkData(ds, chunkId, &chunkBuffer.buffer(0), fetched);
+        Z5_STAGE_TIMER(copyTimer, ds.ioCounters().copyNs);
+        util::TraceScope traceCopy("copy", chunkId);
+
+        CoordType bufferStrides;
+        chunkStrides<N>(chunkBuffer.chunkShape, bufferStrides);
+        size_t bufferOffset = 0;
+        for(unsigned d = 0; d < N; ++d) {
+            bufferOffset += inChunkOffset[d] * bufferStrides[d];
+        }
+        util::copyStridedRegion(bufferData + bufferOffset, bufferStrides.data(),
+                                outBegin, request.viewStrides.data(),
+                                localShape.data(), N);
+    }
+
+
+    template<unsigned N, typename T>
+    inline void writeChunkND(
+        const Dataset & ds,
+        const types::CoordinateType & chunkId,
+        const RequestND<N> & request,
+        const T * inData,
+        ChunkBuffer<T> & chunkBuffer
+    ) {
+        typedef typename RequestND<N>::CoordType CoordType;
+        CoordType localOffset, localShape, inChunkOffset;
+
+        ds.getChunkShape(chunkId, chunkBuffer.chunkShape);
+        const bool completeOvlp = request.coordinatesInRequest(
+            chunkId, chunkBuffer.chunkShape, localOffset, localShape, inChunkOffset
+        );
+        const T * inBegin = inData + request.viewOffset(localOffset);
+
+        // request and chunk completely overlap and the in region is contiguous
+        // -> we can compress the chunk directly from the in data
+        if(completeOvlp && request.isContiguous(localShape)) {
+            ds.writeChunk(chunkId, inBegin);
+            return;
+        }
+
+        // otherwise we need to go through the buffer; if the chunk is only
+        // partially covered, we need to preserve the data that is not written
+        chunkBuffer.resize(chunkBuffer.chunkShape);
+        T * bufferData = &chunkBuffer.buffer(0);
+        if(!completeOvlp) {
+            ds.readChunkForUpdate(chunkId, bufferData);
+        }
+
+        Z5_STAGE_TIMER(copyTimer, ds.ioCounters().copyNs);
+        util::TraceScope traceCopy("copy", chunkId);
+        CoordType bufferStrides;
+        chunkStrides<N>(chunkBuffer.chunkShape, bufferStrides);
+        size_t bufferOffset = 0;
+        for(unsigned d = 0; d < N; ++d) {
+            bufferOffset += inChunkOffset[d] * bufferStrides[d];
+        }
+        util::copyStridedRegion(inBegin, request.viewStrides.data(),
+                                bufferData + bufferOffset, bufferStrides.data(),
+                                localShape.data(), N);
+        Z5_STAGE_STOP(copyTimer);
+        traceCopy.stop();
+        ds.writeChunk(chunkId, bufferData);
+    }
+
+
+    //
+    // entry points that dispatch to the kernels for 2d and 3d data
+    // and to the generic implementation otherwise
+    //
+
+    // read a single chunk and copy the requested part into the out view
+    template<typename T>
+    inline void readChunk(
+        const Dataset & ds,
+        const types::CoordinateType & chunkId,
+        const types::CoordinateType & offset,
+        const types::CoordinateType & shape,
+        andres::View<T> & out,
+        ChunkBuffer<T> & chunkBuffer,
+        const FetchedChunk<T> * fetched=nullptr
+    ) {
+        switch(out.dimension()) {
+            case 2: readChunkND<2>(ds, chunkId, RequestND<2>(ds, offset, shape, out), &out(0), chunkBuffer, fetched); break;
+            case 3: readChunkND<3>(ds, chunkId, RequestND<3>(ds, offset, shape, out), &out(0), chunkBuffer, fetched); break;
+            default: readChunkGeneric(ds, chunkId, offset, shape, out, chunkBuffer, fetched);
+        }
+    }
+
+
+    // write the requested part of the in view to a single chunk
+    // partially covered chunks are read, updated and written again;
+    // this is safe to do in parallel, because every chunk is
+    // only visited once per request
+    template<typename T>
+    inline void writeChunk(
+        const Dataset & ds,
+        const types::CoordinateType & chunkId,
+        const types::CoordinateType & offset,
+        const types::CoordinateType & shape,
+        const andres::View<T> & in,
+        ChunkBuffer<T> & chunkBuffer
+    ) {
+        switch(in.dimension()) {
+            case 2: writeChunkND<2>(ds, chunkId, RequestND<2>(ds, offset, shape, in), &in(0), chunkBuffer); break;
+            case 3: writeChunkND<3>(ds, chunkId, RequestND<3>(ds, offset, shape, in), &in(0), chunkBuffer); break;
+            default: writeChunkGeneric(ds, chunkId, offset, shape, in, chunkBuffer);
+        }
+    }
+
+}
+
+
     //
     template<typename T, typename ITER>
     void readSubarray(const Dataset & ds, andres::View<T> & out, ITER roiBeginIter) {
 
         // get the offset and shape of the request and check if it is valid
-        types::ShapeType offset(roiBeginIter, roiBeginIter+out.dimension());
-        types::ShapeType shape(out.shapeBegin(), out.shapeEnd());
+        types::CoordinateType offset(roiBeginIter, roiBeginIter+out.dimension());
+        types::CoordinateType shape(out.shapeBegin(), out.shapeEnd());
         ds.checkRequestShape(offset, shape);
         ds.checkRequestType(typeid(T));
 
         // get the chunks that are involved in this request
-        std::vector<types::ShapeType> chunkRequests;
-        ds.getChunkRequests(offset, shape, chunkRequests);
-
-        types::ShapeType localOffset, localShape, chunkShape;
-        types::ShapeType inChunkOffset;
+        util::ChunkRange chunkRange;
+        ds.getChunkRange(offset, shape, chunkRange);
 
         // create mds to have a buffer for non-overlapping overlaps
+        // and views that are not contiguous in memory
+        access_detail::ChunkBuffer<T> chunkBuffer(ds);
 
-        // TODO writing directly to a view does not work, probably because it is not continuous in memory (?!)
-        // that's why we use the buffer for now.
-        // In the end, it would be nice to do this without the buffer (which introduces an additional copy)
-        // Benchmark and figure this out !
-        andres::Marray<T> buffer(ds.maxChunkShape().begin(), ds.maxChunkShape().end());
-        types::ShapeType bufferShape(buffer.shapeBegin(), buffer.shapeEnd());
+        // read the chunks ahead on the prefetch threads while we decode and copy them
+        if(ds.prefetchSize() > 0 && chunkRange.size() > 1) {
+            ChunkPrefetcher<T> prefetcher(static_cast<const DatasetTyped<T> &>(ds), chunkRange,
+                                          ds.prefetchSize(), ds.prefetchThreads());
+            while(auto fetched = prefetcher.next()) {
+                access_detail::readChunk(ds, fetched->chunkId, offset, shape, out, chunkBuffer, &*fetched);
+            }
+            return;
+        }
 
         // iterate over the chunks
-        for(const auto & chunkId : chunkRequests) {
+        for(const auto & chunkId : chunkRange) {
+            access_detail::readChunk(ds, chunkId, offset, shape, out, chunkBuffer);
+        }
+    }
 
-            bool completeOvlp = ds.getCoordinatesInRequest(chunkId, offset, shape, localOffset, localShape, inChunkOffset);
-            auto view = out.view(localOffset.begin(), localShape.begin());
 
-            // get the current chunk-shape and resize the buffer if necessary
-            ds.getChunkShape(chunkId, chunkShape);
-            if(bufferShape != chunkShape) {
-                buffer.resize(andres::SkipInitialization, chunkShape.begin(), chunkShape.end());
-                bufferShape = chunkShape;
-            }
+    // read with chunk-level parallelism on a (caller-supplied) thread pool
+    template<typename T, typename ITER>
+    void readSubarray(const Dataset & ds, andres::View<T> & out, ITER roiBeginIter, util::ThreadPool & threadpool) {
 
-            // read the current chunk into the buffer
-            ds.readChunk(chunkId, &buffer(0));
+        // get the offset and shape of the request and check if it is valid
+        types::CoordinateType offset(roiBeginIter, roiBeginIter+out.dimension());
+        types::CoordinateType shape(out.shapeBegin(), out.shapeEnd());
+        ds.checkRequestShape(offset, shape);
+        ds.checkRequestType(typeid(T));
 
-            // request and chunk completely overlap
-            // -> we can read all the data from the chunk
-            if(completeOvlp) {
-                // without data copy: not working
-                //ds.readChunk(chunkId, &view(0));
+        // get the chunks that are involved in this request
+        util::ChunkRange chunkRange;
+        ds.getChunkRange(offset, shape, chunkRange);
 
-                // copy the data from the buffer into the view
-                view = buffer;
+        // read the chunks ahead on the prefetch threads, the pool threads decode and copy them
+        std::unique_ptr<ChunkPrefetcher<T>> prefetcher;
+        if(ds.prefetchSize() > 0 && chunkRange.size() > 1) {
+            prefetcher.reset(new ChunkPrefetcher<T>(static_cast<const DatasetTyped<T> &>(ds), chunkRange,
+                                                    ds.prefetchSize(), ds.prefetchThreads(),
+                                                    threadpool.nThreads()));
+        }
+
+        // every thread gets its own chunk buffer, which is allocated lazily
+        // the chunks are disjoint, so the threads write to disjoint views of out
+        std::vector<std::unique_ptr<access_detail::ChunkBuffer<T>>> chunkBuffers(threadpool.nThreads());
+        util::parallel_foreach(threadpool, chunkRange.size(), [&](const int tid, const size_t chunkIndex){
+            auto & chunkBuffer = chunkBuffers[tid];
+            if(!chunkBuffer) {
+                chunkBuffer.reset(new access_detail::ChunkBuffer<T>(ds));
             }
-            // request and chunk overlap only partially
-            // -> we can read the chunk data only partially
-            else {
-                // copy the data from the correct buffer-view to the out view
-                view = buffer.view(inChunkOffset.begin(), localShape.begin());
+            // with prefetching, every job takes the next chunk that was read
+            if(prefetcher) {
+                auto fetched = prefetcher->next();
+                access_detail::readChunk(ds, fetched->chunkId, offset, shape, out, *chunkBuffer, &*fetched);
+                return;
             }
+            chunkRange.chunkAt(chunkIndex, chunkBuffer->chunkId);
+            access_detail::readChunk(ds, chunkBuffer->chunkId, offset, shape, out, *chunkBuffer);
+        });
+    }
+
+
+    // read with chunk-level parallelism on numberOfThreads threads
+    // (numberOfThreads <= 0 uses all available cores)
+    template<typename T, typename ITER>
+    void readSubarray(const Dataset & ds, andres::View<T> & out, ITER roiBeginIter, const int numberOfThreads) {
+        if(numberOfThreads == 1) {
+            readSubarray(ds, out, roiBeginIter);
+        } else {
+            util::ThreadPool threadpool(numberOfThreads);
+            readSubarray(ds, out, roiBeginIter, threadpool);
         }
     }
 
@@ -75,56 +516,61 @@ namespace multiarray {
     void writeSubarray(const Dataset & ds, const andres::View<T> & in, ITER roiBeginIter) {
 
         // get the offset and shape of the request and check if it is valid
-        types::ShapeType offset(roiBeginIter, roiBeginIter+in.dimension());
-        types::ShapeType shape(in.shapeBegin(), in.shapeEnd());
+        types::CoordinateType offset(roiBeginIter, roiBeginIter+in.dimension());
+        types::CoordinateType shape(in.shapeBegin(), in.shapeEnd());
         ds.checkRequestShape(offset, shape);
         ds.checkRequestType(typeid(T));
 
         // get the chunks that are involved in this request
-        std::vector<types::ShapeType> chunkRequests;
-        ds.getChunkRequests(offset, shape, chunkRequests);
+        util::ChunkRange chunkRange;
+        ds.getChunkRange(offset, shape, chunkRange);
 
-        types::ShapeType localOffset, localShape, chunkShape;
-        types::ShapeType inChunkOffset;
         // create marray to have a buffer for non-overlapping overlaps
-        andres::Marray<T> buffer(ds.maxChunkShape().begin(), ds.maxChunkShape().end());
-        types::ShapeType bufferShape(buffer.shapeBegin(), buffer.shapeEnd());
+        access_detail::ChunkBuffer<T> chunkBuffer(ds);
 
         // iterate over the chunks
-        for(const auto & chunkId : chunkRequests) {
+        for(const auto & chunkId : chunkRange) {
+            access_detail::writeChunk(ds, chunkId, offset, shape, in, chunkBuffer);
+        }
+    }
 
-            bool completeOvlp = ds.getCoordinatesInRequest(chunkId, offset, shape, localOffset, localShape, inChunkOffset);
-            auto view = in.constView(localOffset.begin(), localShape.begin());
 
-            // resize buffer if necessary
-            ds.getChunkShape(chunkId, chunkShape);
-            if(bufferShape != chunkShape) {
-                buffer.resize(andres::SkipInitialization, chunkShape.begin(), chunkShape.end());
-                bufferShape = chunkShape;
-            }
+    // write with chunk-level parallelism on a (caller-supplied) thread pool
+    template<typename T, typename ITER>
+    void writeSubarray(const Dataset & ds, const andres::View<T> & in, ITER roiBeginIter, util::ThreadPool & threadpool) {
 
-            // request and chunk overlap completely
-            // -> we can write the whole chunk
-            if(completeOvlp) {
-                // for now this does not work without copying,
-                // because views are not contiguous in memory (I think ?!)
-                // TODO would be nice to figure this out -> benchmark first !
-                //ds.writeChunk(chunkId, &view(0));
-                buffer = view;
-                ds.writeChunk(chunkId, &buffer(0));
-            }
+        // get the offset and shape of the request and check if it is valid
+        types::CoordinateType offset(roiBeginIter, roiBeginIter+in.dimension());
+        types::CoordinateType shape(in.shapeBegin(), in.shapeEnd());
+        ds.checkRequestShape(offset, shape);
+        ds.checkRequestType(typeid(T));
 
-            // request and chunk overlap only partially
-            // -> we can only write partial data and need
-            // to preserve the data that will not be written
-            else {
-                // load the current data into the buffer
-                ds.readChunk(chunkId, &buffer(0));
-                // overwrite the data that is covered by the view
-                auto bufView = buffer.view(inChunkOffset.begin(), localShape.begin());
-                bufView = view;
-                ds.writeChunk(chunkId, &buffer(0));
+        // get the chunks that are involved in this request
+        util::ChunkRange chunkRange;
+        ds.getChunkRange(offset, shape, chunkRange);
+
+        // every thread gets its own chunk buffer, which is allocated lazily
+        std::vector<std::unique_ptr<access_detail::ChunkBuffer<T>>> chunkBuffers(threadpool.nThreads());
+        util::parallel_foreach(threadpool, chunkRange.size(), [&](const int tid, const size_t chunkIndex){
+            auto & chunkBuffer = chunkBuffers[tid];
+            if(!chunkBuffer) {
+                chunkBuffer.reset(new access_detail::ChunkBuffer<T>(ds));
             }
+            chunkRange.chunkAt(chunkIndex, chunkBuffer->chunkId);
+            access_detail::writeChunk(ds, chunkBuffer->chunkId, offset, shape, in, *chunkBuffer);
+        });
+    }
+
+
+    // write with chunk-level parallelism on numberOfThreads threads
+    // (numberOfThreads <= 0 uses all available cores)
+    template<typename T, typename ITER>
+    void writeSubarray(const Dataset & ds, const andres::View<T> & in, ITER roiBeginIter, const int numberOfThreads) {
+        if(numberOfThreads == 1) {
+            writeSubarray(ds, in, roiBeginIter);
+        } else {
+            util::ThreadPool threadpool(numberOfThreads);
+            writeSubarray(ds, in, roiBeginIter, threadpool);
         }
     }
 
@@ -140,5 +586,25 @@ namespace multiarray {
         writeSubarray(*ds, in, roiBeginIter);
     }
 
+    template<typename T, typename ITER>
+    void readSubarray(std::unique_ptr<Dataset> & ds, andres::View<T> & out, ITER roiBeginIter, const int numberOfThreads) {
+       readSubarray(*ds, out, roiBeginIter, numberOfThreads);
+    }
+
+    template<typename T, typename ITER>
+    void writeSubarray(std::unique_ptr<Dataset> & ds, const andres::View<T> & in, ITER roiBeginIter, const int numberOfThreads) {
+        writeSubarray(*ds, in, roiBeginIter, numberOfThreads);
+    }
+
+    template<typename T, typename ITER>
+    void readSubarray(std::unique_ptr<Dataset> & ds, andres::View<T> & out, ITER roiBeginIter, util::ThreadPool & threadpool) {
+       readSubarray(*ds, out, roiBeginIter, threadpool);
+    }
+
+    template<typename T, typename ITER>
+    void writeSubarray(std::unique_ptr<Dataset> & ds, const andres::View<T> & in, ITER roiBeginIter, util::ThreadPool & threadpool) {
+        writeSubarray(*ds, in, roiBeginIter, threadpool);
+    }
+
 }
 }
@@ -4,6 +4,8 @@
 #include <string>
 #include <map>
 
+#include "z5/util/small_vector.hxx"
+
 namespace z5 {
 namespace types {
 
@@ -16,6 +18,11 @@ namespace types {
     // type for array shapes
     typedef std::vector<size_t> ShapeType;
 
+    // coordinate type for the hot paths (chunk ids, request offsets and shapes),
+    // which stores up to 8 dimensions inline and does not allocate;
+    // it converts implicitly from and to ShapeType
+    typedef util::SmallVector<size_t, 8> CoordinateType;
+
     //
     // Datatypes
     //
@@ -69,6 +76,7 @@ namespace types {
     // that are supported
     enum Compressor {
         raw,
+        compressedSegmentation,
         #ifdef WITH_BLOSC
         blosc,
         #endif
@@ -78,6 +86,12 @@ namespace types {
         #ifdef WITH_BZIP2
         bzip2,
         #endif
+        #ifdef WITH_ZSTD
+        zstd,
+        #endif
+        #ifdef WITH_ZFP
+        zfp,
+        #endif
         #ifdef WITH_LZ4
         lz4,
         #endif
@@ -88,6 +102,7 @@ namespace types {
 
     std::map<std::string, Compressor> stringToCompressor({{
         {"raw", raw},
+        {"compressed_segmentation", compressedSegmentation},
         #ifdef WITH_BLOSC
         {"blosc", blosc},
         #endif
@@ -98,6 +113,12 @@ namespace types {
         #ifdef WITH_BZIP2
         {"bzip2", bzip2},
         #endif
+        #ifdef WITH_ZSTD
+        {"zstd", zstd},
+        #endif
+        #ifdef WITH_ZFP
+        {"zfp", zfp},
+        #endif
         #ifdef WITH_LZ4
         {"lz4", lz4},
         #endif
@@ -107,6 +128,7 @@ namespace types {
     }});
 
     std::map<std::string, Compressor> zarrToCompressor({{
+        {"compressed_segmentation", compressedSegmentation},
         #ifdef WITH_BLOSC
         {"blosc", blosc},
         #endif
@@ -116,12 +138,19 @@ namespace types {
         #ifdef WITH_BZIP2
         {"bzip2", bzip2},
         #endif
+        #ifdef WITH_ZSTD
+        {"zstd", zstd},
+        #endif
+        #ifdef WITH_ZFP
+        {"zfpy", zfp},
+        #endif
         #ifdef WITH_LZ4
         {"lz4", lz4},
         #endif
     }});
 
     std::map<Compressor, std::string> compressorToZarr({{
+        {compressedSegmentation, "compressed_segmentation"},
         #ifdef WITH_BLOSC
         {blosc, "blosc"},
         #endif
@@ -131,6 +160,12 @@ namespace types {
         #ifdef WITH_BZIP2
         {bzip2, "bzip2"},
         #endif
+        #ifdef WITH_ZSTD
+        {zstd, "zstd"},
+        #endif
+        #ifdef WITH_ZFP
+        {zfp, "zfpy"},
+        #endif
         #ifdef WITH_LZ4
         {lz4, "lz4"},
         #endif
@@ -138,12 +173,19 @@ namespace types {
 
     std::map<std::string, Compressor> n5ToCompressor({{
         {"raw", raw},
+        {"compressed_segmentation", compressedSegmentation},
         #ifdef WITH_ZLIB
         {"gzip", zlib},
         #endif
         #ifdef WITH_BZIP2
         {"bzip2", bzip2},
         #endif
+        #ifdef WITH_ZSTD
+        {"zstd", zstd},
+        #endif
+        #ifdef WITH_ZFP
+        {"zfp", zfp},
+        #endif
         #ifdef WITH_XZ
         {"xz", xz}
         #endif
@@ -151,12 +193,19 @@ namespace types {
 
     std::map<Compressor, std::string> compressorToN5({{
         {raw, "raw"},
+        {compressedSegmentation, "compressed_segmentation"},
         #ifdef WITH_ZLIB
         {zlib, "gzip"},
         #endif
         #ifdef WITH_BZIP2
         {bzip2, "bzip2"},
         #endif
+        #ifdef WITH_ZSTD
+        {zstd, "zstd"},
+        #endif
+        #ifdef WITH_ZFP
+        {zfp, "zfp"},
+        #endif
         #ifdef WITH_XZ
         {xz, "xz"}
         #endif
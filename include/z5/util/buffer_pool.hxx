@@ -0,0 +1,95 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+namespace z5 {
+namespace util {
+
+    // per-thread pool of reusable buffers, so that the temporary buffers needed
+    // to read, write and (de)compress chunks are not allocated for every chunk.
+    // a buffer is taken from the pool with acquire() and returned to it when the
+    // handle goes out of scope; the vectors keep their capacity, so in steady state
+    // (chunks of the same size) no heap allocation happens.
+    // the pool is thread-local, hence no locking is necessary.
+    template<typename T>
+    class BufferPool {
+
+    public:
+
+        // handle to a buffer of the pool
+        class Buffer {
+
+        public:
+            Buffer(std::unique_ptr<std::vector<T>> && vec) : vec_(std::move(vec)) {
+            }
+
+            Buffer(Buffer && other) = default;
+
+            ~Buffer() {
+                if(vec_) {
+                    BufferPool::release(std::move(vec_));
+                }
+            }
+
+            inline std::vector<T> & vector() {return *vec_;}
+            inline const std::vector<T> & vector() const {return *vec_;}
+            inline T * data() {return vec_->data();}
+            inline const T * data() const {return vec_->data();}
+            inline size_t size() const {return vec_->size();}
+
+            Buffer(const Buffer &) = delete;
+            Buffer & operator=(const Buffer &) = delete;
+
+        private:
+            std::unique_ptr<std::vector<T>> vec_;
+        };
+
+        // get a buffer with (at least) the given number of elements
+        // NOTE new elements are value-initialized, existing elements keep their values
+        static Buffer acquire(const size_t size) {
+            auto buffer = acquire();
+            buffer.vector().resize(size);
+            return buffer;
+        }
+
+        // get a buffer that keeps the size it had when it was released; for buffers
+        // that are resized by the caller (e.g. to the size of a chunk file), so that
+        // only the elements beyond the previous size are value-initialized
+        static Buffer acquire() {
+            auto & freeBuffers = pool();
+            std::unique_ptr<std::vector<T>> vec;
+            if(freeBuffers.empty()) {
+                vec.reset(new std::vector<T>());
+            } else {
+                vec = std::move(freeBuffers.back());
+                freeBuffers.pop_back();
+            }
+            return Buffer(std::move(vec));
+        }
+
+        // number of buffers that are currently held by the pool of this thread
+        static size_t numberOfFreeBuffers() {
+            return pool().size();
+        }
+
+    private:
+        // we only keep a few buffers per thread, which is enough for
+        // the nested buffers of the chunk read / write path
+        static const size_t maxFreeBuffers = 4;
+
+        static std::vector<std::unique_ptr<std::vector<T>>> & pool() {
+            static thread_local std::vector<std::unique_ptr<std::vector<T>>> freeBuffers;
+            return freeBuffers;
+        }
+
+        static void release(std::unique_ptr<std::vector<T>> && vec) {
+            auto & freeBuffers = pool();
+            if(freeBuffers.size() < maxFreeBuffers) {
+                freeBuffers.push_back(std::move(vec));
+            }
+        }
+    };
+
+}
+}
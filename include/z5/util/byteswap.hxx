@@ -0,0 +1,186 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+// vectorized kernels are only available for gcc / clang on x86,
+// the instruction set is selected at runtime
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__)) && !defined(Z5_NO_SIMD)
+#define Z5_BYTESWAP_X86
+#include <immintrin.h>
+#endif
+
+namespace z5 {
+namespace util {
+namespace byteswap_detail {
+
+    //
+    // portable scalar kernels, compilers turn the shifts into bswap instructions
+    //
+
+    template<unsigned N>
+    struct Swap;
+
+    template<>
+    struct Swap<2> {
+        typedef uint16_t UInt;
+        static inline UInt apply(const UInt val) {
+            return static_cast<UInt>((val >> 8) | (val << 8));
+        }
+    };
+
+    template<>
+    struct Swap<4> {
+        typedef uint32_t UInt;
+        static inline UInt apply(const UInt val) {
+            return ((val >> 24) & 0x000000ffu) | ((val >> 8) & 0x0000ff00u) |
+                   ((val << 8) & 0x00ff0000u) | ((val << 24) & 0xff000000u);
+        }
+    };
+
+    template<>
+    struct Swap<8> {
+        typedef uint64_t UInt;
+        static inline UInt apply(const UInt val) {
+            return (static_cast<UInt>(Swap<4>::apply(static_cast<uint32_t>(val))) << 32) |
+                   Swap<4>::apply(static_cast<uint32_t>(val >> 32));
+        }
+    };
+
+    // swap n values of N bytes from in to out, in and out may be the same
+    template<unsigned N>
+    inline void swapScalar(const char * in, char * out, const size_t n) {
+        typedef typename Swap<N>::UInt UInt;
+        UInt val;
+        for(size_t i = 0; i < n; ++i, in += N, out += N) {
+            // memcpy to avoid unaligned access and aliasing issues
+            std::memcpy(&val, in, N);
+            val = Swap<N>::apply(val);
+            std::memcpy(out, &val, N);
+        }
+    }
+
+
+    #ifdef Z5_BYTESWAP_X86
+
+    //
+    // ssse3 / avx2 kernels, based on byte shuffles
+    //
+
+    // shuffle mask that reverses the bytes of every N-byte value in 16 bytes
+    template<unsigned N>
+    inline const char * shuffleMask() {
+        static const struct Mask {
+            Mask() {
+                for(unsigned i = 0; i < 32; ++i) {
+                    const unsigned j = i % 16;
+                    bytes[i] = static_cast<char>((j / N) * N + (N - 1 - j % N));
+                }
+            }
+            char bytes[32];
+        } mask;
+        return mask.bytes;
+    }
+
+    template<unsigned N>
+    __attribute__((target("ssse3")))
+    void swapSSSE3(const char * in, char * out, const size_t n) {
+        const __m128i mask = _mm_loadu_si128(reinterpret_cast<const __m128i *>(shuffleMask<N>()));
+        const size_t nBytes = n * N;
+        size_t i = 0;
+        for(; i + 16 <= nBytes; i += 16) {
+            __m128i val = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), _mm_shuffle_epi8(val, mask));
+        }
+        swapScalar<N>(in + i, out + i, (nBytes - i) / N);
+    }
+
+    template<unsigned N>
+    __attribute__((target("avx2")))
+    void swapAVX2(const char * in, char * out, const size_t n) {
+        const __m256i mask = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(shuffleMask<N>()));
+        const size_t nBytes = n * N;
+        size_t i = 0;
+        for(; i + 32 <= nBytes; i += 32) {
+            __m256i val = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(in + i));
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i), _mm256_shuffle_epi8(val, mask));
+        }
+        swapScalar<N>(in + i, out + i, (nBytes - i) / N);
+    }
+
+    #endif
+
+
+    //
+    // runtime dispatch
+    //
+
+    typedef void (*SwapFunction)(const char *, char *, const size_t);
+
+    template<unsigned N>
+    inline SwapFunction selectSwapFunction() {
+        #ifdef Z5_BYTESWAP_X86
+        __builtin_cpu_init();
+        if(__builtin_cpu_supports("avx2")) {
+            return &swapAVX2<N>;
+        }
+        if(__builtin_cpu_supports("ssse3")) {
+            return &swapSSSE3<N>;
+        }
+        #endif
+        return &swapScalar<N>;
+    }
+
+    template<unsigned N>
+    inline void swapBytes(const char * in, char * out, const size_t n) {
+        // the kernel is selected once, static initialization is thread-safe
+        static const SwapFunction swapFunction = selectSwapFunction<N>();
+        swapFunction(in, out, n);
+    }
+
+
+    // fallback for types that are not 2, 4 or 8 bytes wide
+    inline void swapGeneric(const char * in, char * out, const size_t n, const size_t typeLen) {
+        if(in == out) {
+            for(size_t i = 0; i < n; ++i, out += typeLen) {
+                std::reverse(out, out + typeLen);
+            }
+        } else {
+            for(size_t i = 0; i < n; ++i, in += typeLen, out += typeLen) {
+                std::reverse_copy(in, in + typeLen, out);
+            }
+        }
+    }
+
+}
+
+
+    // copy n values from dataIn to dataOut and reverse their endianness;
+    // dataIn and dataOut may point to the same memory, but must not overlap otherwise
+    template<typename T>
+    inline void reverseEndianness(const T * dataIn, T * dataOut, const size_t n) {
+        const char * in = reinterpret_cast<const char *>(dataIn);
+        char * out = reinterpret_cast<char *>(dataOut);
+        switch(sizeof(T)) {
+            case 1:
+                if(in != out) {
+                    std::memcpy(out, in, n);
+                }
+                break;
+            case 2: byteswap_detail::swapBytes<2>(in, out, n); break;
+            case 4: byteswap_detail::swapBytes<4>(in, out, n); break;
+            case 8: byteswap_detail::swapBytes<8>(in, out, n); break;
+            default: byteswap_detail::swapGeneric(in, out, n, sizeof(T));
+        }
+    }
+
+
+    // reverse the endianness of n values inplace
+    template<typename T>
+    inline void reverseEndiannessInplace(T * data, const size_t n) {
+        reverseEndianness(data, data, n);
+    }
+
+}
+}
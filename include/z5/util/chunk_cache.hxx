@@ -0,0 +1,192 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "z5/types/types.hxx"
+
+namespace z5 {
+namespace util {
+
+    // thread-safe LRU cache of decoded chunks, keyed by the chunk indices
+    // the cache holds at most maxBytes of chunk data, if this budget is exceeded
+    // the least recently used chunks are evicted.
+    // to not cache data that was read before a concurrent write of the chunk,
+    // erase() increases the write generation of the chunk and put() only inserts
+    // the data if the generation did not change since the chunk was read
+    // (the generations are kept in a fixed number of slots shared by several chunks,
+    // so a write can also reject the data of another chunk, which is harmless)
+    template<typename T>
+    class ChunkCache {
+
+    public:
+        explicit ChunkCache(const size_t maxBytes) :
+            maxBytes_(maxBytes), currentBytes_(0), hits_(0), misses_(0) {
+        }
+
+        // copy the cached chunk data to dataOut and return true
+        // if the chunk is in the cache, otherwise return false
+        inline bool get(const types::CoordinateType & chunkId, T * dataOut) {
+            DataPointer data;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                auto it = index_.find(chunkId);
+                if(it == index_.end()) {
+                    ++misses_;
+                    return false;
+                }
+                ++hits_;
+                // move the entry to the front of the lru list
+                entries_.splice(entries_.begin(), entries_, it->second);
+                data = it->second->second;
+            }
+            // the data is immutable, so we can copy it without holding the lock
+            std::copy(data->begin(), data->end(), dataOut);
+            return true;
+        }
+
+        // check if the chunk is in the cache, without counting this as hit or miss
+        inline bool contains(const types::CoordinateType & chunkId) const {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return index_.find(chunkId) != index_.end();
+        }
+
+        // the write generation of the chunk, which must be queried
+        // before the chunk data that is put into the cache is read
+        inline size_t writeGeneration(const types::CoordinateType & chunkId) const {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return generations_[generationSlot(chunkId)];
+        }
+
+        // insert or update the data of a chunk that was read at the given write generation;
+        // if the chunk was written since then, the data is outdated and not inserted
+        inline void put(const types::CoordinateType & chunkId, const T * data, const size_t size,
+                        const size_t generation) {
+            const size_t nBytes = size * sizeof(T);
+            // chunks that don't fit into the cache are not cached
+            if(nBytes > maxBytes()) {
+                return;
+            }
+            // copy the data before we acquire the lock
+            DataPointer entry = std::make_shared<const std::vector<T>>(data, data + size);
+            std::lock_guard<std::mutex> lock(mutex_);
+            if(generations_[generationSlot(chunkId)] != generation) {
+                return;
+            }
+            eraseImpl(chunkId);
+            entries_.emplace_front(chunkId, std::move(entry));
+            index_[chunkId] = entries_.begin();
+            currentBytes_ += nBytes;
+            evict();
+        }
+
+        // remove a chunk from the cache because it was written
+        // NOTE this must be called after the chunk was written
+        inline void erase(const types::CoordinateType & chunkId) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            ++generations_[generationSlot(chunkId)];
+            eraseImpl(chunkId);
+        }
+
+        inline void clear() {
+            std::lock_guard<std::mutex> lock(mutex_);
+            entries_.clear();
+            index_.clear();
+            currentBytes_ = 0;
+        }
+
+        inline void setMaxBytes(const size_t maxBytes) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            maxBytes_ = maxBytes;
+            evict();
+        }
+
+        inline void resetCounters() {
+            std::lock_guard<std::mutex> lock(mutex_);
+            hits_ = 0;
+            misses_ = 0;
+        }
+
+        //
+        // getters
+        //
+        inline size_t maxBytes() const {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return maxBytes_;
+        }
+
+        inline size_t currentBytes() const {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return currentBytes_;
+        }
+
+        inline size_t numberOfChunks() const {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return index_.size();
+        }
+
+        inline size_t hits() const {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return hits_;
+        }
+
+        inline size_t misses() const {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return misses_;
+        }
+
+    private:
+        typedef std::shared_ptr<const std::vector<T>> DataPointer;
+        typedef std::pair<types::CoordinateType, DataPointer> EntryType;
+        typedef typename std::list<EntryType>::iterator EntryIterator;
+
+        static const size_t numberOfGenerationSlots = 256;
+
+        static inline size_t generationSlot(const types::CoordinateType & chunkId) {
+            size_t hash = 0;
+            for(const auto index : chunkId) {
+                hash = hash * 31 + index;
+            }
+            return hash % numberOfGenerationSlots;
+        }
+
+        // need to hold the lock when calling this
+        inline void eraseImpl(const types::CoordinateType & chunkId) {
+            auto it = index_.find(chunkId);
+            if(it != index_.end()) {
+                currentBytes_ -= it->second->second->size() * sizeof(T);
+                entries_.erase(it->second);
+                index_.erase(it);
+            }
+        }
+
+        // evict the least recently used chunks until we are within budget
+        // need to hold the lock when calling this
+        inline void evict() {
+            while(currentBytes_ > maxBytes_ && !entries_.empty()) {
+                const auto & last = entries_.back();
+                currentBytes_ -= last.second->size() * sizeof(T);
+                index_.erase(last.first);
+                entries_.pop_back();
+            }
+        }
+
+        // the entries in lru order (most recently used first)
+        std::list<EntryType> entries_;
+        std::map<types::CoordinateType, EntryIterator> index_;
+        std::array<size_t, numberOfGenerationSlots> generations_{};
+        mutable std::mutex mutex_;
+
+        size_t maxBytes_;
+        size_t currentBytes_;
+        size_t hits_;
+        size_t misses_;
+    };
+
+}
+}
@@ -0,0 +1,223 @@
+#pragma once
+
+#include <algorithm>
+#include <iterator>
+#include <stdexcept>
+#include <vector>
+
+#include "z5/types/types.hxx"
+
+namespace z5 {
+namespace util {
+
+    // order in which the chunks of a range are visited
+    enum TraversalOrder {
+        // last dimension is the fastest changing
+        cOrder,
+        // z-order curve, visits chunks that are close in all dimensions consecutively
+        mortonOrder
+    };
+
+
+    // lazy range over the (inclusive) grid [minCoords, maxCoords] of chunk indices
+    // in arbitrary dimension; the chunk indices are computed on the fly when iterating,
+    // so that the grid is never materialized
+    class ChunkRange {
+
+    public:
+
+        // a single chunk id that is updated when the iterator is advanced
+        class const_iterator : public std::iterator<std::forward_iterator_tag, types::CoordinateType> {
+
+        public:
+            const_iterator() : range_(nullptr), position_(0), code_(0) {
+            }
+
+            const_iterator(const ChunkRange & range, const bool isEnd) : range_(&range), position_(0), code_(0) {
+                if(isEnd || range.size() == 0) {
+                    position_ = range.size();
+                } else {
+                    // the first chunk is the same in both orders
+                    coord_ = range.minCoords_;
+                }
+            }
+
+            inline const types::CoordinateType & operator*() const {return coord_;}
+            inline const types::CoordinateType * operator->() const {return &coord_;}
+
+            inline const_iterator & operator++() {
+                if(++position_ >= range_->size()) {
+                    position_ = range_->size();
+                    return *this;
+                }
+                if(range_->order_ == cOrder) {
+                    incrementCOrder();
+                } else {
+                    incrementMortonOrder();
+                }
+                return *this;
+            }
+
+            inline const_iterator operator++(int) {
+                const_iterator ret(*this);
+                ++(*this);
+                return ret;
+            }
+
+            inline bool operator==(const const_iterator & other) const {
+                return range_ == other.range_ && position_ == other.position_;
+            }
+
+            inline bool operator!=(const const_iterator & other) const {
+                return !(*this == other);
+            }
+
+        private:
+            inline void incrementCOrder() {
+                for(int d = coord_.size() - 1; d >= 0; --d) {
+                    if(++coord_[d] <= range_->maxCoords_[d]) {
+                        break;
+                    }
+                    coord_[d] = range_->minCoords_[d];
+                }
+            }
+
+            // go to the next morton code that lies inside of the range
+            inline void incrementMortonOrder() {
+                while(!range_->decodeMorton(++code_, coord_)) {}
+            }
+
+            const ChunkRange * range_;
+            types::CoordinateType coord_;
+            // number of chunks that were visited before this one
+            size_t position_;
+            // the morton code of the current chunk (relative to minCoords)
+            size_t code_;
+        };
+
+        typedef const_iterator iterator;
+
+        ChunkRange() : size_(0), order_(cOrder) {
+        }
+
+        ChunkRange(const types::CoordinateType & minCoords,
+                   const types::CoordinateType & maxCoords,
+                   const TraversalOrder order=cOrder) {
+            reset(minCoords, maxCoords, order);
+        }
+
+        inline void reset(const types::CoordinateType & minCoords,
+                          const types::CoordinateType & maxCoords,
+                          const TraversalOrder order=cOrder) {
+            if(minCoords.size() != maxCoords.size()) {
+                throw std::runtime_error("z5.ChunkRange: min and max coordinates need to have the same dimension");
+            }
+            minCoords_ = minCoords;
+            maxCoords_ = maxCoords;
+            order_ = order;
+
+            const size_t nDim = minCoords_.size();
+            extent_.resize(nDim);
+            size_ = nDim > 0 ? 1 : 0;
+            for(size_t d = 0; d < nDim; ++d) {
+                if(maxCoords_[d] < minCoords_[d]) {
+                    throw std::runtime_error("z5.ChunkRange: max coordinates need to be larger or equal than min coordinates");
+                }
+                extent_[d] = maxCoords_[d] - minCoords_[d] + 1;
+                size_ *= extent_[d];
+            }
+
+            if(order_ == mortonOrder) {
+                initMorton();
+            }
+        }
+
+        inline const_iterator begin() const {return const_iterator(*this, false);}
+        inline const_iterator end() const {return const_iterator(*this, true);}
+
+        inline size_t size() const {return size_;}
+        inline size_t dimension() const {return minCoords_.size();}
+        inline TraversalOrder order() const {return order_;}
+        inline const types::CoordinateType & minCoords() const {return minCoords_;}
+        inline const types::CoordinateType & maxCoords() const {return maxCoords_;}
+
+        // get the chunk at the given (c-order) index of the range,
+        // this allows to distribute the chunks over threads without materializing them
+        template<typename COORD>
+        inline void chunkAt(size_t index, COORD & chunkId) const {
+            const int nDim = minCoords_.size();
+            chunkId.resize(nDim);
+            for(int d = nDim - 1; d >= 0; --d) {
+                chunkId[d] = minCoords_[d] + index % extent_[d];
+                index /= extent_[d];
+            }
+        }
+
+        // materialize the range (in traversal order)
+        inline void toVector(std::vector<types::ShapeType> & chunks) const {
+            chunks.reserve(chunks.size() + size_);
+            for(const auto & chunkId : *this) {
+                chunks.emplace_back(chunkId.begin(), chunkId.end());
+            }
+        }
+
+    private:
+
+        // for the morton code, the bits of the (relative) coordinates are interleaved,
+        // starting with the least significant bit of the last dimension;
+        // dimensions that need fewer bits only take part in the lower levels,
+        // so that at most 2^nDim times as many codes as chunks are visited
+        inline void initMorton() {
+            const int nDim = extent_.size();
+            std::vector<int> nBits(nDim, 0);
+            int maxBits = 0;
+            for(int d = 0; d < nDim; ++d) {
+                while((static_cast<size_t>(1) << nBits[d]) < extent_[d]) {
+                    ++nBits[d];
+                }
+                maxBits = std::max(maxBits, nBits[d]);
+            }
+
+            bitDims_.clear();
+            bitPositions_.clear();
+            for(int b = 0; b < maxBits; ++b) {
+                for(int d = nDim - 1; d >= 0; --d) {
+                    if(b < nBits[d]) {
+                        bitDims_.push_back(d);
+                        bitPositions_.push_back(b);
+                    }
+                }
+            }
+            if(bitDims_.size() >= 8 * sizeof(size_t)) {
+                throw std::runtime_error("z5.ChunkRange: range is too large for morton order");
+            }
+        }
+
+        // decode the morton code to chunk coordinates,
+        // returns false if the coordinates are outside of the range
+        inline bool decodeMorton(const size_t code, types::CoordinateType & coord) const {
+            std::fill(coord.begin(), coord.end(), 0);
+            for(size_t b = 0; b < bitDims_.size(); ++b) {
+                coord[bitDims_[b]] |= ((code >> b) & 1) << bitPositions_[b];
+            }
+            for(size_t d = 0; d < coord.size(); ++d) {
+                if(coord[d] >= extent_[d]) {
+                    return false;
+                }
+                coord[d] += minCoords_[d];
+            }
+            return true;
+        }
+
+        types::CoordinateType minCoords_;
+        types::CoordinateType maxCoords_;
+        types::CoordinateType extent_;
+        size_t size_;
+        TraversalOrder order_;
+        // the dimension and the position in the coordinate of each bit of the morton code
+        std::vector<int> bitDims_;
+        std::vector<int> bitPositions_;
+    };
+
+}
+}
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+// instrumentation of the chunk I/O:
+// the counters are only updated if z5 is built with WITH_INSTRUMENTATION,
+// otherwise the macros below expand to nothing and the instrumentation has no cost
+
+#ifdef WITH_INSTRUMENTATION
+// time the rest of the scope (or until Z5_STAGE_STOP) and add it to the counter
+#define Z5_STAGE_TIMER(name, counter) z5::util::StageTimer name(counter)
+#define Z5_STAGE_STOP(name) name.stop()
+// add the value to the counter
+#define Z5_COUNT(counter, value) (counter).fetch_add((value), std::memory_order_relaxed)
+#else
+#define Z5_STAGE_TIMER(name, counter)
+#define Z5_STAGE_STOP(name)
+#define Z5_COUNT(counter, value)
+#endif
+
+namespace z5 {
+namespace util {
+
+    // snapshot of the I/O counters of a dataset, the times are given in seconds
+    struct IoStats {
+        // chunks that were read from / written to the storage
+        size_t chunksRead = 0;
+        size_t chunksWritten = 0;
+        // chunks that don't exist and were filled with the fill value
+        size_t chunksFilled = 0;
+        // bytes of the chunks before and after decompression / compression
+        size_t compressedBytesRead = 0;
+        size_t uncompressedBytesRead = 0;
+        size_t compressedBytesWritten = 0;
+        size_t uncompressedBytesWritten = 0;
+        // accumulated time of the stages, summed over all threads
+        double readTime = 0.;
+        double decompressTime = 0.;
+        double compressTime = 0.;
+        double writeTime = 0.;
+        double copyTime = 0.;
+    };
+
+
+    // thread-safe I/O counters, the times are accumulated in nanoseconds
+    struct IoCounters {
+
+        IoCounters() {
+            reset();
+        }
+
+        inline void reset() {
+            for(auto * counter : {&chunksRead, &chunksWritten, &chunksFilled,
+                                  &compressedBytesRead, &uncompressedBytesRead,
+                                  &compressedBytesWritten, &uncompressedBytesWritten,
+                                  &readNs, &decompressNs, &compressNs, &writeNs, &copyNs}) {
+                counter->store(0, std::memory_order_relaxed);
+            }
+        }
+
+        inline IoStats stats() const {
+            IoStats stats;
+            stats.chunksRead = chunksRead.load(std::memory_order_relaxed);
+            stats.chunksWritten = chunksWritten.load(std::memory_order_relaxed);
+            stats.chunksFilled = chunksFilled.load(std::memory_order_relaxed);
+            stats.compressedBytesRead = compressedBytesRead.load(std::memory_order_relaxed);
+            stats.uncompressedBytesRead = uncompressedBytesRead.load(std::memory_order_relaxed);
+            stats.compressedBytesWritten = compressedBytesWritten.load(std::memory_order_relaxed);
+            stats.uncompressedBytesWritten = uncompressedBytesWritten.load(std::memory_order_relaxed);
+            stats.readTime = readNs.load(std::memory_order_relaxed) * 1e-9;
+            stats.decompressTime = decompressNs.load(std::memory_order_relaxed) * 1e-9;
+            stats.compressTime = compressNs.load(std::memory_order_relaxed) * 1e-9;
+            stats.writeTime = writeNs.load(std::memory_order_relaxed) * 1e-9;
+            stats.copyTime = copyNs.load(std::memory_order_relaxed) * 1e-9;
+            return stats;
+        }
+
+        std::atomic<uint64_t> chunksRead, chunksWritten, chunksFilled;
+        std::atomic<uint64_t> compressedBytesRead, uncompressedBytesRead;
+        std::atomic<uint64_t> compressedBytesWritten, uncompressedBytesWritten;
+        std::atomic<uint64_t> readNs, decompressNs, compressNs, writeNs, copyNs;
+    };
+
+
+    // adds the time between construction and stop() / destruction to a counter
+    class StageTimer {
+
+    public:
+        explicit StageTimer(std::atomic<uint64_t> & counter) :
+            counter_(&counter), begin_(std::chrono::steady_clock::now()) {
+        }
+
+        ~StageTimer() {
+            stop();
+        }
+
+        inline void stop() {
+            if(counter_) {
+                const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now() - begin_
+                ).count();
+                counter_->fetch_add(ns, std::memory_order_relaxed);
+                counter_ = nullptr;
+            }
+        }
+
+        StageTimer(const StageTimer &) = delete;
+        StageTimer & operator=(const StageTimer &) = delete;
+
+    private:
+        std::atomic<uint64_t> * counter_;
+        std::chrono::steady_clock::time_point begin_;
+    };
+
+}
+}
@@ -0,0 +1,158 @@
+#pragma once
+
+#include <algorithm>
+#include <initializer_list>
+#include <iterator>
+#include <ostream>
+#include <type_traits>
+#include <vector>
+
+namespace z5 {
+namespace util {
+
+    // vector with inline storage for up to N elements, so that it does not
+    // allocate for the usual case of few dimensions;
+    // larger sizes are supported by falling back to the heap.
+    // it can be constructed from and converted to std::vector implicitly,
+    // so that it can be used in place of std::vector for coordinates
+    template<typename T, size_t N>
+    class SmallVector {
+
+    public:
+        typedef T value_type;
+        typedef size_t size_type;
+        typedef T & reference;
+        typedef const T & const_reference;
+        typedef T * iterator;
+        typedef const T * const_iterator;
+
+        SmallVector() : size_(0) {
+        }
+
+        explicit SmallVector(const size_t size, const T & value=T()) : size_(0) {
+            resize(size, value);
+        }
+
+        SmallVector(std::initializer_list<T> values) : size_(0) {
+            assign(values.begin(), values.end());
+        }
+
+        template<typename ITER, typename = typename std::enable_if<!std::is_integral<ITER>::value>::type>
+        SmallVector(ITER first, ITER last) : size_(0) {
+            assign(first, last);
+        }
+
+        SmallVector(const std::vector<T> & values) : size_(0) {
+            assign(values.begin(), values.end());
+        }
+
+        SmallVector(const SmallVector & other) : size_(0) {
+            assign(other.begin(), other.end());
+        }
+
+        SmallVector & operator=(const SmallVector & other) {
+            if(this != &other) {
+                assign(other.begin(), other.end());
+            }
+            return *this;
+        }
+
+        SmallVector & operator=(const std::vector<T> & values) {
+            assign(values.begin(), values.end());
+            return *this;
+        }
+
+        operator std::vector<T>() const {
+            return std::vector<T>(begin(), end());
+        }
+
+        template<typename ITER>
+        inline void assign(ITER first, ITER last) {
+            resize(std::distance(first, last));
+            std::copy(first, last, begin());
+        }
+
+        inline void assign(const size_t size, const T & value) {
+            resize(size);
+            std::fill(begin(), end(), value);
+        }
+
+        // new elements are initialized to value
+        inline void resize(const size_t size, const T & value=T()) {
+            if(size > N) {
+                // move to the heap if we are still inline
+                if(size_ <= N) {
+                    heap_.assign(inline_, inline_ + size_);
+                }
+                heap_.resize(size, value);
+            } else {
+                // move back to the inline storage if we are on the heap
+                if(size_ > N) {
+                    std::copy(heap_.begin(), heap_.begin() + size, inline_);
+                    heap_.clear();
+                } else if(size > size_) {
+                    std::fill(inline_ + size_, inline_ + size, value);
+                }
+            }
+            size_ = size;
+        }
+
+        inline void push_back(const T & value) {
+            resize(size_ + 1, value);
+        }
+
+        inline void clear() {
+            resize(0);
+        }
+
+        inline size_t size() const {return size_;}
+        inline bool empty() const {return size_ == 0;}
+        static constexpr size_t inlineCapacity() {return N;}
+
+        inline T * data() {return size_ > N ? heap_.data() : inline_;}
+        inline const T * data() const {return size_ > N ? heap_.data() : inline_;}
+
+        inline iterator begin() {return data();}
+        inline iterator end() {return data() + size_;}
+        inline const_iterator begin() const {return data();}
+        inline const_iterator end() const {return data() + size_;}
+
+        inline T & operator[](const size_t i) {return data()[i];}
+        inline const T & operator[](const size_t i) const {return data()[i];}
+        inline T & front() {return data()[0];}
+        inline const T & front() const {return data()[0];}
+        inline T & back() {return data()[size_ - 1];}
+        inline const T & back() const {return data()[size_ - 1];}
+
+        // comparison operators are friends, so that they also
+        // apply to std::vector via the implicit conversion
+        friend inline bool operator==(const SmallVector & a, const SmallVector & b) {
+            return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin());
+        }
+
+        friend inline bool operator!=(const SmallVector & a, const SmallVector & b) {
+            return !(a == b);
+        }
+
+        friend inline bool operator<(const SmallVector & a, const SmallVector & b) {
+            return std::lexicographical_compare(a.begin(), a.end(), b.begin(), b.end());
+        }
+
+        friend inline std::ostream & operator<<(std::ostream & os, const SmallVector & coord) {
+            os << "Coordinates(";
+            for(const auto & cc: coord) {
+                os << " " << cc;
+            }
+            os << " )";
+            return os;
+        }
+
+    private:
+        size_t size_;
+        T inline_[N];
+        // only used if we have more than N elements
+        std::vector<T> heap_;
+    };
+
+}
+}
@@ -0,0 +1,165 @@
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+#include <type_traits>
+
+#include "z5/types/types.hxx"
+
+namespace z5 {
+namespace util {
+namespace strided_copy_detail {
+
+    // layout of a strided region after merging axes that can be traversed
+    // as one; the innermost axis holds the longest run that is contiguous
+    // in both source and destination (if there is one)
+    struct RegionLayout {
+
+        RegionLayout(const size_t * shape,
+                     const size_t * srcStrides,
+                     const size_t * dstStrides,
+                     const unsigned dim) : empty(false) {
+            for(unsigned d = 0; d < dim; ++d) {
+                if(shape[d] == 0) {
+                    empty = true;
+                    return;
+                }
+                // singleton axes don't matter for the memory layout
+                if(shape[d] == 1) {
+                    continue;
+                }
+                // merge with the previous axis if both arrays can be
+                // traversed along the two axes with a single stride
+                const size_t n = this->shape.size();
+                if(n > 0 && this->srcStrides[n - 1] == srcStrides[d] * shape[d]
+                         && this->dstStrides[n - 1] == dstStrides[d] * shape[d]) {
+                    this->shape[n - 1] *= shape[d];
+                    this->srcStrides[n - 1] = srcStrides[d];
+                    this->dstStrides[n - 1] = dstStrides[d];
+                } else {
+                    this->shape.push_back(shape[d]);
+                    this->srcStrides.push_back(srcStrides[d]);
+                    this->dstStrides.push_back(dstStrides[d]);
+                }
+            }
+            // a region of a single element is a contiguous run of length 1
+            if(this->shape.empty()) {
+                this->shape.push_back(1);
+                this->srcStrides.push_back(1);
+                this->dstStrides.push_back(1);
+            }
+        }
+
+        inline unsigned dimension() const {return shape.size();}
+
+        types::CoordinateType shape, srcStrides, dstStrides;
+        bool empty;
+    };
+
+
+    template<typename T>
+    inline void copyRun(const T * src, T * dst, const size_t len) {
+        if(std::is_trivially_copyable<T>::value) {
+            std::memcpy(dst, src, len * sizeof(T));
+        } else {
+            std::copy(src, src + len, dst);
+        }
+    }
+
+
+    // call f(srcOffset, dstOffset) for every position of the outer axes
+    // (all but the innermost one) of the layout, in C order
+    template<typename F>
+    inline void forEachRun(const RegionLayout & layout, F && f) {
+        const int nOuter = layout.dimension() - 1;
+        if(nOuter == 0) {
+            f(0, 0);
+            return;
+        }
+
+        types::CoordinateType coord(nOuter, 0);
+        size_t srcOffset = 0, dstOffset = 0;
+        while(true) {
+            f(srcOffset, dstOffset);
+
+            // go to the next run
+            int d = nOuter - 1;
+            for(; d >= 0; --d) {
+                srcOffset += layout.srcStrides[d];
+                dstOffset += layout.dstStrides[d];
+                if(++coord[d] < layout.shape[d]) {
+                    break;
+                }
+                srcOffset -= coord[d] * layout.srcStrides[d];
+                dstOffset -= coord[d] * layout.dstStrides[d];
+                coord[d] = 0;
+            }
+            if(d < 0) {
+                break;
+            }
+        }
+    }
+
+}
+
+
+    // copy a strided region of the given shape from src to dst
+    // (strides are given in elements);
+    // axes that are contiguous in both arrays are merged, so every
+    // contiguous run is moved with a single memcpy
+    template<typename T>
+    inline void copyStridedRegion(const T * src, const size_t * srcStrides,
+                                  T * dst, const size_t * dstStrides,
+                                  const size_t * shape, const unsigned dim) {
+        const strided_copy_detail::RegionLayout layout(shape, srcStrides, dstStrides, dim);
+        if(layout.empty) {
+            return;
+        }
+        const unsigned inner = layout.dimension() - 1;
+        const size_t len = layout.shape[inner];
+        const size_t srcStride = layout.srcStrides[inner];
+        const size_t dstStride = layout.dstStrides[inner];
+
+        if(srcStride == 1 && dstStride == 1) {
+            strided_copy_detail::forEachRun(layout, [&](const size_t srcOffset, const size_t dstOffset){
+                strided_copy_detail::copyRun(src + srcOffset, dst + dstOffset, len);
+            });
+        } else {
+            strided_copy_detail::forEachRun(layout, [&](const size_t srcOffset, const size_t dstOffset){
+                const T * srcRun = src + srcOffset;
+                T * dstRun = dst + dstOffset;
+                for(size_t i = 0; i < len; ++i) {
+                    dstRun[i * dstStride] = srcRun[i * srcStride];
+                }
+            });
+        }
+    }
+
+
+    // fill a strided region of the given shape with val
+    template<typename T>
+    inline void fillStridedRegion(T * dst, const size_t * dstStrides,
+                                  const size_t * shape, const unsigned dim,
+                                  const T & val) {
+        const strided_copy_detail::RegionLayout layout(shape, dstStrides, dstStrides, dim);
+        if(layout.empty) {
+            return;
+        }
+        const unsigned inner = layout.dimension() - 1;
+        const size_t len = layout.shape[inner];
+        const size_t dstStride = layout.dstStrides[inner];
+
+        strided_copy_detail::forEachRun(layout, [&](const size_t, const size_t dstOffset){
+            T * dstRun = dst + dstOffset;
+            if(dstStride == 1) {
+                std::fill(dstRun, dstRun + len, val);
+            } else {
+                for(size_t i = 0; i < len; ++i) {
+                    dstRun[i * dstStride] = val;
+                }
+            }
+        });
+    }
+
+}
+}
@@ -0,0 +1,154 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace z5 {
+namespace util {
+
+    // simple thread pool, the tasks are called with the id of the
+    // worker thread they are executed on, so that callers can
+    // keep per-thread state (e.g. chunk buffers)
+    class ThreadPool {
+
+    public:
+
+        // numberOfThreads <= 0 means using all available cores
+        explicit ThreadPool(const int numberOfThreads) : stop_(false) {
+            const int nThreads = (numberOfThreads > 0) ? numberOfThreads :
+                std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+            workers_.reserve(nThreads);
+            for(int tid = 0; tid < nThreads; ++tid) {
+                workers_.emplace_back([this, tid](){
+                    workerFlag() = true;
+                    while(true) {
+                        std::function<void(int)> task;
+                        {
+                            std::unique_lock<std::mutex> lock(mutex_);
+                            condition_.wait(lock, [this](){return stop_ || !tasks_.empty();});
+                            if(stop_ && tasks_.empty()) {
+                                return;
+                            }
+                            task = std::move(tasks_.front());
+                            tasks_.pop();
+                        }
+                        task(tid);
+                    }
+                });
+            }
+        }
+
+        ~ThreadPool() {
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                stop_ = true;
+            }
+            condition_.notify_all();
+            for(auto & worker : workers_) {
+                worker.join();
+            }
+        }
+
+        // enqueue a task that is called as f(threadId);
+        // exceptions thrown by the task are rethrown by the future
+        template<class F>
+        std::future<void> enqueue(F && f) {
+            auto task = std::make_shared<std::packaged_task<void(int)>>(std::forward<F>(f));
+            auto future = task->get_future();
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                if(stop_) {
+                    throw std::runtime_error("z5.ThreadPool: enqueue on stopped pool");
+                }
+                tasks_.emplace([task](const int tid){(*task)(tid);});
+            }
+            condition_.notify_one();
+            return future;
+        }
+
+        inline size_t nThreads() const {
+            return workers_.size();
+        }
+
+        // is the calling thread a worker of any pool?
+        // used to avoid nested parallelism (e.g. multi-threaded
+        // decompression inside of chunk-parallel reads)
+        static inline bool isWorkerThread() {
+            return workerFlag();
+        }
+
+        // delete copy constructor and assignment operator
+        ThreadPool(const ThreadPool &) = delete;
+        ThreadPool & operator=(const ThreadPool &) = delete;
+
+    private:
+        static inline bool & workerFlag() {
+            static thread_local bool flag = false;
+            return flag;
+        }
+
+        std::vector<std::thread> workers_;
+        std::queue<std::function<void(int)>> tasks_;
+        std::mutex mutex_;
+        std::condition_variable condition_;
+        bool stop_;
+    };
+
+
+    // call f(threadId, jobId) for all jobIds in [0, numberOfJobs)
+    // the jobs are distributed dynamically over the threads of the pool
+    template<class F>
+    inline void parallel_foreach(ThreadPool & threadpool, const size_t numberOfJobs, F && f) {
+        std::atomic<size_t> nextJob(0);
+        const size_t nTasks = std::min(threadpool.nThreads(), numberOfJobs);
+        std::vector<std::future<void>> futures;
+        futures.reserve(nTasks);
+        for(size_t t = 0; t < nTasks; ++t) {
+            futures.emplace_back(threadpool.enqueue([&](const int tid){
+                try {
+                    for(size_t job = nextJob++; job < numberOfJobs; job = nextJob++) {
+                        f(tid, job);
+                    }
+                } catch(...) {
+                    // skip the remaining jobs if one of them failed
+                    nextJob = numberOfJobs;
+                    throw;
+                }
+            }));
+        }
+        // wait for all tasks before rethrowing, because they
+        // reference the local job counter
+        for(auto & fut : futures) {
+            fut.wait();
+        }
+        for(auto & fut : futures) {
+            fut.get();
+        }
+    }
+
+
+    // same as above, but with a pool that only lives for this call;
+    // for a single thread the jobs are run in the calling thread
+    template<class F>
+    inline void parallel_foreach(const int numberOfThreads, const size_t numberOfJobs, F && f) {
+        if(numberOfThreads == 1) {
+            for(size_t job = 0; job < numberOfJobs; ++job) {
+                f(0, job);
+            }
+        } else {
+            ThreadPool threadpool(numberOfThreads);
+            parallel_foreach(threadpool, numberOfJobs, std::forward<F>(f));
+        }
+    }
+
+}
+}
@@ -0,0 +1,225 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "z5/types/types.hxx"
+
+// tracing of the chunk pipeline stages (open, read, decompress, byteswap, copy, ...):
+// the events are recorded per thread and can be written in the chrome trace format
+// (to be viewed in chrome://tracing or https://ui.perfetto.dev).
+// tracing is disabled by default and is enabled at runtime via Tracer::instance().enable()
+// or by setting the environment variable Z5_TRACE to the path of the trace file,
+// which is then written at exit. If tracing is disabled, a trace scope only costs
+// a relaxed atomic load.
+// if z5 is built with WITH_USDT, the stages are also exposed as static tracepoints
+// (z5:stage_begin, z5:stage_end) that can be used with perf or bpftrace.
+
+#ifdef WITH_USDT
+#include <sys/sdt.h>
+#define Z5_USDT_PROBE(probe, name) DTRACE_PROBE1(z5, probe, name)
+#else
+#define Z5_USDT_PROBE(probe, name)
+#endif
+
+namespace z5 {
+namespace util {
+
+    struct TraceEvent {
+        const char * name;
+        uint64_t begin;
+        uint64_t end;
+        types::CoordinateType chunkId;
+    };
+
+
+    class Tracer {
+
+    private:
+        // the events of a single thread; the buffers are shared with the tracer,
+        // so that events of threads that have already finished are kept
+        struct ThreadEvents {
+            std::mutex mutex;
+            std::vector<TraceEvent> events;
+            size_t tid;
+        };
+
+    public:
+        static Tracer & instance() {
+            static Tracer tracer;
+            return tracer;
+        }
+
+        inline bool isEnabled() const {
+            return enabled_.load(std::memory_order_relaxed);
+        }
+
+        inline void enable() {
+            enabled_.store(true, std::memory_order_relaxed);
+        }
+
+        inline void disable() {
+            enabled_.store(false, std::memory_order_relaxed);
+        }
+
+        // remove all recorded events
+        inline void clear() {
+            std::lock_guard<std::mutex> lock(mutex_);
+            for(auto & thread : threads_) {
+                std::lock_guard<std::mutex> threadLock(thread->mutex);
+                thread->events.clear();
+            }
+        }
+
+        // nanoseconds since the tracer was created
+        inline uint64_t now() const {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - epoch_
+            ).count();
+        }
+
+        inline void record(const char * name, const uint64_t begin, const uint64_t end,
+                           const types::CoordinateType * chunkId) {
+            auto & thread = threadEvents();
+            std::lock_guard<std::mutex> lock(thread.mutex);
+            thread.events.push_back(TraceEvent{name, begin, end,
+                                               chunkId ? *chunkId : types::CoordinateType()});
+        }
+
+        // get all recorded events together with the (sequential) ids of their threads
+        inline void events(std::vector<TraceEvent> & out, std::vector<size_t> & tids) const {
+            out.clear();
+            tids.clear();
+            std::lock_guard<std::mutex> lock(mutex_);
+            for(const auto & thread : threads_) {
+                std::lock_guard<std::mutex> threadLock(thread->mutex);
+                out.insert(out.end(), thread->events.begin(), thread->events.end());
+                tids.insert(tids.end(), thread->events.size(), thread->tid);
+            }
+        }
+
+        // write the events in the chrome trace event format (complete events, times in microseconds)
+        inline void writeChromeTrace(std::ostream & out) const {
+            std::vector<TraceEvent> traceEvents;
+            std::vector<size_t> tids;
+            events(traceEvents, tids);
+
+            out << "{\"traceEvents\":[";
+            for(size_t i = 0; i < traceEvents.size(); ++i) {
+                const auto & event = traceEvents[i];
+                out << (i > 0 ? ",\n" : "\n")
+                    << "{\"name\":\"" << event.name << "\",\"ph\":\"X\",\"pid\":0,\"tid\":" << tids[i]
+                    << ",\"ts\":" << event.begin / 1000. << ",\"dur\":" << (event.end - event.begin) / 1000.;
+                if(!event.chunkId.empty()) {
+                    out << ",\"args\":{\"chunk\":\"";
+                    for(size_t d = 0; d < event.chunkId.size(); ++d) {
+                        out << (d > 0 ? "." : "") << event.chunkId[d];
+                    }
+                    out << "\"}";
+                }
+                out << "}";
+            }
+            out << "\n],\"displayTimeUnit\":\"ms\"}" << std::endl;
+        }
+
+        inline void writeChromeTrace(const std::string & path) const {
+            std::ofstream out(path);
+            if(!out.is_open()) {
+                throw std::runtime_error("Could not open trace file " + path);
+            }
+            writeChromeTrace(out);
+        }
+
+        Tracer(const Tracer &) = delete;
+        Tracer & operator=(const Tracer &) = delete;
+
+    private:
+        Tracer() : enabled_(false), epoch_(std::chrono::steady_clock::now()) {
+            const char * path = std::getenv("Z5_TRACE");
+            if(path && *path) {
+                path_ = path;
+                enable();
+            }
+        }
+
+        ~Tracer() {
+            if(path_.empty()) {
+                return;
+            }
+            // we must not throw at exit
+            try {
+                writeChromeTrace(path_);
+            } catch(const std::exception &) {}
+        }
+
+        inline ThreadEvents & threadEvents() {
+            static thread_local std::shared_ptr<ThreadEvents> thread;
+            if(!thread) {
+                thread = std::make_shared<ThreadEvents>();
+                std::lock_guard<std::mutex> lock(mutex_);
+                thread->tid = threads_.size();
+                threads_.push_back(thread);
+            }
+            return *thread;
+        }
+
+        std::atomic<bool> enabled_;
+        std::chrono::steady_clock::time_point epoch_;
+        std::string path_;
+        mutable std::mutex mutex_;
+        std::vector<std::shared_ptr<ThreadEvents>> threads_;
+    };
+
+
+    // records an event from construction until stop() / destruction
+    class TraceScope {
+
+    public:
+        explicit TraceScope(const char * name, const types::CoordinateType * chunkId=nullptr) :
+            name_(name), chunkId_(chunkId), running_(true), enabled_(Tracer::instance().isEnabled()) {
+            Z5_USDT_PROBE(stage_begin, name_);
+            if(enabled_) {
+                begin_ = Tracer::instance().now();
+            }
+        }
+
+        TraceScope(const char * name, const types::CoordinateType & chunkId) : TraceScope(name, &chunkId) {
+        }
+
+        ~TraceScope() {
+            stop();
+        }
+
+        inline void stop() {
+            if(!running_) {
+                return;
+            }
+            running_ = false;
+            Z5_USDT_PROBE(stage_end, name_);
+            if(enabled_) {
+                auto & tracer = Tracer::instance();
+                tracer.record(name_, begin_, tracer.now(), chunkId_);
+            }
+        }
+
+        TraceScope(const TraceScope &) = delete;
+        TraceScope & operator=(const TraceScope &) = delete;
+
+    private:
+        const char * name_;
+        const types::CoordinateType * chunkId_;
+        bool running_;
+        bool enabled_;
+        uint64_t begin_;
+    };
+
+}
+}
@@ -3,6 +3,8 @@
 #include <string>
 
 #include "z5/types/types.hxx"
+#include "z5/util/byteswap.hxx"
+#include "z5/util/chunk_range.hxx"
 
 namespace z5 {
 namespace util {
@@ -18,69 +20,18 @@ namespace util {
     }
 
 
-    // FIXME this is relatively ugly...
-    // would be nicer to do this in a dimension independent way
-    void makeRegularGrid(const types::ShapeType & minCoords, const types::ShapeType & maxCoords, std::vector<types::ShapeType> & grid) {
-        size_t nDim = minCoords.size();
-        if(nDim == 1) {
-            for(size_t x = minCoords[0]; x <= maxCoords[0]; ++x) {
-                grid.emplace_back(types::ShapeType({x}));
-            }
-        }
-
-        else if(nDim == 2) {
-            for(size_t x = minCoords[0]; x <= maxCoords[0]; ++x) {
-                for(size_t y = minCoords[1]; y <= maxCoords[1]; ++y) {
-                    grid.emplace_back(types::ShapeType({x, y}));
-                }
-            }
-        }
-
-        else if(nDim == 3) {
-            for(size_t x = minCoords[0]; x <= maxCoords[0]; ++x) {
-                for(size_t y = minCoords[1]; y <= maxCoords[1]; ++y) {
-                    for(size_t z = minCoords[2]; z <= maxCoords[2]; ++z) {
-                        grid.emplace_back(types::ShapeType({x, y, z}));
-                    }
-                }
-            }
-        }
-
-        else if(nDim == 4) {
-            for(size_t x = minCoords[0]; x <= maxCoords[0]; ++x) {
-                for(size_t y = minCoords[1]; y <= maxCoords[1]; ++y) {
-                    for(size_t z = minCoords[2]; z <= maxCoords[2]; ++z) {
-                        for(size_t t = minCoords[3]; t <= maxCoords[3]; ++t) {
-                            grid.emplace_back(types::ShapeType({x, y, z, t}));
-                        }
-                    }
-                }
-            }
-        }
-
-        else if(nDim == 5) {
-            for(size_t x = minCoords[0]; x <= maxCoords[0]; ++x) {
-                for(size_t y = minCoords[1]; y <= maxCoords[1]; ++y) {
-                    for(size_t z = minCoords[2]; z <= maxCoords[2]; ++z) {
-                        for(size_t t = minCoords[3]; t <= maxCoords[3]; ++t) {
-                            for(size_t c = minCoords[4]; t <= maxCoords[4]; ++t) {
-                                grid.emplace_back(types::ShapeType({x, y, z, t, c}));
-                            }
-                        }
-                    }
-                }
-            }
-        }
-
-        else {
-            throw std::runtime_error("More than 5D currently not supported");
-        }
+    // append all coordinates of the (inclusive) grid [minCoords, maxCoords] in c-order
+    // NOTE prefer iterating over a ChunkRange, which does not materialize the grid
+    inline void makeRegularGrid(const types::ShapeType & minCoords, const types::ShapeType & maxCoords, std::vector<types::ShapeType> & grid) {
+        ChunkRange range(minCoords, maxCoords);
+        range.toVector(grid);
     }
 
 
     // TODO in the long run this should be implemented as a filter for iostreams
     // reverse endianness for all values in the iterator range
     // boost endian would be nice, but it doesn't support floats...
+    // NOTE for contiguous data, the vectorized versions in byteswap.hxx are much faster
     template<typename T, typename ITER>
     inline void reverseEndiannessInplace(ITER begin, ITER end) {
         int typeLen = sizeof(T);
@@ -0,0 +1,476 @@
+// micro-benchmark for the compressors:
+// measures compression / decompression throughput and compression ratio
+// for all available codecs on synthetic chunks (random, smooth and sparse labels)
+// and optionally on chunks sampled from an existing dataset.
+// see README.md for the usage.
+
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <random>
+
+#include "z5/dataset_factory.hxx"
+#include "bench_util.hxx"
+
+namespace z5 {
+namespace bench {
+
+    //
+    // codecs
+    //
+
+    struct Codec {
+        std::string name;
+        types::Compressor compressor;
+        std::string codec;
+        int level;
+        int shuffle;
+    };
+
+    inline std::vector<Codec> availableCodecs() {
+        std::vector<Codec> codecs;
+        codecs.push_back({"raw", types::raw, "", 0, 0});
+        codecs.push_back({"compressed_segmentation", types::compressedSegmentation, "", 0, 0});
+        #ifdef WITH_BLOSC
+        codecs.push_back({"blosc-lz4", types::blosc, "lz4", 5, 1});
+        codecs.push_back({"blosc-zstd", types::blosc, "zstd", 5, 1});
+        #endif
+        #ifdef WITH_ZLIB
+        codecs.push_back({"zlib", types::zlib, "zlib", 5, 0});
+        codecs.push_back({"gzip", types::zlib, "gzip", 5, 0});
+        #endif
+        #ifdef WITH_BZIP2
+        codecs.push_back({"bzip2", types::bzip2, "", 5, 0});
+        #endif
+        #ifdef WITH_ZSTD
+        codecs.push_back({"zstd", types::zstd, "", 3, 0});
+        #endif
+        #ifdef WITH_ZFP
+        // reversible mode (the default), so that all codecs are lossless
+        codecs.push_back({"zfp", types::zfp, "", 0, 0});
+        #endif
+        return codecs;
+    }
+
+
+    // make the compressor for the codec and chunk shape;
+    // returns a nullptr if the codec does not support the data type
+    template<typename T>
+    std::unique_ptr<compression::CompressorBase<T>> makeCompressor(const Codec & codec,
+                                                                   const types::ShapeType & chunkShape) {
+        std::unique_ptr<compression::CompressorBase<T>> compressor;
+        DatasetMetadata metadata(types::Datatype::uint8, chunkShape, chunkShape, true, 0,
+                                 codec.compressor, codec.codec, codec.level, codec.shuffle);
+        switch(codec.compressor) {
+            case types::raw:
+                compressor.reset(new compression::RawCompressor<T>()); break;
+            case types::compressedSegmentation:
+                if(std::is_same<T, uint32_t>::value || std::is_same<T, uint64_t>::value) {
+                    compressor.reset(new compression::CompressedSegmentationCompressor<T>(metadata));
+                }
+                break;
+            #ifdef WITH_BLOSC
+            case types::blosc:
+                compressor.reset(new compression::BloscCompressor<T>(metadata)); break;
+            #endif
+            #ifdef WITH_ZLIB
+            case types::zlib:
+                compressor.reset(new compression::ZlibCompressor<T>(metadata)); break;
+            #endif
+            #ifdef WITH_BZIP2
+            case types::bzip2:
+                compressor.reset(new compression::Bzip2Compressor<T>(metadata)); break;
+            #endif
+            #ifdef WITH_ZSTD
+            case types::zstd:
+                compressor.reset(new compression::ZstdCompressor<T>(metadata)); break;
+            #endif
+            #ifdef WITH_ZFP
+            case types::zfp:
+                if(std::is_floating_point<T>::value) {
+                    compressor.reset(new compression::ZfpCompressor<T>(metadata));
+                }
+                break;
+            #endif
+            default: break;
+        }
+        return compressor;
+    }
+
+
+    //
+    // synthetic data
+    //
+
+    // coordinates of the flat index along the last three axes (z, y, x)
+    inline void coordinates3d(size_t index, const types::ShapeType & shape, size_t * coord) {
+        const int dim = shape.size();
+        for(int d = 2; d >= 0; --d) {
+            const int axis = dim - 3 + d;
+            if(axis < 0) {
+                coord[d] = 0;
+                continue;
+            }
+            coord[d] = index % shape[axis];
+            index /= shape[axis];
+        }
+    }
+
+
+    // the largest value of T we use for synthetic data
+    template<typename T>
+    inline double maxValue() {
+        return std::is_floating_point<T>::value ? 1. :
+            std::min(static_cast<double>(std::numeric_limits<T>::max()), 1e9);
+    }
+
+
+    // uniform random data, which is (nearly) incompressible
+    template<typename T>
+    void makeRandom(const types::ShapeType & shape, std::vector<T> & data) {
+        std::mt19937_64 generator(42);
+        std::uniform_real_distribution<double> distr(0., maxValue<T>());
+        for(auto & val : data) {
+            val = static_cast<T>(distr(generator));
+        }
+    }
+
+
+    // smooth data, like an image
+    template<typename T>
+    void makeSmooth(const types::ShapeType & shape, std::vector<T> & data) {
+        std::mt19937_64 generator(42);
+        std::normal_distribution<double> noise(0., 0.01);
+        const double scale = maxValue<T>() / 2.;
+        size_t coord[3];
+        for(size_t i = 0; i < data.size(); ++i) {
+            coordinates3d(i, shape, coord);
+            const double val = (std::sin(coord[0] / 13.) + std::sin(coord[1] / 11.) + std::sin(coord[2] / 7.)) / 3.;
+            data[i] = static_cast<T>(scale * std::max(0., std::min(2., 1. + val + noise(generator))));
+        }
+    }
+
+
+    // sparse labels, like a segmentation: a few piecewise constant objects on background
+    template<typename T>
+    void makeLabels(const types::ShapeType & shape, std::vector<T> & data) {
+        const size_t objectSize = 16;
+        const uint64_t maxLabel = std::is_floating_point<T>::value ? 1000000 :
+            static_cast<uint64_t>(std::min(maxValue<T>(), 1e6));
+        size_t coord[3];
+        for(size_t i = 0; i < data.size(); ++i) {
+            coordinates3d(i, shape, coord);
+            // hash the coordinates of the object grid cell
+            uint64_t h = (coord[0] / objectSize) * 73856093ULL
+                       ^ (coord[1] / objectSize) * 19349663ULL
+                       ^ (coord[2] / objectSize) * 83492791ULL;
+            h = (h ^ (h >> 13)) * 0x9E3779B97F4A7C15ULL;
+            // 70 % of the cells are background
+            data[i] = (h % 10 < 7) ? 0 : static_cast<T>(1 + (h >> 32) % maxLabel);
+        }
+    }
+
+
+    //
+    // benchmark
+    //
+
+    struct Options {
+        std::vector<std::string> dtypes = {"uint8", "uint32", "uint64", "float32"};
+        std::vector<size_t> chunkSizes = {32, 64, 128};
+        std::vector<std::string> codecs;
+        std::string dataset;
+        size_t samples = 16;
+        int repeats = 5;
+        std::string format = "csv";
+        std::string output;
+    };
+
+
+    // benchmark the codec on the chunks and append the result;
+    // the times are the best of all repetitions of (de)compressing all chunks
+    template<typename T>
+    void benchmark(const Codec & codec,
+                   const std::string & dtype,
+                   const std::string & dataName,
+                   const types::ShapeType & chunkShape,
+                   const std::vector<std::vector<T>> & chunks,
+                   const int repeats,
+                   nlohmann::json & results) {
+        auto compressor = makeCompressor<T>(codec, chunkShape);
+        if(!compressor) {
+            return;
+        }
+
+        // compress once to get the compressed chunks
+        size_t nBytes = 0;
+        size_t nCompressed = 0;
+        std::vector<std::vector<char>> compressed(chunks.size());
+        for(size_t c = 0; c < chunks.size(); ++c) {
+            compressed[c].resize(compressor->maxCompressedSize(chunks[c].size()));
+            const size_t n = compressor->compress(chunks[c].data(), chunks[c].size(),
+                                                  compressed[c].data(), compressed[c].size());
+            compressed[c].resize(n);
+            nBytes += chunks[c].size() * sizeof(T);
+            nCompressed += n;
+        }
+
+        std::vector<char> buffer;
+        const double tCompress = bestTime(repeats, [&](){
+            for(const auto & chunk : chunks) {
+                buffer.resize(compressor->maxCompressedSize(chunk.size()));
+                compressor->compress(chunk.data(), chunk.size(), buffer.data(), buffer.size());
+            }
+        });
+
+        std::vector<T> out;
+        const double tDecompress = bestTime(repeats, [&](){
+            for(size_t c = 0; c < chunks.size(); ++c) {
+                out.resize(chunks[c].size());
+                compressor->decompress(compressed[c].data(), compressed[c].size(), out.data(), out.size());
+            }
+        });
+
+        // make sure that we benchmark a correct roundtrip
+        for(size_t c = 0; c < chunks.size(); ++c) {
+            out.resize(chunks[c].size());
+            compressor->decompress(compressed[c].data(), compressed[c].size(), out.data(), out.size());
+            if(!std::equal(out.begin(), out.end(), chunks[c].begin())) {
+                throw std::runtime_error("Roundtrip failed for codec " + codec.name);
+            }
+        }
+
+        const std::string shapeStr = shapeToString(chunkShape);
+
+        nlohmann::json result;
+        result["codec"] = codec.name;
+        result["dtype"] = dtype;
+        result["data"] = dataName;
+        result["chunk_shape"] = shapeStr;
+        result["n_chunks"] = chunks.size();
+        result["bytes"] = nBytes;
+        result["compressed_bytes"] = nCompressed;
+        result["ratio"] = static_cast<double>(nBytes) / nCompressed;
+        result["compress_mbps"] = nBytes / 1e6 / tCompress;
+        result["decompress_mbps"] = nBytes / 1e6 / tDecompress;
+        results.push_back(result);
+        std::cerr << codec.name << " " << dtype << " " << dataName << " " << shapeStr << ": "
+                  << "ratio " << result["ratio"].get<double>() << ", "
+                  << "compress " << result["compress_mbps"].get<double>() << " MB/s, "
+                  << "decompress " << result["decompress_mbps"].get<double>() << " MB/s" << std::endl;
+    }
+
+
+    template<typename T>
+    void benchmarkCodecs(const std::vector<Codec> & codecs,
+                         const std::string & dtype,
+                         const std::string & dataName,
+                         const types::ShapeType & chunkShape,
+                         const std::vector<std::vector<T>> & chunks,
+                         const int repeats,
+                         nlohmann::json & results) {
+        for(const auto & codec : codecs) {
+            benchmark(codec, dtype, dataName, chunkShape, chunks, repeats, results);
+        }
+    }
+
+
+    template<typename T>
+    void benchmarkSynthetic(const std::vector<Codec> & codecs,
+                            const std::string & dtype,
+                            const Options & options,
+                            nlohmann::json & results) {
+        for(const size_t chunkSize : options.chunkSizes) {
+            const types::ShapeType chunkShape(3, chunkSize);
+            std::vector<std::vector<T>> chunks(1, std::vector<T>(chunkSize * chunkSize * chunkSize));
+
+            makeRandom(chunkShape, chunks[0]);
+            benchmarkCodecs(codecs, dtype, "random", chunkShape, chunks, options.repeats, results);
+            makeSmooth(chunkShape, chunks[0]);
+            benchmarkCodecs(codecs, dtype, "smooth", chunkShape, chunks, options.repeats, results);
+            makeLabels(chunkShape, chunks[0]);
+            benchmarkCodecs(codecs, dtype, "labels", chunkShape, chunks, options.repeats, results);
+        }
+    }
+
+
+    // sample up to nSamples existing chunks, evenly spaced over the dataset
+    template<typename T>
+    void benchmarkDataset(const std::vector<Codec> & codecs,
+                          const Dataset & ds,
+                          const Options & options,
+                          nlohmann::json & results) {
+        const auto & chunksPerDim = ds.chunksPerDimension();
+        const size_t nChunks = ds.numberOfChunks();
+        const size_t step = std::max<size_t>(nChunks / options.samples, 1);
+
+        std::vector<std::vector<T>> chunks;
+        types::CoordinateType chunkId(ds.dimension());
+        for(size_t i = 0; i < nChunks && chunks.size() < options.samples; i += step) {
+            size_t index = i;
+            for(int d = ds.dimension() - 1; d >= 0; --d) {
+                chunkId[d] = index % chunksPerDim[d];
+                index /= chunksPerDim[d];
+            }
+            if(!handle::Chunk(ds.handle(), chunkId, ds.isZarr()).exists()) {
+                continue;
+            }
+            chunks.emplace_back(ds.maxChunkSize());
+            ds.readChunk(chunkId, chunks.back().data());
+            chunks.back().resize(ds.getChunkSize(chunkId));
+        }
+        if(chunks.empty()) {
+            throw std::runtime_error("The dataset " + options.dataset + " does not contain any chunks");
+        }
+
+        const std::string dtype = types::dtypeToN5.at(ds.getDtype());
+        benchmarkCodecs(codecs, dtype, "dataset", ds.maxChunkShape(), chunks, options.repeats, results);
+    }
+
+
+    void benchmarkDataset(const std::vector<Codec> & codecs, const Options & options, nlohmann::json & results) {
+        auto ds = openDataset(options.dataset);
+        switch(ds->getDtype()) {
+            case types::int8:
+                benchmarkDataset<int8_t>(codecs, *ds, options, results); break;
+            case types::int16:
+                benchmarkDataset<int16_t>(codecs, *ds, options, results); break;
+            case types::int32:
+                benchmarkDataset<int32_t>(codecs, *ds, options, results); break;
+            case types::int64:
+                benchmarkDataset<int64_t>(codecs, *ds, options, results); break;
+            case types::uint8:
+                benchmarkDataset<uint8_t>(codecs, *ds, options, results); break;
+            case types::uint16:
+                benchmarkDataset<uint16_t>(codecs, *ds, options, results); break;
+            case types::uint32:
+                benchmarkDataset<uint32_t>(codecs, *ds, options, results); break;
+            case types::uint64:
+                benchmarkDataset<uint64_t>(codecs, *ds, options, results); break;
+            case types::float32:
+                benchmarkDataset<float>(codecs, *ds, options, results); break;
+            case types::float64:
+                benchmarkDataset<double>(codecs, *ds, options, results); break;
+        }
+    }
+
+
+    void benchmarkSynthetic(const std::vector<Codec> & codecs, const Options & options, nlohmann::json & results) {
+        for(const auto & dtype : options.dtypes) {
+            switch(types::n5ToDtype.at(dtype)) {
+                case types::int8:
+                    benchmarkSynthetic<int8_t>(codecs, dtype, options, results); break;
+                case types::int16:
+                    benchmarkSynthetic<int16_t>(codecs, dtype, options, results); break;
+                case types::int32:
+                    benchmarkSynthetic<int32_t>(codecs, dtype, options, results); break;
+                case types::int64:
+                    benchmarkSynthetic<int64_t>(codecs, dtype, options, results); break;
+                case types::uint8:
+                    benchmarkSynthetic<uint8_t>(codecs, dtype, options, results); break;
+                case types::uint16:
+                    benchmarkSynthetic<uint16_t>(codecs, dtype, options, results); break;
+                case types::uint32:
+                    benchmarkSynthetic<uint32_t>(codecs, dtype, options, results); break;
+                case types::uint64:
+                    benchmarkSynthetic<uint64_t>(codecs, dtype, options, results); break;
+                case types::float32:
+                    benchmarkSynthetic<float>(codecs, dtype, options, results); break;
+                case types::float64:
+                    benchmarkSynthetic<double>(codecs, dtype, options, results); break;
+            }
+        }
+    }
+
+
+    // columns of the csv output
+    const std::vector<std::string> csvColumns = {
+        "codec", "dtype", "data", "chunk_shape", "n_chunks", "bytes",
+        "compressed_bytes", "ratio", "compress_mbps", "decompress_mbps"
+    };
+
+
+    //
+    // command line
+    //
+
+    void printUsage(const char * name) {
+        std::cerr << "Usage: " << name << " [options]\n"
+                  << "  --dtypes uint8,uint32,...   data types of the synthetic chunks (default: uint8,uint32,uint64,float32)\n"
+                  << "  --chunk-sizes 32,64,...     edge lengths of the cubic synthetic chunks (default: 32,64,128)\n"
+                  << "  --codecs zlib,zstd,...      only benchmark these codecs (default: all available)\n"
+                  << "  --dataset PATH              benchmark on chunks sampled from a zarr / N5 dataset\n"
+                  << "                              instead of synthetic data\n"
+                  << "  --samples N                 number of chunks sampled from the dataset (default: 16)\n"
+                  << "  --repeats N                 number of repetitions, the best time is reported (default: 5)\n"
+                  << "  --format csv|json           output format (default: csv)\n"
+                  << "  --output PATH               write the results to PATH instead of stdout\n";
+    }
+
+
+    bool parseOptions(int argc, char ** argv, Options & options) {
+        for(int i = 1; i < argc; ++i) {
+            const std::string arg = argv[i];
+            if(arg == "-h" || arg == "--help" || i + 1 == argc) {
+                return false;
+            }
+            const std::string val = argv[++i];
+            if(arg == "--dtypes") {
+                options.dtypes = splitList(val);
+            } else if(arg == "--chunk-sizes") {
+                options.chunkSizes = splitNumbers(val);
+            } else if(arg == "--codecs") {
+                options.codecs = splitList(val);
+            } else if(arg == "--dataset") {
+                options.dataset = val;
+            } else if(arg == "--samples") {
+                options.samples = std::stoul(val);
+            } else if(arg == "--repeats") {
+                options.repeats = std::stoi(val);
+            } else if(arg == "--format") {
+                options.format = val;
+            } else if(arg == "--output") {
+                options.output = val;
+            } else {
+                return false;
+            }
+        }
+        return (options.format == "csv" || options.format == "json") && options.repeats > 0 && options.samples > 0;
+    }
+
+}
+}
+
+
+int main(int argc, char ** argv) {
+    using namespace z5::bench;
+
+    Options options;
+    if(!parseOptions(argc, argv, options)) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    std::vector<Codec> codecs;
+    for(const auto & codec : availableCodecs()) {
+        if(options.codecs.empty() ||
+           std::find(options.codecs.begin(), options.codecs.end(), codec.name) != options.codecs.end()) {
+            codecs.push_back(codec);
+        }
+    }
+
+    nlohmann::json results = nlohmann::json::array();
+    if(options.dataset.empty()) {
+        benchmarkSynthetic(codecs, options, results);
+    } else {
+        benchmarkDataset(codecs, options, results);
+    }
+
+    if(options.output.empty()) {
+        writeResults(results, csvColumns, options.format, std::cout);
+    } else {
+        std::ofstream out(options.output);
+        writeResults(results, csvColumns, options.format, out);
+    }
+    return 0;
+}
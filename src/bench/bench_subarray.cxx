@@ -0,0 +1,532 @@
+// end-to-end benchmark for reading and writing subarrays:
+// runs multiarray::readSubarray / writeSubarray and writeScalar with different
+// access patterns on a zarr and a N5 dataset, with cold and warm page cache.
+// see README.md for the usage.
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <numeric>
+#include <random>
+
+#include "z5/dataset_factory.hxx"
+#include "z5/broadcast.hxx"
+#include "z5/multiarray/marray_access.hxx"
+#include "bench_util.hxx"
+
+namespace z5 {
+namespace bench {
+
+    struct Options {
+        types::ShapeType shape = {512, 512, 512};
+        types::ShapeType chunkShape = {64, 64, 64};
+        std::string dtype = "uint8";
+        std::string compressor = "raw";
+        std::string codec;
+        std::vector<std::string> formats = {"zarr", "n5"};
+        std::vector<std::string> caches = {"cold", "warm"};
+        std::vector<std::string> ops = {"read", "write", "scalar"};
+        std::vector<std::string> patterns;
+        size_t requests = 8;
+        int repeats = 3;
+        int threads = 1;
+        bool useMmap = false;
+        size_t prefetchSize = 0;
+        int prefetchThreads = 4;
+        std::string root = "bench_subarray.tmp";
+        bool keep = false;
+        std::string format = "csv";
+        std::string output;
+    };
+
+
+    //
+    // access patterns
+    //
+
+    struct Roi {
+        types::ShapeType offset, shape;
+    };
+
+
+    inline std::vector<std::string> allPatterns(const size_t dim) {
+        std::vector<std::string> patterns = {"aligned", "unaligned"};
+        for(size_t d = 0; d < dim; ++d) {
+            patterns.push_back("slice" + std::to_string(d));
+        }
+        patterns.push_back("crop");
+        patterns.push_back("full");
+        return patterns;
+    }
+
+
+    // make the requests of the pattern; the random positions only depend on the pattern,
+    // so every format, cache mode and operation runs the same requests
+    inline std::vector<Roi> makeRequests(const std::string & pattern, const Options & options) {
+        const auto & shape = options.shape;
+        const auto & chunkShape = options.chunkShape;
+        const size_t dim = shape.size();
+        std::mt19937 generator(std::hash<std::string>()(pattern));
+
+        std::vector<Roi> rois;
+        const size_t nRequests = (pattern == "full") ? 1 : ((pattern == "crop") ? 4 * options.requests : options.requests);
+        for(size_t r = 0; r < nRequests; ++r) {
+            Roi roi;
+            roi.offset.resize(dim);
+            roi.shape.resize(dim);
+            for(size_t d = 0; d < dim; ++d) {
+                size_t roiShape;
+                if(pattern == "aligned") {
+                    // blocks of 2 chunks per axis on the chunk grid
+                    roiShape = std::min(2 * chunkShape[d], shape[d]);
+                } else if(pattern == "unaligned") {
+                    // blocks that cut through 2 - 3 chunks per axis
+                    roiShape = std::min(3 * chunkShape[d] / 2 + 1, shape[d]);
+                } else if(pattern == "crop") {
+                    roiShape = std::max<size_t>(chunkShape[d] / 4, 1);
+                } else if(pattern == "full") {
+                    roiShape = shape[d];
+                } else {
+                    // thin slices along the given axis
+                    roiShape = (pattern == "slice" + std::to_string(d)) ? 1 : shape[d];
+                }
+                roi.shape[d] = roiShape;
+
+                std::uniform_int_distribution<size_t> distr(0, shape[d] - roiShape);
+                roi.offset[d] = distr(generator);
+                if(pattern == "aligned") {
+                    roi.offset[d] -= roi.offset[d] % chunkShape[d];
+                }
+            }
+            rois.push_back(roi);
+        }
+        return rois;
+    }
+
+
+    inline size_t roiSize(const Roi & roi) {
+        return std::accumulate(roi.shape.begin(), roi.shape.end(), size_t(1), std::multiplies<size_t>());
+    }
+
+
+    // fill the data of the roi with a smooth function of the global coordinates
+    template<typename T>
+    void makeData(const Roi & roi, andres::Marray<T> & data) {
+        const size_t dim = roi.shape.size();
+        data.resize(roi.shape.begin(), roi.shape.end());
+        std::vector<size_t> coord(dim, 0);
+        for(auto it = data.begin(); it != data.end(); ++it) {
+            double val = 0.;
+            for(size_t d = 0; d < dim; ++d) {
+                val += std::sin((roi.offset[d] + coord[d]) / (7. + 4. * d));
+            }
+            *it = static_cast<T>(50. * (val / dim + 1.));
+            for(int d = dim - 1; d >= 0; --d) {
+                if(++coord[d] < roi.shape[d]) {
+                    break;
+                }
+                coord[d] = 0;
+            }
+        }
+    }
+
+
+    //
+    // page cache
+    //
+
+    // evict the files of the dataset from the page cache;
+    // unlike dropping all caches (echo 3 > /proc/sys/vm/drop_caches) this doesn't need root
+    inline void evictFromPageCache(const std::string & path) {
+        for(fs::recursive_directory_iterator it(path), end; it != end; ++it) {
+            if(!fs::is_regular_file(it->path())) {
+                continue;
+            }
+            const int fd = ::open(it->path().string().c_str(), O_RDONLY);
+            if(fd < 0) {
+                continue;
+            }
+            // dirty pages can't be evicted
+            ::fdatasync(fd);
+            ::posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+            ::close(fd);
+        }
+    }
+
+
+    // for a cold start, we also clear the chunk cache of the dataset (if it has one)
+    inline void prepareCache(Dataset & ds, const std::string & path, const bool cold) {
+        if(cold) {
+            ds.clearCache();
+            evictFromPageCache(path);
+        }
+    }
+
+
+    //
+    // benchmark
+    //
+
+    // time split of reading the chunks of a request, measured per chunk in a separate single-threaded pass:
+    // file I/O is reading the chunk file, decompression is the time of Dataset::readChunk minus
+    // reading the (now cached) file again and copy is copying the chunk / request overlap
+    struct ReadProfile {
+        std::vector<double> latencies;
+        double io = 0.;
+        double decompress = 0.;
+        double copy = 0.;
+        size_t nChunks = 0;
+    };
+
+
+    inline double readFile(const fs::path & path, std::vector<char> & buffer) {
+        const auto t0 = Clock::now();
+        std::ifstream file(path.string(), std::ios::binary);
+        if(!file) {
+            return 0.;
+        }
+        file.seekg(0, std::ios::end);
+        buffer.resize(file.tellg());
+        file.seekg(0, std::ios::beg);
+        file.read(buffer.data(), buffer.size());
+        return secondsSince(t0);
+    }
+
+
+    template<typename T>
+    void profileRead(Dataset & ds, const Roi & roi, const std::string & path, const bool cold, ReadProfile & profile) {
+        prepareCache(ds, path, cold);
+
+        const types::CoordinateType offset(roi.offset.begin(), roi.offset.end());
+        const types::CoordinateType shape(roi.shape.begin(), roi.shape.end());
+        andres::Marray<T> out(andres::SkipInitialization, roi.shape.begin(), roi.shape.end());
+        std::vector<T> buffer(ds.maxChunkSize());
+        std::vector<char> fileBuffer;
+
+        const int dim = ds.dimension();
+        types::CoordinateType localOffset, localShape, inChunkOffset, chunkShape;
+        std::vector<size_t> outStrides(dim), chunkStrides(dim);
+        util::ChunkRange chunkRange;
+        ds.getChunkRange(offset, shape, chunkRange);
+        for(const auto & chunkId : chunkRange) {
+            const fs::path chunkPath = handle::Chunk(ds.handle(), chunkId, ds.isZarr()).path();
+            const double tIo = readFile(chunkPath, fileBuffer);
+            const double tCached = readFile(chunkPath, fileBuffer);
+
+            auto t0 = Clock::now();
+            ds.readChunk(chunkId, buffer.data());
+            const double tRead = secondsSince(t0);
+
+            t0 = Clock::now();
+            ds.getCoordinatesInRequest(chunkId, offset, shape, localOffset, localShape, inChunkOffset);
+            ds.getChunkShape(chunkId, chunkShape);
+            size_t outPos = 0, chunkPos = 0;
+            for(int d = dim - 1; d >= 0; --d) {
+                outStrides[d] = (d == dim - 1) ? 1 : outStrides[d + 1] * shape[d + 1];
+                chunkStrides[d] = (d == dim - 1) ? 1 : chunkStrides[d + 1] * chunkShape[d + 1];
+                outPos += localOffset[d] * outStrides[d];
+                chunkPos += inChunkOffset[d] * chunkStrides[d];
+            }
+            util::copyStridedRegion(buffer.data() + chunkPos, chunkStrides.data(),
+                                    &out(0) + outPos, outStrides.data(),
+                                    localShape.data(), dim);
+            const double tCopy = secondsSince(t0);
+
+            const double tDecompress = std::max(tRead - tCached, 0.);
+            profile.io += tIo;
+            profile.decompress += tDecompress;
+            profile.copy += tCopy;
+            profile.latencies.push_back(tIo + tDecompress + tCopy);
+            ++profile.nChunks;
+        }
+    }
+
+
+    template<typename T>
+    void runRequest(const Dataset & ds, const std::string & op, const Roi & roi,
+                    andres::Marray<T> & data, const Options & options) {
+        if(op == "read") {
+            multiarray::readSubarray<T>(ds, data, roi.offset.begin(), options.threads);
+        } else if(op == "write") {
+            multiarray::writeSubarray<T>(ds, data, roi.offset.begin(), options.threads);
+        } else {
+            writeScalar<T>(ds, roi.offset.begin(), roi.shape.begin(), T(42));
+        }
+    }
+
+
+    // benchmark all requests of the pattern; the time of a repetition is the sum over the requests,
+    // where the page cache is prepared before every request, and we keep the best repetition
+    template<typename T>
+    void benchmarkPattern(Dataset & ds,
+                          const std::string & path,
+                          const std::string & format,
+                          const std::string & cache,
+                          const std::string & op,
+                          const std::string & pattern,
+                          const Options & options,
+                          nlohmann::json & results) {
+        const bool cold = cache == "cold";
+        const auto rois = makeRequests(pattern, options);
+
+        // the data to write or the out arrays to read to
+        std::vector<andres::Marray<T>> data(rois.size());
+        size_t nBytes = 0;
+        size_t nChunks = 0;
+        for(size_t r = 0; r < rois.size(); ++r) {
+            if(op == "write") {
+                makeData(rois[r], data[r]);
+            } else if(op == "read") {
+                data[r].resize(andres::SkipInitialization, rois[r].shape.begin(), rois[r].shape.end());
+            }
+            nBytes += roiSize(rois[r]) * sizeof(T);
+            util::ChunkRange chunkRange;
+            ds.getChunkRange(types::CoordinateType(rois[r].offset.begin(), rois[r].offset.end()),
+                             types::CoordinateType(rois[r].shape.begin(), rois[r].shape.end()),
+                             chunkRange);
+            nChunks += chunkRange.size();
+        }
+
+        double best = std::numeric_limits<double>::max();
+        for(int rep = 0; rep < options.repeats; ++rep) {
+            double t = 0.;
+            for(size_t r = 0; r < rois.size(); ++r) {
+                prepareCache(ds, path, cold);
+                const auto t0 = Clock::now();
+                runRequest(ds, op, rois[r], data[r], options);
+                t += secondsSince(t0);
+            }
+            best = std::min(best, t);
+        }
+
+        nlohmann::json result;
+        result["format"] = format;
+        result["cache"] = cache;
+        result["op"] = op;
+        result["pattern"] = pattern;
+        result["threads"] = options.threads;
+        result["n_requests"] = rois.size();
+        result["n_chunks"] = nChunks;
+        result["bytes"] = nBytes;
+        result["time_s"] = best;
+        result["throughput_mbps"] = nBytes / 1e6 / best;
+
+        if(op == "read") {
+            ReadProfile profile;
+            for(const auto & roi : rois) {
+                profileRead<T>(ds, roi, path, cold, profile);
+            }
+            result["latency_p50_ms"] = 1e3 * percentile(profile.latencies, 50);
+            result["latency_p90_ms"] = 1e3 * percentile(profile.latencies, 90);
+            result["latency_p99_ms"] = 1e3 * percentile(profile.latencies, 99);
+            result["latency_max_ms"] = 1e3 * percentile(profile.latencies, 100);
+            const double total = profile.io + profile.decompress + profile.copy;
+            result["io_fraction"] = total > 0 ? profile.io / total : 0.;
+            result["decompress_fraction"] = total > 0 ? profile.decompress / total : 0.;
+            result["copy_fraction"] = total > 0 ? profile.copy / total : 0.;
+        }
+
+        results.push_back(result);
+        std::cerr << format << " " << cache << " " << op << " " << pattern << ": "
+                  << result["throughput_mbps"].get<double>() << " MB/s" << std::endl;
+    }
+
+
+    template<typename T>
+    void benchmarkFormat(const std::string & format, const Options & options, nlohmann::json & results) {
+        const bool isZarr = format == "zarr";
+        const std::string path = (fs::path(options.root) / ("data." + format)).string();
+        if(fs::exists(path)) {
+            fs::remove_all(path);
+        }
+        std::string codec = options.codec;
+        if(codec.empty()) {
+            codec = (options.compressor == "zlib") ? "gzip" : "lz4";
+        }
+        auto ds = createDataset(path, options.dtype, options.shape, options.chunkShape, isZarr,
+                                0, options.compressor, codec);
+        ds->setUseMmap(options.useMmap);
+        ds->setPrefetchSize(options.prefetchSize);
+        ds->setPrefetchThreads(options.prefetchThreads);
+
+        // fill the dataset in slabs of one chunk along the first axis
+        Roi slab;
+        slab.offset.assign(options.shape.size(), 0);
+        slab.shape = options.shape;
+        for(size_t begin = 0; begin < options.shape[0]; begin += options.chunkShape[0]) {
+            slab.offset[0] = begin;
+            slab.shape[0] = std::min(options.chunkShape[0], options.shape[0] - begin);
+            andres::Marray<T> data;
+            makeData(slab, data);
+            multiarray::writeSubarray<T>(*ds, data, slab.offset.begin(), options.threads);
+        }
+
+        const auto patterns = options.patterns.empty() ? allPatterns(options.shape.size()) : options.patterns;
+        // we run the writes last, so that the reads see the initial data
+        for(const auto & op : {"read", "write", "scalar"}) {
+            if(std::find(options.ops.begin(), options.ops.end(), op) == options.ops.end()) {
+                continue;
+            }
+            for(const auto & cache : options.caches) {
+                for(const auto & pattern : patterns) {
+                    benchmarkPattern<T>(*ds, path, format, cache, op, pattern, options, results);
+                }
+            }
+        }
+
+        if(!options.keep) {
+            fs::remove_all(path);
+        }
+    }
+
+
+    template<typename T>
+    void benchmark(const Options & options, nlohmann::json & results) {
+        for(const auto & format : options.formats) {
+            benchmarkFormat<T>(format, options, results);
+        }
+    }
+
+
+    // columns of the csv output
+    const std::vector<std::string> csvColumns = {
+        "format", "cache", "op", "pattern", "threads", "n_requests", "n_chunks", "bytes", "time_s",
+        "throughput_mbps", "latency_p50_ms", "latency_p90_ms", "latency_p99_ms", "latency_max_ms",
+        "io_fraction", "decompress_fraction", "copy_fraction"
+    };
+
+
+    //
+    // command line
+    //
+
+    void printUsage(const char * name) {
+        std::cerr << "Usage: " << name << " [options]\n"
+                  << "  --shape 512,512,512         shape of the dataset (default: 512,512,512)\n"
+                  << "  --chunk-shape 64,64,64      chunk shape of the dataset (default: 64,64,64)\n"
+                  << "  --dtype uint8               data type of the dataset (default: uint8)\n"
+                  << "  --compressor raw            compressor of the dataset (default: raw)\n"
+                  << "  --codec CODEC               codec of the compressor (default: lz4 for blosc, gzip for zlib)\n"
+                  << "  --formats zarr,n5           dataset formats (default: zarr,n5)\n"
+                  << "  --caches cold,warm          page cache states (default: cold,warm)\n"
+                  << "  --ops read,write,scalar     operations: readSubarray, writeSubarray and writeScalar\n"
+                  << "                              (default: all)\n"
+                  << "  --patterns aligned,...      access patterns: aligned, unaligned, slice0, slice1, ...,\n"
+                  << "                              crop and full (default: all)\n"
+                  << "  --requests N                number of requests per pattern (default: 8, crop uses 4 * N)\n"
+                  << "  --repeats N                 number of repetitions, the best time is reported (default: 3)\n"
+                  << "  --threads N                 number of threads for readSubarray / writeSubarray (default: 1)\n"
+                  << "  --mmap 0|1                  read the chunks memory mapped (default: 0)\n"
+                  << "  --prefetch-size BYTES       budget for the chunks that readSubarray reads ahead (default: 0, disabled)\n"
+                  << "  --prefetch-threads N        number of threads that read the chunks ahead (default: 4)\n"
+                  << "  --root PATH                 directory for the datasets (default: bench_subarray.tmp)\n"
+                  << "  --keep 0|1                  keep the datasets (default: 0)\n"
+                  << "  --format csv|json           output format (default: csv)\n"
+                  << "  --output PATH               write the results to PATH instead of stdout\n";
+    }
+
+
+    bool parseOptions(int argc, char ** argv, Options & options) {
+        for(int i = 1; i < argc; ++i) {
+            const std::string arg = argv[i];
+            if(arg == "-h" || arg == "--help" || i + 1 == argc) {
+                return false;
+            }
+            const std::string val = argv[++i];
+            if(arg == "--shape") {
+                const auto shape = splitNumbers(val);
+                options.shape.assign(shape.begin(), shape.end());
+            } else if(arg == "--chunk-shape") {
+                const auto chunkShape = splitNumbers(val);
+                options.chunkShape.assign(chunkShape.begin(), chunkShape.end());
+            } else if(arg == "--dtype") {
+                options.dtype = val;
+            } else if(arg == "--compressor") {
+                options.compressor = val;
+            } else if(arg == "--codec") {
+                options.codec = val;
+            } else if(arg == "--formats") {
+                options.formats = splitList(val);
+            } else if(arg == "--caches") {
+                options.caches = splitList(val);
+            } else if(arg == "--ops") {
+                options.ops = splitList(val);
+            } else if(arg == "--patterns") {
+                options.patterns = splitList(val);
+            } else if(arg == "--requests") {
+                options.requests = std::stoul(val);
+            } else if(arg == "--repeats") {
+                options.repeats = std::stoi(val);
+            } else if(arg == "--threads") {
+                options.threads = std::stoi(val);
+            } else if(arg == "--mmap") {
+                options.useMmap = std::stoi(val) != 0;
+            } else if(arg == "--prefetch-size") {
+                options.prefetchSize = std::stoul(val);
+            } else if(arg == "--prefetch-threads") {
+                options.prefetchThreads = std::stoi(val);
+            } else if(arg == "--root") {
+                options.root = val;
+            } else if(arg == "--keep") {
+                options.keep = std::stoi(val) != 0;
+            } else if(arg == "--format") {
+                options.format = val;
+            } else if(arg == "--output") {
+                options.output = val;
+            } else {
+                return false;
+            }
+        }
+        return (options.format == "csv" || options.format == "json") && options.repeats > 0
+            && !options.shape.empty() && options.shape.size() == options.chunkShape.size();
+    }
+
+}
+}
+
+
+int main(int argc, char ** argv) {
+    using namespace z5::bench;
+
+    Options options;
+    if(!parseOptions(argc, argv, options)) {
+        printUsage(argv[0]);
+        return 1;
+    }
+    fs::create_directories(options.root);
+
+    nlohmann::json results = nlohmann::json::array();
+    switch(z5::types::n5ToDtype.at(options.dtype)) {
+        case z5::types::int8:
+            benchmark<int8_t>(options, results); break;
+        case z5::types::int16:
+            benchmark<int16_t>(options, results); break;
+        case z5::types::int32:
+            benchmark<int32_t>(options, results); break;
+        case z5::types::int64:
+            benchmark<int64_t>(options, results); break;
+        case z5::types::uint8:
+            benchmark<uint8_t>(options, results); break;
+        case z5::types::uint16:
+            benchmark<uint16_t>(options, results); break;
+        case z5::types::uint32:
+            benchmark<uint32_t>(options, results); break;
+        case z5::types::uint64:
+            benchmark<uint64_t>(options, results); break;
+        case z5::types::float32:
+            benchmark<float>(options, results); break;
+        case z5::types::float64:
+            benchmark<double>(options, results); break;
+    }
+
+    if(options.output.empty()) {
+        writeResults(results, csvColumns, options.format, std::cout);
+    } else {
+        std::ofstream out(options.output);
+        writeResults(results, csvColumns, options.format, out);
+    }
+    return 0;
+}
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <limits>
+#include <sstream>
+
+#include "json.hpp"
+
+// helper functions shared by the benchmarks
+
+namespace z5 {
+namespace bench {
+
+    typedef std::chrono::high_resolution_clock Clock;
+
+    inline double secondsSince(const Clock::time_point & t0) {
+        const std::chrono::duration<double> t = Clock::now() - t0;
+        return t.count();
+    }
+
+
+    // best time of repeats calls of f
+    template<typename F>
+    inline double bestTime(const int repeats, F && f) {
+        double best = std::numeric_limits<double>::max();
+        for(int r = 0; r < repeats; ++r) {
+            const auto t0 = Clock::now();
+            f();
+            best = std::min(best, secondsSince(t0));
+        }
+        return best;
+    }
+
+
+    // percentile (in [0, 100]) of the values, which are sorted inplace
+    inline double percentile(std::vector<double> & values, const double p) {
+        if(values.empty()) {
+            return 0.;
+        }
+        std::sort(values.begin(), values.end());
+        const size_t index = static_cast<size_t>(p / 100. * (values.size() - 1) + .5);
+        return values[std::min(index, values.size() - 1)];
+    }
+
+
+    template<typename SHAPE>
+    inline std::string shapeToString(const SHAPE & shape) {
+        std::ostringstream oss;
+        for(size_t d = 0; d < shape.size(); ++d) {
+            oss << (d > 0 ? "x" : "") << shape[d];
+        }
+        return oss.str();
+    }
+
+
+    inline std::vector<std::string> splitList(const std::string & str) {
+        std::vector<std::string> items;
+        std::istringstream iss(str);
+        std::string item;
+        while(std::getline(iss, item, ',')) {
+            if(!item.empty()) {
+                items.push_back(item);
+            }
+        }
+        return items;
+    }
+
+
+    inline std::vector<size_t> splitNumbers(const std::string & str) {
+        std::vector<size_t> numbers;
+        for(const auto & item : splitList(str)) {
+            numbers.push_back(std::stoul(item));
+        }
+        return numbers;
+    }
+
+
+    // write the results (an array of flat json objects) as json or as csv with the given columns;
+    // values that are missing in a result are left empty in the csv
+    inline void writeResults(const nlohmann::json & results,
+                             const std::vector<std::string> & columns,
+                             const std::string & format,
+                             std::ostream & out) {
+        if(format == "json") {
+            out << results.dump(4) << std::endl;
+            return;
+        }
+        for(size_t i = 0; i < columns.size(); ++i) {
+            out << (i > 0 ? "," : "") << columns[i];
+        }
+        out << std::endl;
+        for(const auto & result : results) {
+            for(size_t i = 0; i < columns.size(); ++i) {
+                out << (i > 0 ? "," : "");
+                auto it = result.find(columns[i]);
+                if(it == result.end() || it->is_null()) {
+                    continue;
+                }
+                if(it->is_string()) {
+                    out << it->get<std::string>();
+                } else {
+                    out << *it;
+                }
+            }
+            out << std::endl;
+        }
+    }
+
+}
+}
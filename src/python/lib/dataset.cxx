@@ -12,202 +12,60 @@
 
 namespace z5 {
 
-    void exportDataset(py::module & module) {
-
-        auto dsClass = py::class_<Dataset>(module, "DatasetImpl");
-
-        // TODO do we really need to provide read / write for all datatypes ? / is there a way to
-        // do the dtype inference at runtime
-        // TODO export chunk access ?
+    template<class T>
+    void exportIoT(py::class_<Dataset> & dsClass) {
         dsClass
-
-            //
-            // writers
-            //
-            // int8
-            .def("write_subarray", [](
-                const Dataset & ds,
-                const andres::PyView<int8_t> in,
-                const std::vector<size_t> & roiBegin
-            ){
-                py::gil_scoped_release allowThreads;
-                multiarray::writeSubarray(ds, in, roiBegin.begin());
-            })
-            // int16
-            .def("write_subarray", [](
-                const Dataset & ds,
-                const andres::PyView<int16_t> in,
-                const std::vector<size_t> & roiBegin
-            ){
-                py::gil_scoped_release allowThreads;
-                multiarray::writeSubarray(ds, in, roiBegin.begin());
-            })
-            // int32
-            .def("write_subarray", [](
-                const Dataset & ds,
-                const andres::PyView<int32_t> in,
-                const std::vector<size_t> & roiBegin
-            ){
-                py::gil_scoped_release allowThreads;
-                multiarray::writeSubarray(ds, in, roiBegin.begin());
-            })
-            // int64
-            .def("write_subarray", [](
-                const Dataset & ds,
-                const andres::PyView<int64_t> in,
-                const std::vector<size_t> & roiBegin
-            ){
-                py::gil_scoped_release allowThreads;
-                multiarray::writeSubarray(ds, in, roiBegin.begin());
-            })
-            // uint8
-            .def("write_subarray", [](
-                const Dataset & ds,
-                const andres::PyView<uint8_t> in,
-                const std::vector<size_t> & roiBegin
-            ){
-                py::gil_scoped_release allowThreads;
-                multiarray::writeSubarray(ds, in, roiBegin.begin());
-            })
-            // uint16
+            // writer
             .def("write_subarray", [](
                 const Dataset & ds,
-                const andres::PyView<uint16_t> in,
-                const std::vector<size_t> & roiBegin
-            ){
-                py::gil_scoped_release allowThreads;
-                multiarray::writeSubarray(ds, in, roiBegin.begin());
-            })
-            // uint32
-            .def("write_subarray", [](
-                const Dataset & ds,
-                const andres::PyView<uint32_t> in,
-                const std::vector<size_t> & roiBegin
-            ){
-                py::gil_scoped_release allowThreads;
-                multiarray::writeSubarray(ds, in, roiBegin.begin());
-            })
-            // uint64
-            .def("write_subarray", [](
-                const Dataset & ds,
-                const andres::PyView<uint64_t> in,
-                const std::vector<size_t> & roiBegin
-            ){
-                py::gil_scoped_release allowThreads;
-                multiarray::writeSubarray(ds, in, roiBegin.begin());
-            })
-            // float32
-            .def("write_subarray", [](
-                const Dataset & ds,
-                const andres::PyView<float> in,
-                const std::vector<size_t> & roiBegin
-            ){
-                py::gil_scoped_release allowThreads;
-                multiarray::writeSubarray(ds, in, roiBegin.begin());
-            })
-            // float64
-            .def("write_subarray", [](
-                const Dataset & ds,
-                const andres::PyView<double> in,
-                const std::vector<size_t> & roiBegin
-            ){
-                py::gil_scoped_release allowThreads;
-                multiarray::writeSubarray(ds, in, roiBegin.begin());
-            })
-
-            //
-            // readers
-            //
-            // int 8
-            .def("read_subarray", [](
-                const Dataset & ds,
-                andres::PyView<int8_t> out,
-                const std::vector<size_t> & roiBegin
-            ){
-                py::gil_scoped_release allowThreads;
-                multiarray::readSubarray(ds, out, roiBegin.begin());
-            })
-            // int 16
-            .def("read_subarray", [](
-                const Dataset & ds,
-                andres::PyView<int16_t> out,
-                const std::vector<size_t> & roiBegin
-            ){
-                py::gil_scoped_release allowThreads;
-                multiarray::readSubarray(ds, out, roiBegin.begin());
-            })
-            // int 32
-            .def("read_subarray", [](
-                const Dataset & ds,
-                andres::PyView<int32_t> out,
-                const std::vector<size_t> & roiBegin
-            ){
-                py::gil_scoped_release allowThreads;
-                multiarray::readSubarray(ds, out, roiBegin.begin());
-            })
-            // int 64
-            .def("read_subarray", [](
-                const Dataset & ds,
-                andres::PyView<int64_t> out,
-                const std::vector<size_t> & roiBegin
-            ){
-                py::gil_scoped_release allowThreads;
-                multiarray::readSubarray(ds, out, roiBegin.begin());
-            })
-            // uint 8
-            .def("read_subarray", [](
-                const Dataset & ds,
-                andres::PyView<uint8_t> out,
-                const std::vector<size_t> & roiBegin
-            ){
-                py::gil_scoped_release allowThreads;
-                multiarray::readSubarray(ds, out, roiBegin.begin());
-            })
-            // uint 16
-            .def("read_subarray", [](
-                const Dataset & ds,
-                andres::PyView<uint16_t> out,
-                const std::vector<size_t> & roiBegin
-            ){
-                py::gil_scoped_release allowThreads;
-                multiarray::readSubarray(ds, out, roiBegin.begin());
-            })
-            // uint 32
-            .def("read_subarray", [](
-                const Dataset & ds,
-                andres::PyView<uint32_t> out,
-                const std::vector<size_t> & roiBegin
-            ){
-                py::gil_scoped_release allowThreads;
-                multiarray::readSubarray(ds, out, roiBegin.begin());
-            })
-            // uint 64
-            .def("read_subarray", [](
-                const Dataset & ds,
-                andres::PyView<uint64_t> out,
-                const std::vector<size_t> & roiBegin
-            ){
-                py::gil_scoped_release allowThreads;
-                multiarray::readSubarray(ds, out, roiBegin.begin());
-            })
-            // float 32
-            .def("read_subarray", [](
-                const Dataset & ds,
-                andres::PyView<float> out,
-                const std::vector<size_t> & roiBegin
+                const andres::PyView<T> in,
+                const std::vector<size_t> & roiBegin,
+                const int numberOfThreads
             ){
                 py::gil_scoped_release allowThreads;
-                multiarray::readSubarray(ds, out, roiBegin.begin());
-            })
-            // flat 64
+                multiarray::writeSubarray(ds, in, roiBegin.begin(), numberOfThreads);
+            },
+            py::arg("in"), py::arg("roi_begin"), py::arg("n_threads")=1
+            )
+            // reader
             .def("read_subarray", [](
                 const Dataset & ds,
-                andres::PyView<double> out,
-                const std::vector<size_t> & roiBegin
+                andres::PyView<T> out,
+                const std::vector<size_t> & roiBegin,
+                const int numberOfThreads
             ){
                 py::gil_scoped_release allowThreads;
-                multiarray::readSubarray(ds, out, roiBegin.begin());
-            })
+                multiarray::readSubarray(ds, out, roiBegin.begin(), numberOfThreads);
+            },
+            py::arg("out"), py::arg("roi_begin"), py::arg("n_threads")=1
+            )
+        ;
+    }
+
+
+    void exportDataset(py::module & module) {
+
+        auto dsClass = py::class_<Dataset>(module, "DatasetImpl");
+
+        // TODO do we really need to provide read / write for all datatypes ? / is there a way to
+        // do the dtype inference at runtime
+        // TODO export chunk access ?
+
+        //
+        // readers and writers
+        //
+        exportIoT<int8_t>(dsClass);
+        exportIoT<int16_t>(dsClass);
+        exportIoT<int32_t>(dsClass);
+        exportIoT<int64_t>(dsClass);
+        exportIoT<uint8_t>(dsClass);
+        exportIoT<uint16_t>(dsClass);
+        exportIoT<uint32_t>(dsClass);
+        exportIoT<uint64_t>(dsClass);
+        exportIoT<float>(dsClass);
+        exportIoT<double>(dsClass);
+
+        dsClass
 
             //
             // scalar broadcsting
@@ -243,6 +101,59 @@ namespace z5 {
             .def_property_readonly("dtype", [](const Dataset & ds){return types::dtypeToN5[ds.getDtype()];})
             .def_property_readonly("is_zarr", [](const Dataset & ds){return ds.isZarr();})
 
+            //
+            // chunk cache
+            //
+            .def("set_cache_size", [](Dataset & ds, const size_t maxBytes){ds.setCacheSize(maxBytes);})
+            .def_property_readonly("cache_size", [](const Dataset & ds){return ds.cacheSize();})
+            .def("clear_cache", [](Dataset & ds){ds.clearCache();})
+            .def("cache_statistics", [](const Dataset & ds){
+                return std::make_pair(ds.cacheHits(), ds.cacheMisses());
+            })
+            .def("reset_cache_statistics", [](Dataset & ds){ds.resetCacheCounters();})
+
+            //
+            // io statistics
+            //
+            .def("io_statistics", [](const Dataset & ds){
+                const auto stats = ds.ioStats();
+                py::dict ret;
+                ret["chunks_read"] = stats.chunksRead;
+                ret["chunks_written"] = stats.chunksWritten;
+                ret["chunks_filled"] = stats.chunksFilled;
+                ret["compressed_bytes_read"] = stats.compressedBytesRead;
+                ret["uncompressed_bytes_read"] = stats.uncompressedBytesRead;
+                ret["compressed_bytes_written"] = stats.compressedBytesWritten;
+                ret["uncompressed_bytes_written"] = stats.uncompressedBytesWritten;
+                ret["read_time"] = stats.readTime;
+                ret["decompress_time"] = stats.decompressTime;
+                ret["compress_time"] = stats.compressTime;
+                ret["write_time"] = stats.writeTime;
+                ret["copy_time"] = stats.copyTime;
+                return ret;
+            })
+            .def("reset_io_statistics", [](Dataset & ds){ds.resetIoStats();})
+
+            //
+            // memory mapped reads
+            //
+            .def("set_use_mmap", [](Dataset & ds, const bool useMmap){ds.setUseMmap(useMmap);})
+            .def_property_readonly("use_mmap", [](const Dataset & ds){return ds.useMmap();})
+
+            //
+            // compressor threads
+            //
+            .def("set_compressor_threads", [](Dataset & ds, const int nThreads){ds.setCompressorThreads(nThreads);})
+            .def_property_readonly("compressor_threads", [](const Dataset & ds){return ds.compressorThreads();})
+
+            //
+            // chunk prefetching
+            //
+            .def("set_prefetch_size", [](Dataset & ds, const size_t maxBytes){ds.setPrefetchSize(maxBytes);})
+            .def_property_readonly("prefetch_size", [](const Dataset & ds){return ds.prefetchSize();})
+            .def("set_prefetch_threads", [](Dataset & ds, const int nThreads){ds.setPrefetchThreads(nThreads);})
+            .def_property_readonly("prefetch_threads", [](const Dataset & ds){return ds.prefetchThreads();})
+
             // TODO
             // compression, compression_opts, fillvalue
         ;
@@ -263,12 +174,25 @@ namespace z5 {
             const std::string & compressor,
             const std::string & codec,
             const int compressorLevel,
-            const int compressorShuffle
+            const int compressorShuffle,
+            const double compressorTolerance,
+            const double compressorRate,
+            const int compressorPrecision
         ){
             return createDataset(
-                path, dtype, shape, chunkShape, createAsZarr, fillValue, compressor, codec, compressorLevel, compressorShuffle
+                path, dtype, shape, chunkShape, createAsZarr, fillValue, compressor, codec, compressorLevel, compressorShuffle,
+                0, compressorTolerance, compressorRate, compressorPrecision
             );
         });
+
+        // the compressors z5 was built with
+        module.def("available_compressors", [](){
+            std::vector<std::string> compressors;
+            for(const auto & compressor : types::stringToCompressor) {
+                compressors.push_back(compressor.first);
+            }
+            return compressors;
+        });
     }
 
 
@@ -1,6 +1,8 @@
 #include <pybind11/pybind11.h>
 #include <iostream>
 
+#include "z5/util/trace.hxx"
+
 namespace py = pybind11;
 
 
@@ -17,5 +19,15 @@ PYBIND11_MODULE(_z5py, module) {
     using namespace z5;
     exportDataset(module);
     exportGroups(module);
+
+    // tracing of the chunk pipeline
+    module.def("enable_tracing", [](){util::Tracer::instance().enable();});
+    module.def("disable_tracing", [](){util::Tracer::instance().disable();});
+    module.def("is_tracing_enabled", [](){return util::Tracer::instance().isEnabled();});
+    module.def("clear_trace", [](){util::Tracer::instance().clear();});
+    module.def("write_trace", [](const std::string & path){
+        py::gil_scoped_release allowThreads;
+        util::Tracer::instance().writeChromeTrace(path);
+    });
 }
 
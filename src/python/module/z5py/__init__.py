@@ -1 +1,2 @@
 from .file import File
+from ._z5py import enable_tracing, disable_tracing, is_tracing_enabled, clear_trace, write_trace
@@ -19,6 +19,8 @@ class Base(object):
         return os.listdir(self.path)
 
     # TODO allow creating with data ?!
+    # tolerance, rate and precision select the lossy modes of zfp
+    # (fixed accuracy, rate or precision), by default zfp is lossless
     def create_dataset(
         self,
         key,
@@ -29,12 +31,16 @@ class Base(object):
         compressor='blosc',  # TODO change default value depending on zarr / n5
         codec='lz4',  # TODO change default value depending on zarr / n5
         level=5,
-        shuffle=1
+        shuffle=1,
+        tolerance=None,
+        rate=None,
+        precision=None
     ):
         assert key not in self.keys(), "Dataset is already existing"
         path = os.path.join(self.path, key)
         return Dataset.create_dataset(
-            path, dtype, shape, chunks, self.is_zarr, fill_value, compressor, codec, level, shuffle
+            path, dtype, shape, chunks, self.is_zarr, fill_value, compressor, codec, level, shuffle,
+            tolerance, rate, precision
         )
 
     def is_group(self, path):
@@ -1,6 +1,6 @@
 import numpy as np
 import numbers
-from ._z5py import DatasetImpl, open_dataset, create_dataset
+from ._z5py import DatasetImpl, open_dataset, create_dataset, available_compressors
 from .attribute_manager import AttributeManager
 
 
@@ -9,15 +9,20 @@ class Dataset(object):
     # FIXME for now we hardcode all compressors
     # but we should instead check which ones are present
     # (similar to nifty WITH_CPLEX, etc.)
-    compressors_zarr = ['raw', 'blosc', 'zlib', 'bzip2']
-    compressors_n5 = ['raw', 'gzip', 'bzip2']
+    compressors_zarr = ['raw', 'blosc', 'zlib', 'bzip2', 'zstd', 'compressed_segmentation']
+    compressors_n5 = ['raw', 'gzip', 'bzip2', 'zstd', 'compressed_segmentation']
+    # zfp is only available if z5 was built with it
+    if 'zfp' in available_compressors():
+        compressors_zarr.append('zfp')
+        compressors_n5.append('zfp')
     zarr_default_compressor = 'blosc'
     n5_default_compressor = 'gzip'
 
-    def __init__(self, path, dset_impl):
+    def __init__(self, path, dset_impl, n_threads=1):
         assert isinstance(dset_impl, DatasetImpl)
         self._impl = dset_impl
         self._attrs = AttributeManager(path, self._impl.is_zarr)
+        self.n_threads = n_threads
 
     @classmethod
     def create_dataset(cls,
@@ -30,7 +35,10 @@ class Dataset(object):
                        compressor,
                        codec,
                        level,
-                       shuffle):
+                       shuffle,
+                       tolerance=None,
+                       rate=None,
+                       precision=None):
         if is_zarr and compressor not in cls.compressors_zarr:
             compressor = cls.zarr_default_compressor
         elif not is_zarr and compressor not in cls.compressors_n5:
@@ -45,7 +53,10 @@ class Dataset(object):
                                         compressor,
                                         codec,
                                         level,
-                                        shuffle))
+                                        shuffle,
+                                        -1 if tolerance is None else tolerance,
+                                        -1 if rate is None else rate,
+                                        -1 if precision is None else precision))
 
     @classmethod
     def open_dataset(cls, path):
@@ -59,6 +70,76 @@ class Dataset(object):
     def attrs(self):
         return self._attrs
 
+    # number of threads used to read / write chunks in parallel
+    # (values <= 0 use all available cores)
+    @property
+    def n_threads(self):
+        return self._n_threads
+
+    @n_threads.setter
+    def n_threads(self, n_threads):
+        assert isinstance(n_threads, numbers.Integral)
+        self._n_threads = int(n_threads)
+
+    # size of the cache for decoded chunks in bytes (0 disables the cache)
+    @property
+    def cache_size(self):
+        return self._impl.cache_size
+
+    @cache_size.setter
+    def cache_size(self, cache_size):
+        self._impl.set_cache_size(cache_size)
+
+    # returns the number of cache hits and misses
+    def cache_statistics(self):
+        return self._impl.cache_statistics()
+
+    # returns a dict with the number of chunks and bytes that were read / written
+    # and the time spent in reading, decompression, compression, writing and copying (in seconds);
+    # only recorded if z5 was built with WITH_INSTRUMENTATION, otherwise all values are zero
+    def io_statistics(self):
+        return self._impl.io_statistics()
+
+    def reset_io_statistics(self):
+        self._impl.reset_io_statistics()
+
+    # read the chunk files via memory mapping
+    @property
+    def use_mmap(self):
+        return self._impl.use_mmap
+
+    @use_mmap.setter
+    def use_mmap(self, use_mmap):
+        self._impl.set_use_mmap(bool(use_mmap))
+
+    # number of threads used to (de)compress a single chunk
+    # (blosc and zlib / gzip compression of large chunks)
+    @property
+    def compressor_threads(self):
+        return self._impl.compressor_threads
+
+    @compressor_threads.setter
+    def compressor_threads(self, n_threads):
+        self._impl.set_compressor_threads(int(n_threads))
+
+    # budget in bytes for the chunks that are read ahead while reading
+    # a subarray (0 disables prefetching) and number of threads reading them
+    @property
+    def prefetch_size(self):
+        return self._impl.prefetch_size
+
+    @prefetch_size.setter
+    def prefetch_size(self, prefetch_size):
+        self._impl.set_prefetch_size(prefetch_size)
+
+    @property
+    def prefetch_threads(self):
+        return self._impl.prefetch_threads
+
+    @prefetch_threads.setter
+    def prefetch_threads(self, n_threads):
+        self._impl.set_prefetch_threads(int(n_threads))
+
     @property
     def shape(self):
         return tuple(self._impl.shape) if self.is_zarr else \
@@ -125,7 +206,7 @@ class Dataset(object):
     def __getitem__(self, index):
         roi_begin, shape = self.index_to_roi(index)
         out = np.zeros(shape, dtype=self.dtype)
-        self._impl.read_subarray(out, roi_begin)
+        self._impl.read_subarray(out, roi_begin, self._n_threads)
         # n5 output must be transposed due to different axis convention
         return out if self.is_zarr else out.transpose()
 
@@ -139,7 +220,8 @@ class Dataset(object):
         if isinstance(item, np.ndarray):
             assert item.ndim == self.ndim, \
                 "z5py.Dataset: complicated broadcasting is not supported"
-            self._impl.write_subarray(item if self.is_zarr else item.transpose(), roi_begin)
+            self._impl.write_subarray(item if self.is_zarr else item.transpose(),
+                                     roi_begin, self._n_threads)
 
         # broadcast scalar
         else:
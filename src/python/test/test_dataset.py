@@ -1,6 +1,7 @@
 import unittest
 import numpy as np
 import os
+import json
 from shutil import rmtree
 
 # hacky import
@@ -72,6 +73,45 @@ class TestDataset(unittest.TestCase):
             self.assertEqual(out_array.shape, in_array.shape)
             self.assertTrue(np.allclose(out_array, in_array))
 
+    def test_ds_parallel(self):
+        for ff in (self.ff_zarr, self.ff_n5):
+            ds = ff.create_dataset(
+                'data_parallel', dtype='float32', shape=self.shape, chunks=(10, 10, 10)
+            )
+            ds.n_threads = 4
+            in_array = np.random.rand(*self.shape).astype('float32')
+            ds[:] = in_array
+            # write to an roi that is not aligned with the chunks
+            in_roi = np.random.rand(33, 47, 21).astype('float32')
+            ds[5:38, 13:60, 71:92] = in_roi
+            in_array[5:38, 13:60, 71:92] = in_roi
+            out_array = ds[:]
+            self.assertEqual(out_array.shape, in_array.shape)
+            self.assertTrue(np.allclose(out_array, in_array))
+
+    @unittest.skipUnless('zfp' in z5py.Dataset.compressors_zarr, "z5 was built without zfp")
+    def test_ds_zfp(self):
+        for ff, meta_file in ((self.ff_zarr, '.zarray'), (self.ff_n5, 'attributes.json')):
+            in_array = np.random.rand(*self.shape).astype('float32')
+            # lossy fixed accuracy mode
+            ds = ff.create_dataset(
+                'data_zfp', dtype='float32', shape=self.shape, chunks=(10, 10, 10),
+                compressor='zfp', tolerance=1e-3
+            )
+            with open(os.path.join(ff.path, 'data_zfp', meta_file)) as f:
+                meta = json.load(f)
+            opts = meta['compressor'] if ff.is_zarr else meta['compression']
+            self.assertEqual(opts['tolerance'], 1e-3)
+            ds[:] = in_array
+            self.assertTrue(np.allclose(ds[:], in_array, atol=1e-3, rtol=0))
+            # lossless mode
+            ds = ff.create_dataset(
+                'data_zfp_lossless', dtype='float32', shape=self.shape, chunks=(10, 10, 10),
+                compressor='zfp'
+            )
+            ds[:] = in_array
+            self.assertTrue((ds[:] == in_array).all())
+
 
 if __name__ == '__main__':
     unittest.main()
@@ -94,5 +94,29 @@ namespace compression {
 
     }
 
+    TEST_F(CompressionTest, BloscThreadsAndBitshuffle) {
+
+        // Test multi-threaded compression with bitshuffle and a fixed blocksize
+        DatasetMetadata metadata;
+        metadata.compressor = types::blosc;
+        metadata.codec = "lz4";
+        metadata.compressorLevel = 5;
+        metadata.compressorShuffle = 2;
+        metadata.compressorBlocksize = 1 << 16;
+        metadata.compressorThreads = 4;
+        BloscCompressor<int> compressor(metadata);
+        ASSERT_EQ(compressor.numberOfThreads(), 4);
+
+        std::vector<int> dataOut;
+        compressor.compress(dataInt_, dataOut, SIZE);
+        ASSERT_TRUE(dataOut.size() < SIZE);
+
+        int dataTmp[SIZE];
+        compressor.decompress(dataOut, dataTmp, SIZE);
+        for(size_t i = 0; i < SIZE; ++i) {
+            ASSERT_EQ(dataTmp[i], dataInt_[i]);
+        }
+    }
+
 }
 }
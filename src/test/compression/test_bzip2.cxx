@@ -82,5 +82,51 @@ namespace compression {
 
     }
 
+
+    TEST_F(CompressionTest, Bzip2ReversedEndianness) {
+
+        DatasetMetadata metadata;
+        metadata.compressorLevel = 5;
+        metadata.compressor = types::bzip2;
+        checkReversedEndianness(Bzip2Compressor<int>(metadata), dataInt_);
+        checkReversedEndianness(Bzip2Compressor<float>(metadata), dataFloat_);
+    }
+
+
+    TEST_F(CompressionTest, Bzip2Repeated) {
+
+        DatasetMetadata metadata;
+        metadata.compressor = types::bzip2;
+        // different levels need differently sized stream states
+        for(const int level : {5, 9, 5}) {
+            metadata.compressorLevel = level;
+            checkRepeated(Bzip2Compressor<int>(metadata), dataInt_);
+            checkRepeated(Bzip2Compressor<float>(metadata), dataFloat_);
+        }
+    }
+
+
+    TEST_F(CompressionTest, Bzip2DecompressErrors) {
+
+        // truncated or corrupted data or a too large output must throw
+        DatasetMetadata metadata;
+        metadata.compressorLevel = 5;
+        metadata.compressor = types::bzip2;
+        Bzip2Compressor<int> compressor(metadata);
+
+        std::vector<int> dataOut;
+        compressor.compress(dataInt_, dataOut, SIZE);
+
+        std::vector<int> dataTmp(SIZE + 1);
+        const char * compressed = reinterpret_cast<const char *>(dataOut.data());
+        const size_t nBytes = dataOut.size() * sizeof(int);
+        ASSERT_THROW(compressor.decompress(compressed, nBytes / 2, dataTmp.data(), SIZE), std::runtime_error);
+        ASSERT_THROW(compressor.decompress(compressed, nBytes, dataTmp.data(), SIZE + 1), std::runtime_error);
+
+        std::vector<int> corrupted(dataOut);
+        corrupted[0] = ~corrupted[0];
+        ASSERT_THROW(compressor.decompress(corrupted, dataTmp.data(), SIZE), std::runtime_error);
+    }
+
 }
 }
@@ -0,0 +1,154 @@
+#include "gtest/gtest.h"
+
+#include <set>
+
+#include "z5/compression/compressed_segmentation_compressor.hxx"
+#include "z5/metadata.hxx"
+
+#include "test_helper.hxx"
+
+namespace z5 {
+namespace compression {
+
+    // make a label volume of the test size (100 x 100 x 100) that
+    // has only a few labels per 8 x 8 x 8 block
+    template<typename T>
+    void makeLabels(std::vector<T> & labels, const T offset) {
+        labels.resize(SIZE);
+        size_t i = 0;
+        for(size_t z = 0; z < 100; ++z) {
+            for(size_t y = 0; y < 100; ++y) {
+                for(size_t x = 0; x < 100; ++x, ++i) {
+                    labels[i] = offset + (z / 10) * 10000 + (y / 13) * 100 + (x / 7);
+                }
+            }
+        }
+    }
+
+
+    template<typename T>
+    void checkRoundtrip(const CompressedSegmentationCompressor<T> & compressor, const std::vector<T> & labels,
+                        const size_t minRatio=1) {
+        std::vector<T> dataOut;
+        compressor.compress(labels.data(), dataOut, labels.size());
+        ASSERT_TRUE(dataOut.size() * minRatio < labels.size());
+
+        std::vector<T> dataTmp(labels.size());
+        compressor.decompress(dataOut, dataTmp.data(), labels.size());
+        for(size_t i = 0; i < labels.size(); ++i) {
+            ASSERT_EQ(dataTmp[i], labels[i]);
+        }
+    }
+
+
+    TEST_F(CompressionTest, CompressedSegmentationDecompress) {
+
+        DatasetMetadata metadata;
+        metadata.compressor = types::compressedSegmentation;
+        metadata.chunkShape = types::ShapeType({100, 100, 100});
+
+        std::vector<uint32_t> labels32;
+        makeLabels<uint32_t>(labels32, 1);
+        checkRoundtrip(CompressedSegmentationCompressor<uint32_t>(metadata), labels32, 10);
+
+        std::vector<uint64_t> labels64;
+        makeLabels<uint64_t>(labels64, uint64_t(1) << 40);
+        checkRoundtrip(CompressedSegmentationCompressor<uint64_t>(metadata), labels64, 10);
+
+        // blocks that don't divide the chunk shape
+        metadata.compressorBlockShape = types::ShapeType({4, 16, 3});
+        checkRoundtrip(CompressedSegmentationCompressor<uint64_t>(metadata), labels64);
+    }
+
+
+    TEST_F(CompressionTest, CompressedSegmentationDimensions) {
+
+        DatasetMetadata metadata;
+        metadata.compressor = types::compressedSegmentation;
+        std::vector<uint64_t> labels;
+        makeLabels<uint64_t>(labels, 0);
+
+        // 2d chunks
+        metadata.chunkShape = types::ShapeType({1000, 1000});
+        checkRoundtrip(CompressedSegmentationCompressor<uint64_t>(metadata), labels);
+
+        // 4d chunks, the first axis is encoded as channels
+        metadata.chunkShape = types::ShapeType({4, 25, 100, 100});
+        checkRoundtrip(CompressedSegmentationCompressor<uint64_t>(metadata), labels);
+
+        // truncated chunks are encoded as flat volume
+        metadata.chunkShape = types::ShapeType({128, 128, 128});
+        checkRoundtrip(CompressedSegmentationCompressor<uint64_t>(metadata), labels);
+    }
+
+
+    TEST_F(CompressionTest, CompressedSegmentationUniqueValues) {
+
+        DatasetMetadata metadata;
+        metadata.compressor = types::compressedSegmentation;
+        metadata.chunkShape = types::ShapeType({100, 100, 100});
+
+        std::vector<uint64_t> labels;
+        makeLabels<uint64_t>(labels, uint64_t(1) << 40);
+
+        // a block of noise, that needs 16 bits per voxel
+        for(size_t i = 0; i < 1000; ++i) {
+            labels[i] = i;
+        }
+        const std::set<uint64_t> expected(labels.begin(), labels.end());
+
+        CompressedSegmentationCompressor<uint64_t> compressor(metadata);
+        std::vector<uint64_t> dataOut, values;
+        compressor.compress(labels.data(), dataOut, SIZE);
+        ASSERT_TRUE(compressor.uniqueValues(reinterpret_cast<const char *>(dataOut.data()),
+                                            dataOut.size() * sizeof(uint64_t), SIZE, values));
+        ASSERT_EQ(values.size(), expected.size());
+        ASSERT_TRUE(std::equal(values.begin(), values.end(), expected.begin()));
+
+        // constant chunk
+        std::fill(labels.begin(), labels.end(), 42);
+        compressor.compress(labels.data(), dataOut, SIZE);
+        ASSERT_TRUE(compressor.uniqueValues(reinterpret_cast<const char *>(dataOut.data()),
+                                            dataOut.size() * sizeof(uint64_t), SIZE, values));
+        ASSERT_EQ(values.size(), 1);
+        ASSERT_EQ(values[0], 42);
+    }
+
+
+    TEST_F(CompressionTest, CompressedSegmentationReversedEndianness) {
+
+        DatasetMetadata metadata;
+        metadata.compressor = types::compressedSegmentation;
+        metadata.chunkShape = types::ShapeType({100, 100, 100});
+
+        std::vector<uint32_t> labels32;
+        makeLabels<uint32_t>(labels32, 1);
+        checkReversedEndianness(CompressedSegmentationCompressor<uint32_t>(metadata), labels32.data());
+
+        std::vector<uint64_t> labels64;
+        makeLabels<uint64_t>(labels64, uint64_t(1) << 40);
+        checkReversedEndianness(CompressedSegmentationCompressor<uint64_t>(metadata), labels64.data());
+    }
+
+
+    TEST_F(CompressionTest, CompressedSegmentationRepeated) {
+
+        DatasetMetadata metadata;
+        metadata.compressor = types::compressedSegmentation;
+        metadata.chunkShape = types::ShapeType({32, 32, 32});
+
+        std::vector<uint64_t> labels;
+        makeLabels<uint64_t>(labels, 0);
+        checkRepeated(CompressedSegmentationCompressor<uint64_t>(metadata), labels.data());
+    }
+
+
+    TEST_F(CompressionTest, CompressedSegmentationInvalidType) {
+        DatasetMetadata metadata;
+        metadata.compressor = types::compressedSegmentation;
+        metadata.chunkShape = types::ShapeType({100, 100, 100});
+        ASSERT_THROW(CompressedSegmentationCompressor<float>{metadata}, std::runtime_error);
+    }
+
+}
+}
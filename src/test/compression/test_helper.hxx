@@ -2,7 +2,11 @@
 
 #include "gtest/gtest.h"
 
+#include <cstring>
 #include <random>
+#include <thread>
+
+#include "z5/compression/compressor_base.hxx"
 
 #define SIZE 100*100*100
 
@@ -43,6 +47,65 @@ namespace compression {
 
         }
 
+        // compressing with reversed endianness must give the same result
+        // as compressing a swapped copy of the data
+        template<typename T>
+        void checkReversedEndianness(const CompressorBase<T> & compressor, const T * data) {
+            std::vector<T> swapped(data, data + SIZE);
+            util::reverseEndiannessInplace(swapped.data(), SIZE);
+            std::vector<T> expected;
+            compressor.compress(swapped.data(), expected, SIZE);
+
+            std::vector<T> dataOut;
+            compressor.compressReversedEndianness(data, dataOut, SIZE);
+            // compare bytes, because the compressed data might contain nans for floating point types
+            ASSERT_EQ(dataOut.size(), expected.size());
+            ASSERT_EQ(std::memcmp(dataOut.data(), expected.data(), dataOut.size() * sizeof(T)), 0);
+
+            std::vector<T> dataTmp(SIZE);
+            compressor.decompress(dataOut, dataTmp.data(), SIZE);
+            util::reverseEndiannessInplace(dataTmp.data(), SIZE);
+            for(size_t i = 0; i < SIZE; ++i) {
+                ASSERT_EQ(dataTmp[i], data[i]);
+            }
+        }
+
+
+        // compress and decompress small pieces of the data many times from several threads,
+        // the compressors reuse their stream state between calls and must give the same
+        // results as for the first call
+        template<typename T>
+        void checkRepeated(const CompressorBase<T> & compressor, const T * data) {
+            const size_t pieceSize = 32 * 32 * 32;
+            std::vector<T> expected;
+            compressor.compress(data, expected, pieceSize);
+
+            std::vector<std::thread> threads;
+            std::vector<int> failures(4, 0);
+            for(int t = 0; t < 4; ++t) {
+                threads.emplace_back([&, t](){
+                    std::vector<T> dataOut, dataTmp(pieceSize);
+                    for(size_t offset = 0; offset + pieceSize <= SIZE; offset += pieceSize) {
+                        compressor.compress(data + offset, dataOut, pieceSize);
+                        compressor.decompress(dataOut, dataTmp.data(), pieceSize);
+                        if(std::memcmp(dataTmp.data(), data + offset, pieceSize * sizeof(T)) != 0) {
+                            ++failures[t];
+                        }
+                        if(offset == 0 && (dataOut.size() != expected.size() ||
+                           std::memcmp(dataOut.data(), expected.data(), dataOut.size() * sizeof(T)) != 0)) {
+                            ++failures[t];
+                        }
+                    }
+                });
+            }
+            for(auto & thread : threads) {
+                thread.join();
+            }
+            for(const int fail : failures) {
+                ASSERT_EQ(fail, 0);
+            }
+        }
+
 
         int dataInt_[SIZE];
         float dataFloat_[SIZE];
@@ -63,5 +63,11 @@ namespace compression {
         }
     }
 
+
+    TEST_F(CompressionTest, RawReversedEndianness) {
+        checkReversedEndianness(RawCompressor<int>(), dataInt_);
+        checkReversedEndianness(RawCompressor<float>(), dataFloat_);
+    }
+
 }
 }
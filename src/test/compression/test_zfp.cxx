@@ -0,0 +1,152 @@
+#include "gtest/gtest.h"
+
+#include <cmath>
+
+#include "z5/compression/zfp_compressor.hxx"
+#include "z5/metadata.hxx"
+
+#include "test_helper.hxx"
+
+namespace z5 {
+namespace compression {
+
+
+    TEST_F(CompressionTest, ZfpFixedAccuracy) {
+
+        DatasetMetadata metadata;
+        metadata.compressor = types::zfp;
+        metadata.chunkShape = types::ShapeType({100, 100, 100});
+        metadata.compressorTolerance = 1e-3;
+        ZfpCompressor<float> compressor(metadata);
+
+        std::vector<float> dataOut;
+        compressor.compress(dataFloat_, dataOut, SIZE);
+        ASSERT_TRUE(dataOut.size() < SIZE);
+        std::cout << "Compression zfp (tolerance 1e-3) - Float: " << dataOut.size() << " / " << SIZE << std::endl;
+
+        std::vector<float> dataTmp(SIZE);
+        compressor.decompress(dataOut, dataTmp.data(), SIZE);
+        for(size_t i = 0; i < SIZE; ++i) {
+            ASSERT_LE(std::abs(dataTmp[i] - dataFloat_[i]), 1e-3);
+        }
+    }
+
+
+    TEST_F(CompressionTest, ZfpFixedRate) {
+
+        DatasetMetadata metadata;
+        metadata.compressor = types::zfp;
+        metadata.chunkShape = types::ShapeType({100, 100, 100});
+        metadata.compressorRate = 8;
+
+        // smooth data, like probability maps
+        std::vector<double> data(SIZE);
+        for(size_t i = 0; i < SIZE; ++i) {
+            const double z = i / 10000, y = (i / 100) % 100, x = i % 100;
+            data[i] = std::sin(x / 10.) * std::cos(y / 10.) + z / 100.;
+        }
+        ZfpCompressor<double> compressor(metadata);
+
+        // 8 bits per value
+        std::vector<double> dataOut;
+        compressor.compress(data.data(), dataOut, SIZE);
+        ASSERT_TRUE(dataOut.size() < SIZE / 4);
+
+        std::vector<double> dataTmp(SIZE);
+        compressor.decompress(dataOut, dataTmp.data(), SIZE);
+        double maxError = 0;
+        for(size_t i = 0; i < SIZE; ++i) {
+            maxError = std::max(maxError, std::abs(dataTmp[i] - data[i]));
+        }
+        ASSERT_LT(maxError, 0.1);
+    }
+
+
+    TEST_F(CompressionTest, ZfpReversible) {
+
+        // without parameters zfp compresses lossless
+        DatasetMetadata metadata;
+        metadata.compressor = types::zfp;
+        metadata.chunkShape = types::ShapeType({100, 100, 100});
+        ZfpCompressor<float> compressor(metadata);
+
+        std::vector<float> dataOut;
+        compressor.compress(dataFloat_, dataOut, SIZE);
+
+        std::vector<float> dataTmp(SIZE);
+        compressor.decompress(dataOut, dataTmp.data(), SIZE);
+        for(size_t i = 0; i < SIZE; ++i) {
+            ASSERT_EQ(dataTmp[i], dataFloat_[i]);
+        }
+
+        // chunks that don't have the full chunk size (truncated N5 chunks)
+        const size_t truncatedSize = 100 * 100 * 37;
+        compressor.compress(dataFloat_, dataOut, truncatedSize);
+        compressor.decompress(dataOut, dataTmp.data(), truncatedSize);
+        for(size_t i = 0; i < truncatedSize; ++i) {
+            ASSERT_EQ(dataTmp[i], dataFloat_[i]);
+        }
+        ASSERT_THROW(compressor.decompress(dataOut, dataTmp.data(), SIZE), std::runtime_error);
+    }
+
+
+    TEST_F(CompressionTest, ZfpReversedEndianness) {
+
+        // the zfp stream does not depend on the byte order,
+        // so compression and decompression work on native values for N5
+        DatasetMetadata metadata;
+        metadata.compressor = types::zfp;
+        metadata.chunkShape = types::ShapeType({100, 100, 100});
+        ZfpCompressor<float> compressor(metadata);
+
+        std::vector<float> expected, dataOut;
+        compressor.compress(dataFloat_, expected, SIZE);
+        compressor.compressReversedEndianness(dataFloat_, dataOut, SIZE);
+        ASSERT_EQ(dataOut.size(), expected.size());
+        ASSERT_EQ(std::memcmp(dataOut.data(), expected.data(), dataOut.size() * sizeof(float)), 0);
+
+        std::vector<float> dataTmp(SIZE);
+        compressor.decompressReversedEndianness(reinterpret_cast<const char *>(dataOut.data()),
+                                                dataOut.size() * sizeof(float), dataTmp.data(), SIZE);
+        for(size_t i = 0; i < SIZE; ++i) {
+            ASSERT_EQ(dataTmp[i], dataFloat_[i]);
+        }
+    }
+
+
+    TEST_F(CompressionTest, ZfpRepeated) {
+        DatasetMetadata metadata;
+        metadata.compressor = types::zfp;
+        metadata.chunkShape = types::ShapeType({32, 32, 32});
+        checkRepeated(ZfpCompressor<float>(metadata), dataFloat_);
+    }
+
+
+    TEST_F(CompressionTest, ZfpMetadata) {
+
+        // the mode and its parameter are stored in the metadata
+        for(const bool isZarr : {true, false}) {
+            DatasetMetadata metadata(types::float32, types::ShapeType({100, 100, 100}),
+                                     types::ShapeType({10, 10, 10}), isZarr, 0, types::zfp);
+            metadata.compressorRate = 4;
+            nlohmann::json j;
+            metadata.toJson(j);
+
+            DatasetMetadata readMetadata;
+            readMetadata.fromJson(j, isZarr);
+            ASSERT_EQ(readMetadata.compressor, types::zfp);
+            ASSERT_EQ(readMetadata.zfpMode(), 2);
+            ASSERT_EQ(readMetadata.compressorRate, 4);
+            ASSERT_EQ(readMetadata.compressorTolerance, -1);
+        }
+    }
+
+
+    TEST_F(CompressionTest, ZfpInvalidType) {
+        DatasetMetadata metadata;
+        metadata.compressor = types::zfp;
+        ASSERT_THROW(ZfpCompressor<int>{metadata}, std::runtime_error);
+    }
+
+}
+}
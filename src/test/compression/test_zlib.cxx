@@ -94,5 +94,178 @@ namespace compression {
         }
     }
 
+
+    TEST_F(CompressionTest, ZlibReversedEndianness) {
+
+        DatasetMetadata metadata;
+        metadata.compressorLevel = 5;
+        metadata.compressor = types::zlib;
+        for(const auto & name : zlibCompressors) {
+            metadata.codec = name;
+            checkReversedEndianness(ZlibCompressor<int>(metadata), dataInt_);
+            checkReversedEndianness(ZlibCompressor<float>(metadata), dataFloat_);
+        }
+    }
+
+
+    TEST_F(CompressionTest, ZlibRepeated) {
+
+        DatasetMetadata metadata;
+        metadata.compressorLevel = 5;
+        metadata.compressor = types::zlib;
+        // alternate between the encodings, so that the streams are re-initialized
+        for(int repeat = 0; repeat < 2; ++repeat) {
+            for(const auto & name : zlibCompressors) {
+                metadata.codec = name;
+                checkRepeated(ZlibCompressor<int>(metadata), dataInt_);
+                checkRepeated(ZlibCompressor<float>(metadata), dataFloat_);
+            }
+        }
+    }
+
+
+    TEST_F(CompressionTest, ZlibDecompressErrors) {
+
+        // corrupted data or data of the wrong size must throw
+        DatasetMetadata metadata;
+        metadata.compressorLevel = 5;
+        metadata.compressor = types::zlib;
+        for(const auto & name : zlibCompressors) {
+            metadata.codec = name;
+            ZlibCompressor<int> compressor(metadata);
+
+            std::vector<int> dataOut;
+            compressor.compress(dataInt_, dataOut, SIZE);
+
+            std::vector<int> dataTmp(SIZE);
+            const char * compressed = reinterpret_cast<const char *>(dataOut.data());
+            const size_t nBytes = dataOut.size() * sizeof(int);
+            ASSERT_THROW(compressor.decompress(compressed, nBytes / 2, dataTmp.data(), SIZE), std::runtime_error);
+            ASSERT_THROW(compressor.decompress(compressed, nBytes, dataTmp.data(), SIZE - 1), std::runtime_error);
+            ASSERT_THROW(compressor.decompress(compressed, nBytes, dataTmp.data(), SIZE + 1), std::runtime_error);
+
+            std::vector<int> corrupted(dataOut);
+            corrupted[0] = ~corrupted[0];
+            ASSERT_THROW(compressor.decompress(corrupted, dataTmp.data(), SIZE), std::runtime_error);
+        }
+    }
+
+
+    TEST_F(CompressionTest, ZlibTruncatedTrailer) {
+
+        // older versions of z5 cut the compressed chunks to a multiple of sizeof(T),
+        // which drops up to sizeof(T) - 1 bytes of the trailer; these chunks must still be read
+        DatasetMetadata metadata;
+        metadata.compressorLevel = 5;
+        metadata.compressor = types::zlib;
+        for(const auto & name : zlibCompressors) {
+            metadata.codec = name;
+            ZlibCompressor<int> compressor(metadata);
+
+            const size_t capacity = compressor.maxCompressedSize(SIZE);
+            std::vector<char> dataOut(capacity);
+            const size_t nBytes = compressor.compress(dataInt_, SIZE, dataOut.data(), capacity);
+
+            for(size_t cut = 1; cut < sizeof(int); ++cut) {
+                std::vector<int> dataTmp(SIZE);
+                compressor.decompress(dataOut.data(), nBytes - cut, dataTmp.data(), SIZE);
+                for(size_t i = 0; i < SIZE; ++i) {
+                    ASSERT_EQ(dataTmp[i], dataInt_[i]);
+                }
+                // the size must still match
+                ASSERT_THROW(compressor.decompress(dataOut.data(), nBytes - cut, dataTmp.data(), SIZE - 1), std::runtime_error);
+                ASSERT_THROW(compressor.decompress(dataOut.data(), nBytes - cut, dataTmp.data(), SIZE + 1), std::runtime_error);
+            }
+        }
+    }
+
+
+    TEST_F(CompressionTest, ZlibParallel) {
+
+        // large chunks are compressed in parallel blocks, which
+        // must result in a single valid zlib / gzip stream
+        DatasetMetadata metadata;
+        metadata.compressorLevel = 5;
+        metadata.compressor = types::zlib;
+        for(const auto & name : zlibCompressors) {
+            metadata.codec = name;
+            ZlibCompressor<int> serialCompressor(metadata);
+            std::vector<int> serialOut;
+            serialCompressor.compress(dataInt_, serialOut, SIZE);
+
+            metadata.compressorThreads = 4;
+            ZlibCompressor<int> compressor(metadata);
+            ASSERT_EQ(compressor.numberOfThreads(), 4);
+
+            std::vector<int> dataOut;
+            compressor.compress(dataInt_, dataOut, SIZE);
+            // priming the blocks with the preceding data keeps the compression close to serial
+            ASSERT_TRUE(dataOut.size() < 1.05 * serialOut.size());
+            std::cout << "Parallel compression " << name << " - Int: " << dataOut.size() << " / " << serialOut.size() << std::endl;
+
+            // the serial decompression can read the parallel stream
+            std::vector<int> dataTmp(SIZE);
+            serialCompressor.decompress(dataOut, dataTmp.data(), SIZE);
+            for(size_t i = 0; i < SIZE; ++i) {
+                ASSERT_EQ(dataTmp[i], dataInt_[i]);
+            }
+
+            // the result does not depend on the number of threads
+            compressor.setNumberOfThreads(2);
+            std::vector<int> dataOut2;
+            compressor.compress(dataInt_, dataOut2, SIZE);
+            ASSERT_EQ(dataOut, dataOut2);
+
+            // chunks with a partial last block
+            const size_t partialSize = 3 * 32 * 1024 + 17;
+            compressor.compress(dataInt_, dataOut, partialSize);
+            serialCompressor.decompress(dataOut, dataTmp.data(), partialSize);
+            for(size_t i = 0; i < partialSize; ++i) {
+                ASSERT_EQ(dataTmp[i], dataInt_[i]);
+            }
+
+            checkReversedEndianness(compressor, dataInt_);
+            metadata.compressorThreads = 1;
+        }
+    }
+
+
+    TEST_F(CompressionTest, ZlibCompressSpan) {
+
+        // compress into caller-owned memory of the maximal compressed size
+        DatasetMetadata metadata;
+        metadata.compressorLevel = 5;
+        metadata.compressor = types::zlib;
+        for(const auto & name : zlibCompressors) {
+            metadata.codec = name;
+            ZlibCompressor<int> compressor(metadata);
+
+            const size_t capacity = compressor.maxCompressedSize(SIZE);
+            std::vector<char> dataOut(capacity);
+            const size_t nBytes = compressor.compress(dataInt_, SIZE, dataOut.data(), capacity);
+            ASSERT_TRUE(nBytes <= capacity);
+
+            std::vector<int> dataTmp(SIZE);
+            compressor.decompress(dataOut.data(), nBytes, dataTmp.data(), SIZE);
+            for(size_t i = 0; i < SIZE; ++i) {
+                ASSERT_EQ(dataTmp[i], dataInt_[i]);
+            }
+
+            // incompressible data must fit as well
+            std::vector<unsigned char> noise(SIZE);
+            std::default_random_engine generator;
+            std::uniform_int_distribution<int> distribution(0, 255);
+            for(auto & val : noise) {
+                val = distribution(generator);
+            }
+            metadata.compressorLevel = 9;
+            ZlibCompressor<unsigned char> noiseCompressor(metadata);
+            const size_t noiseCapacity = noiseCompressor.maxCompressedSize(SIZE);
+            std::vector<char> noiseOut(noiseCapacity);
+            ASSERT_TRUE(noiseCompressor.compress(noise.data(), SIZE, noiseOut.data(), noiseCapacity) <= noiseCapacity);
+            metadata.compressorLevel = 5;
+        }
+    }
+
 }
 }
@@ -0,0 +1,130 @@
+#include "gtest/gtest.h"
+
+#include "z5/compression/zstd_compressor.hxx"
+#include "z5/metadata.hxx"
+
+#include "test_helper.hxx"
+
+namespace z5 {
+namespace compression {
+
+
+    TEST_F(CompressionTest, ZstdCompressInt) {
+
+        // Test compression with default values
+        DatasetMetadata metadata;
+        metadata.compressorLevel = 3;
+        metadata.compressor = types::zstd;
+        ZstdCompressor<int> compressor(metadata);
+
+        std::vector<int> dataOut;
+        compressor.compress(dataInt_, dataOut, SIZE);
+
+        ASSERT_TRUE(dataOut.size() < SIZE);
+        std::cout << "Compression zstd - Int: " << dataOut.size() << " / " << SIZE << std::endl;
+    }
+
+
+    TEST_F(CompressionTest, ZstdCompressFloat) {
+
+        // Test compression with default values
+        DatasetMetadata metadata;
+        metadata.compressorLevel = 3;
+        metadata.compressor = types::zstd;
+        ZstdCompressor<float> compressor(metadata);
+
+        std::vector<float> dataOut;
+        compressor.compress(dataFloat_, dataOut, SIZE);
+
+        ASSERT_TRUE(dataOut.size() < SIZE);
+        std::cout << "Compression zstd - Float: " << dataOut.size() << " / " << SIZE << std::endl;
+    }
+
+
+    TEST_F(CompressionTest, ZstdDecompressInt) {
+
+        // Test compression with default values
+        DatasetMetadata metadata;
+        metadata.compressorLevel = 3;
+        metadata.compressor = types::zstd;
+        ZstdCompressor<int> compressor(metadata);
+
+        std::vector<int> dataOut;
+        compressor.compress(dataInt_, dataOut, SIZE);
+        ASSERT_TRUE(dataOut.size() < SIZE);
+
+        int dataTmp[SIZE];
+        compressor.decompress(dataOut, dataTmp, SIZE);
+        for(size_t i = 0; i < SIZE; ++i) {
+            ASSERT_EQ(dataTmp[i], dataInt_[i]);
+        }
+    }
+
+
+    TEST_F(CompressionTest, ZstdDecompressFloat) {
+
+        // Test compression with default values
+        DatasetMetadata metadata;
+        metadata.compressorLevel = 3;
+        metadata.compressor = types::zstd;
+        ZstdCompressor<float> compressor(metadata);
+
+        std::vector<float> dataOut;
+        compressor.compress(dataFloat_, dataOut, SIZE);
+        ASSERT_TRUE(dataOut.size() < SIZE);
+
+        float dataTmp[SIZE];
+        compressor.decompress(dataOut, dataTmp, SIZE);
+        for(size_t i = 0; i < SIZE; ++i) {
+            ASSERT_EQ(dataTmp[i], dataFloat_[i]);
+        }
+    }
+
+
+    TEST_F(CompressionTest, ZstdLongDistanceMatching) {
+
+        DatasetMetadata metadata;
+        metadata.compressorLevel = 3;
+        metadata.compressor = types::zstd;
+        metadata.compressorLongDistanceMatching = true;
+        ZstdCompressor<int> compressor(metadata);
+
+        std::vector<int> dataOut;
+        compressor.compress(dataInt_, dataOut, SIZE);
+        ASSERT_TRUE(dataOut.size() < SIZE);
+
+        std::vector<int> dataTmp(SIZE);
+        compressor.decompress(dataOut, dataTmp.data(), SIZE);
+        for(size_t i = 0; i < SIZE; ++i) {
+            ASSERT_EQ(dataTmp[i], dataInt_[i]);
+        }
+    }
+
+
+    TEST_F(CompressionTest, ZstdReversedEndianness) {
+
+        DatasetMetadata metadata;
+        metadata.compressorLevel = 3;
+        metadata.compressor = types::zstd;
+        checkReversedEndianness(ZstdCompressor<int>(metadata), dataInt_);
+        checkReversedEndianness(ZstdCompressor<float>(metadata), dataFloat_);
+    }
+
+
+    TEST_F(CompressionTest, ZstdRepeated) {
+
+        DatasetMetadata metadata;
+        metadata.compressor = types::zstd;
+        // alternate between the parameters, so that the contexts are re-initialized
+        for(int repeat = 0; repeat < 2; ++repeat) {
+            for(const int level : {1, 3, 9}) {
+                metadata.compressorLevel = level;
+                metadata.compressorLongDistanceMatching = level == 9;
+                checkRepeated(ZstdCompressor<int>(metadata), dataInt_);
+                checkRepeated(ZstdCompressor<float>(metadata), dataFloat_);
+            }
+        }
+    }
+
+}
+}
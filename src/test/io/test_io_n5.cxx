@@ -61,6 +61,49 @@ namespace io {
 
     }
 
+    TEST_F(IoTest, IncompressibleChunksN5) {
+        // the compressed chunks of random data are larger than the raw chunks,
+        // they must be read completely
+        types::ShapeType shape({10, 10, 10});
+        std::vector<float> data(1000);
+        std::default_random_engine generator;
+        std::uniform_real_distribution<float> distribution(0., 1.);
+        for(auto & val : data) {
+            val = distribution(generator);
+        }
+
+        // (N5 does not support blosc)
+        std::vector<std::string> compressors({"raw"});
+        #ifdef WITH_ZLIB
+        compressors.push_back("gzip");
+        #endif
+        #ifdef WITH_BZIP2
+        compressors.push_back("bzip2");
+        #endif
+        #ifdef WITH_ZSTD
+        compressors.push_back("zstd");
+        #endif
+        #ifdef WITH_ZFP
+        compressors.push_back("zfp");
+        #endif
+
+        const types::ShapeType chunkId({0, 0, 0});
+        for(const auto & compressor : compressors) {
+            const std::string path = "array_incompressible.n5";
+            auto ds = createDataset(path, "float32", shape, shape, false, 0, compressor);
+            ds->writeChunk(chunkId, data.data());
+
+            for(const bool useMmap : {false, true}) {
+                ds->setUseMmap(useMmap);
+                std::vector<float> out(1000);
+                ds->readChunk(chunkId, out.data());
+                ASSERT_EQ(out, data) << compressor << ", mmap: " << useMmap;
+            }
+            fs::remove_all(path);
+        }
+    }
+
+
     TEST_F(IoTest, ReadFileN5) {
         handle::Chunk chunkHandle(ds_n5, chunk0Id, false);
 
@@ -77,6 +120,48 @@ namespace io {
     }
 
 
+    TEST_F(IoTest, ReadMappedN5) {
+        handle::Chunk chunkHandle(ds_n5, chunk0Id, false);
+
+        types::ShapeType shape({1000, 1000, 1000});
+        ChunkIoN5<int> io(shape, chunkShape);
+
+        // the header is skipped, so we should only see the data
+        MappedChunk mapped;
+        ASSERT_TRUE(io.read(chunkHandle, mapped));
+        ASSERT_EQ(mapped.size(), SIZE * sizeof(int));
+
+        const int * tmpData = reinterpret_cast<const int *>(mapped.data());
+        for(size_t i = 0; i < SIZE; ++ i) {
+            ASSERT_EQ(data_[i], tmpData[i]);
+        }
+    }
+
+
+    TEST_F(IoTest, HeaderMismatchN5) {
+        handle::Chunk chunkHandle(ds_n5, chunk0Id, false);
+
+        // the chunk on disc has shape 100^3, but with this
+        // dataset shape the chunk should be clipped to 50^3
+        types::ShapeType shape({50, 50, 50});
+        ChunkIoN5<int> io(shape, chunkShape);
+
+        types::ShapeType shapeOut;
+        io.getChunkShape(chunkHandle, shapeOut);
+        ASSERT_EQ(shapeOut, types::ShapeType({50, 50, 50}));
+
+        std::vector<int> tmpData;
+        ASSERT_THROW(io.read(chunkHandle, tmpData), std::runtime_error);
+        MappedChunk mapped;
+        ASSERT_THROW(io.read(chunkHandle, mapped), std::runtime_error);
+
+        // non-existing chunks are not read
+        handle::Chunk chunkHandle1(ds_n5, chunk1Id, false);
+        ASSERT_FALSE(io.read(chunkHandle1, tmpData));
+        ASSERT_FALSE(io.read(chunkHandle1, mapped));
+    }
+
+
     TEST_F(IoTest, WriteFileN5) {
         handle::Chunk chunkHandle(ds_n5, chunk1Id, false);
 
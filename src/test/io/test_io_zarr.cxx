@@ -20,6 +20,25 @@ namespace io {
     }
 
 
+    TEST_F(IoTest, ReadMappedZarr) {
+        handle::Chunk chunkHandle(ds_zarr, chunk0Id, true);
+        ChunkIoZarr<int> io;
+
+        MappedChunk mapped;
+        ASSERT_TRUE(io.read(chunkHandle, mapped));
+        ASSERT_EQ(mapped.size(), SIZE * sizeof(int));
+
+        const int * tmpData = reinterpret_cast<const int *>(mapped.data());
+        for(size_t i = 0; i < SIZE; ++ i) {
+            ASSERT_EQ(data_[i], tmpData[i]);
+        }
+
+        // non-existing chunks are not mapped
+        handle::Chunk chunkHandle1(ds_zarr, chunk1Id, true);
+        ASSERT_FALSE(io.read(chunkHandle1, mapped));
+    }
+
+
     TEST_F(IoTest, WriteFileZarr) {
         handle::Chunk chunkHandle(ds_zarr, chunk1Id, true);
         ChunkIoZarr<int> io;
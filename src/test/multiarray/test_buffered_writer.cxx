@@ -0,0 +1,189 @@
+#include "gtest/gtest.h"
+
+#include <random>
+
+#include "z5/dataset_factory.hxx"
+#include "z5/multiarray/marray_access.hxx"
+#include "z5/multiarray/buffered_writer.hxx"
+
+namespace fs = boost::filesystem;
+
+namespace z5 {
+namespace multiarray {
+
+    // fixture for the buffered writer test
+    class BufferedWriterTest : public ::testing::Test {
+
+    protected:
+        BufferedWriterTest() :
+            pathZarr_("buffered.zr"), pathN5_("buffered.n5"),
+            shape_({64, 50, 50}), chunkShape_({16, 23, 17})
+        {
+        }
+
+        virtual void TearDown() {
+            fs::remove_all(fs::path(pathZarr_));
+            fs::remove_all(fs::path(pathN5_));
+        }
+
+        // write the data slice by slice along the first axis
+        void writeSlices(std::unique_ptr<Dataset> & ds, andres::Marray<float> & data, const size_t maxBytes) {
+            BufferedWriter<float> writer(*ds, maxBytes);
+            types::ShapeType sliceShape({1, shape_[1], shape_[2]});
+            for(size_t z = 0; z < shape_[0]; ++z) {
+                types::ShapeType offset({z, 0, 0});
+                auto slice = data.view(offset.begin(), sliceShape.begin());
+                writer.write(slice, offset.begin());
+            }
+            // the writer is flushed when it goes out of scope
+        }
+
+        void checkData(std::unique_ptr<Dataset> & ds, const andres::Marray<float> & data) {
+            types::ShapeType offset({0, 0, 0});
+            andres::Marray<float> out(shape_.begin(), shape_.end());
+            readSubarray(ds, out, offset.begin());
+            for(size_t i = 0; i < shape_[0]; ++i) {
+                for(size_t j = 0; j < shape_[1]; ++j) {
+                    for(size_t k = 0; k < shape_[2]; ++k) {
+                        ASSERT_EQ(out(i, j, k), data(i, j, k));
+                    }
+                }
+            }
+        }
+
+        void makeData(andres::Marray<float> & data) {
+            std::default_random_engine gen;
+            std::uniform_real_distribution<float> distr(0., 1.);
+            data.resize(shape_.begin(), shape_.end());
+            for(auto it = data.begin(); it != data.end(); ++it) {
+                *it = distr(gen);
+            }
+        }
+
+        std::string pathZarr_;
+        std::string pathN5_;
+        types::ShapeType shape_;
+        types::ShapeType chunkShape_;
+    };
+
+
+    TEST_F(BufferedWriterTest, TestSlices) {
+        andres::Marray<float> data;
+        makeData(data);
+        // a large enough cap to buffer a whole layer of chunks
+        auto dsZarr = createDataset(pathZarr_, "float32", shape_, chunkShape_, true);
+        writeSlices(dsZarr, data, 1024 * 1024 * 1024);
+        checkData(dsZarr, data);
+
+        auto dsN5 = createDataset(pathN5_, "float32", shape_, chunkShape_, false, 0, "gzip");
+        writeSlices(dsN5, data, 1024 * 1024 * 1024);
+        checkData(dsN5, data);
+    }
+
+
+    TEST_F(BufferedWriterTest, TestEviction) {
+        andres::Marray<float> data;
+        makeData(data);
+        // a cap that only allows for a single chunk, so the partial chunks
+        // are evicted and need to be merged with the data on disc
+        auto ds = createDataset(pathZarr_, "float32", shape_, chunkShape_, true);
+        writeSlices(ds, data, ds->maxChunkSize() * sizeof(float) * 3 / 2);
+        checkData(ds, data);
+    }
+
+
+    TEST_F(BufferedWriterTest, TestEvictionSingleWrite) {
+        andres::Marray<float> data;
+        makeData(data);
+        auto ds = createDataset(pathZarr_, "float32", shape_, chunkShape_, true);
+        const size_t maxBytes = ds->maxChunkSize() * sizeof(float) * 3 / 2;
+        BufferedWriter<float> writer(*ds, maxBytes);
+
+        // a single write that partially covers 3 x 3 chunks must not
+        // buffer more than the memory cap
+        types::ShapeType offset({0, 0, 0});
+        types::ShapeType roiShape({8, shape_[1], shape_[2]});
+        auto roi = data.view(offset.begin(), roiShape.begin());
+        writer.write(roi, offset.begin());
+        ASSERT_LE(writer.peakBytes(), maxBytes);
+        ASSERT_LE(writer.currentBytes(), maxBytes);
+        ASSERT_EQ(writer.numberOfBufferedChunks(), 1);
+
+        // write the rest of the data and check it
+        types::ShapeType offset2({8, 0, 0});
+        types::ShapeType roiShape2({shape_[0] - 8, shape_[1], shape_[2]});
+        auto roi2 = data.view(offset2.begin(), roiShape2.begin());
+        writer.write(roi2, offset2.begin());
+        ASSERT_LE(writer.peakBytes(), maxBytes);
+        writer.flush();
+        checkData(ds, data);
+    }
+
+
+    TEST_F(BufferedWriterTest, TestEdgeChunks) {
+        andres::Marray<float> data;
+        makeData(data);
+        // the shape is not a multiple of the chunk shape, so the zarr edge chunks
+        // reach over the dataset; they must be written as soon as the part in the
+        // dataset is complete, like all other chunks
+        auto ds = createDataset(pathZarr_, "float32", shape_, chunkShape_, true);
+        BufferedWriter<float> writer(*ds, 1024 * 1024 * 1024);
+        types::ShapeType sliceShape({1, shape_[1], shape_[2]});
+        for(size_t z = 0; z < shape_[0]; ++z) {
+            types::ShapeType offset({z, 0, 0});
+            auto slice = data.view(offset.begin(), sliceShape.begin());
+            writer.write(slice, offset.begin());
+            if((z + 1) % chunkShape_[0] == 0) {
+                ASSERT_EQ(writer.numberOfBufferedChunks(), 0);
+                ASSERT_EQ(writer.currentBytes(), 0);
+            }
+        }
+        checkData(ds, data);
+    }
+
+
+    TEST_F(BufferedWriterTest, TestFlush) {
+        auto ds = createDataset(pathZarr_, "float32", shape_, chunkShape_, true);
+        BufferedWriter<float> writer(*ds, 1024 * 1024 * 1024);
+
+        // write the first half of the first chunk
+        types::ShapeType offset({0, 0, 0});
+        types::ShapeType roiShape({8, 23, 17});
+        andres::Marray<float> data(roiShape.begin(), roiShape.end(), 1.);
+        writer.write(data, offset.begin());
+
+        // the chunk is buffered, but not written yet
+        handle::Chunk chunk(ds->handle(), types::ShapeType({0, 0, 0}), true);
+        ASSERT_FALSE(chunk.exists());
+        ASSERT_EQ(writer.numberOfBufferedChunks(), 1);
+
+        // completing the chunk writes it
+        types::ShapeType offset2({8, 0, 0});
+        writer.write(data, offset2.begin());
+        ASSERT_TRUE(chunk.exists());
+        ASSERT_EQ(writer.numberOfBufferedChunks(), 0);
+        ASSERT_EQ(writer.currentBytes(), 0);
+
+        // partial chunks are written by flush
+        types::ShapeType offset3({16, 0, 0});
+        writer.write(data, offset3.begin());
+        handle::Chunk chunk1(ds->handle(), types::ShapeType({1, 0, 0}), true);
+        ASSERT_FALSE(chunk1.exists());
+        writer.flush();
+        ASSERT_TRUE(chunk1.exists());
+
+        // check the data, values that were not written must have the fill value
+        types::ShapeType readShape({32, 23, 17});
+        andres::Marray<float> out(readShape.begin(), readShape.end());
+        readSubarray(ds, out, offset.begin());
+        for(size_t i = 0; i < 32; ++i) {
+            for(size_t j = 0; j < 23; ++j) {
+                for(size_t k = 0; k < 17; ++k) {
+                    ASSERT_EQ(out(i, j, k), (i < 24) ? 1. : 0.);
+                }
+            }
+        }
+    }
+
+}
+}
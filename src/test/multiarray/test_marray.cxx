@@ -92,7 +92,7 @@ namespace multiarray {
         }
 
         template<typename T>
-        void testArrayRead(std::unique_ptr<Dataset> & array) {
+        void testArrayRead(std::unique_ptr<Dataset> & array, const int numberOfThreads=1) {
             const auto & shape = array->shape();
 
             // load a completely overlapping array consisting of 8 chunks
@@ -100,7 +100,7 @@ namespace multiarray {
                 types::ShapeType offset({0, 0, 0});
                 types::ShapeType subShape({20, 20, 20});
                 andres::Marray<T> data(subShape.begin(), subShape.end());
-                readSubarray(array, data, offset.begin());
+                readSubarray(array, data, offset.begin(), numberOfThreads);
 
                 for(int i = 0; i < subShape[0]; ++i) {
                     for(int j = 0; j < subShape[1]; ++j) {
@@ -115,7 +115,7 @@ namespace multiarray {
             {
                 types::ShapeType offset({0, 0, 0});
                 andres::Marray<T> data(shape.begin(), shape.end());
-                readSubarray(array, data, offset.begin());
+                readSubarray(array, data, offset.begin(), numberOfThreads);
 
                 for(int i = 0; i < shape[0]; ++i) {
                     for(int j = 0; j < shape[1]; ++j) {
@@ -158,7 +158,7 @@ namespace multiarray {
                 //std::cout << sx << " " << sy << " " << sz << std::endl;
 
                 andres::Marray<T> data(shape.begin(), shape.end());
-                readSubarray(array, data, offset.begin());
+                readSubarray(array, data, offset.begin(), numberOfThreads);
 
                 for(int i = 0; i < shape[0]; ++i) {
                     for(int j = 0; j < shape[1]; ++j) {
@@ -172,7 +172,7 @@ namespace multiarray {
 
 
         template<typename T, typename DISTR>
-        void testArrayWriteRead(std::unique_ptr<Dataset> & array, DISTR & distr) {
+        void testArrayWriteRead(std::unique_ptr<Dataset> & array, DISTR & distr, const int numberOfThreads=1) {
 
             const auto & shape = array->shape();
             std::default_random_engine gen;
@@ -188,11 +188,11 @@ namespace multiarray {
                 for(auto it = dataIn.begin(); it != dataIn.end(); ++it) {
                     *it = draw();
                 }
-                writeSubarray(array, dataIn, offset.begin());
+                writeSubarray(array, dataIn, offset.begin(), numberOfThreads);
 
                 // read the out data
                 andres::Marray<T> dataOut(subShape.begin(), subShape.end());
-                readSubarray(array, dataOut, offset.begin());
+                readSubarray(array, dataOut, offset.begin(), numberOfThreads);
                 for(int i = 0; i < subShape[0]; ++i) {
                     for(int j = 0; j < subShape[1]; ++j) {
                         for(int k = 0; k < subShape[2]; ++k) {
@@ -211,11 +211,11 @@ namespace multiarray {
                 for(auto it = dataIn.begin(); it != dataIn.end(); ++it) {
                     *it = draw();
                 }
-                writeSubarray(array, dataIn, offset.begin());
+                writeSubarray(array, dataIn, offset.begin(), numberOfThreads);
 
                 // read the out data
                 andres::Marray<T> dataOut(shape.begin(), shape.end());
-                readSubarray(array, dataOut, offset.begin());
+                readSubarray(array, dataOut, offset.begin(), numberOfThreads);
 
                 for(int i = 0; i < shape[0]; ++i) {
                     for(int j = 0; j < shape[1]; ++j) {
@@ -260,11 +260,11 @@ namespace multiarray {
                 for(auto it = dataIn.begin(); it != dataIn.end(); ++it) {
                     *it = draw();
                 }
-                writeSubarray(array, dataIn, offset.begin());
+                writeSubarray(array, dataIn, offset.begin(), numberOfThreads);
 
                 // read the out data
                 andres::Marray<T> dataOut(shape.begin(), shape.end());
-                readSubarray(array, dataOut, offset.begin());
+                readSubarray(array, dataOut, offset.begin(), numberOfThreads);
 
                 for(int i = 0; i < shape[0]; ++i) {
                     for(int j = 0; j < shape[1]; ++j) {
@@ -378,5 +378,236 @@ namespace multiarray {
         std::uniform_real_distribution<float> distr(0., 1.);
         testArrayWriteRead<float>(array, distr);
     }
+
+
+    TEST_F(MarrayTest, TestReadParallel) {
+        auto array = openDataset(pathIntIrregular_);
+        testArrayRead<int32_t>(array, 4);
+    }
+
+
+    TEST_F(MarrayTest, TestWriteReadParallel) {
+        auto array = openDataset(pathFloatIrregular_);
+        std::uniform_real_distribution<float> distr(0., 1.);
+        testArrayWriteRead<float>(array, distr, 4);
+    }
+
+
+    TEST_F(MarrayTest, TestWriteReadThreadPool) {
+        auto array = openDataset(pathIntRegular_);
+        util::ThreadPool threadpool(3);
+
+        // write random data to an unaligned roi and read it back with the same pool
+        types::ShapeType offset({5, 13, 27});
+        types::ShapeType subShape({61, 42, 55});
+        std::default_random_engine gen;
+        std::uniform_int_distribution<int32_t> distr(-100, 100);
+        andres::Marray<int32_t> dataIn(subShape.begin(), subShape.end());
+        for(auto it = dataIn.begin(); it != dataIn.end(); ++it) {
+            *it = distr(gen);
+        }
+        writeSubarray(array, dataIn, offset.begin(), threadpool);
+
+        andres::Marray<int32_t> dataOut(subShape.begin(), subShape.end());
+        readSubarray(array, dataOut, offset.begin(), threadpool);
+        for(int i = 0; i < subShape[0]; ++i) {
+            for(int j = 0; j < subShape[1]; ++j) {
+                for(int k = 0; k < subShape[2]; ++k) {
+                    ASSERT_EQ(dataIn(i, j, k), dataOut(i, j, k));
+                }
+            }
+        }
+
+        // the data outside of the roi must not be touched by the partial writes
+        types::ShapeType fullOffset({0, 0, 0});
+        const auto & shape = array->shape();
+        andres::Marray<int32_t> full(shape.begin(), shape.end());
+        readSubarray(array, full, fullOffset.begin(), threadpool);
+        ASSERT_EQ(full(0, 0, 0), 42);
+        ASSERT_EQ(full(4, 13, 27), 42);
+        ASSERT_EQ(full(66, 54, 81), 42);
+        ASSERT_EQ(full(5, 13, 27), dataIn(0, 0, 0));
+    }
+
+
+    TEST_F(MarrayTest, TestReadPrefetch) {
+        auto array = openDataset(pathIntIrregular_);
+
+        // write random data to an unaligned roi, so that the chunks differ
+        types::ShapeType offset({5, 13, 27});
+        types::ShapeType subShape({61, 42, 55});
+        std::default_random_engine gen;
+        std::uniform_int_distribution<int32_t> distr(-100, 100);
+        andres::Marray<int32_t> dataIn(subShape.begin(), subShape.end());
+        for(auto it = dataIn.begin(); it != dataIn.end(); ++it) {
+            *it = distr(gen);
+        }
+        writeSubarray(array, dataIn, offset.begin());
+
+        auto checkRead = [&](const int numberOfThreads){
+            andres::Marray<int32_t> dataOut(subShape.begin(), subShape.end());
+            readSubarray(array, dataOut, offset.begin(), numberOfThreads);
+            for(auto itIn = dataIn.begin(), itOut = dataOut.begin(); itIn != dataIn.end(); ++itIn, ++itOut) {
+                ASSERT_EQ(*itIn, *itOut);
+            }
+        };
+
+        // a budget that is smaller than a single chunk still makes progress
+        array->setPrefetchSize(1);
+        array->setPrefetchThreads(1);
+        checkRead(1);
+        checkRead(3);
+
+        array->setPrefetchSize(1024 * 1024);
+        array->setPrefetchThreads(4);
+        ASSERT_EQ(array->prefetchSize(), 1024 * 1024);
+        ASSERT_EQ(array->prefetchThreads(), 4);
+        checkRead(1);
+        checkRead(3);
+
+        // chunks that are cached are not read ahead
+        array->setCacheSize(1024 * 1024 * 1024);
+        checkRead(1);
+        checkRead(1);
+        ASSERT_GT(array->cacheHits(), 0);
+        array->setCacheSize(0);
+
+        // prefetch the mapped chunks
+        array->setUseMmap(true);
+        checkRead(1);
+        checkRead(3);
+        array->setUseMmap(false);
+
+        ASSERT_THROW(array->setPrefetchThreads(0), std::runtime_error);
+    }
+
+
+    TEST_F(MarrayTest, TestWriteReadAligned) {
+        // requests that only span full chunks along the inner axes,
+        // the chunks are read / written directly from / to the marray
+        auto array = openDataset(pathIntRegular_);
+        types::ShapeType offset({20, 30, 40});
+        types::ShapeType subShape({30, 10, 10});
+
+        std::default_random_engine gen;
+        std::uniform_int_distribution<int32_t> distr(-100, 100);
+        andres::Marray<int32_t> dataIn(subShape.begin(), subShape.end());
+        for(auto it = dataIn.begin(); it != dataIn.end(); ++it) {
+            *it = distr(gen);
+        }
+        writeSubarray(array, dataIn, offset.begin());
+
+        // read with the aligned request
+        andres::Marray<int32_t> dataOut(subShape.begin(), subShape.end());
+        readSubarray(array, dataOut, offset.begin());
+        for(int i = 0; i < subShape[0]; ++i) {
+            for(int j = 0; j < subShape[1]; ++j) {
+                for(int k = 0; k < subShape[2]; ++k) {
+                    ASSERT_EQ(dataIn(i, j, k), dataOut(i, j, k));
+                }
+            }
+        }
+
+        // read with a larger request that goes through the buffer
+        types::ShapeType largeOffset({15, 25, 35});
+        types::ShapeType largeShape({40, 20, 20});
+        andres::Marray<int32_t> largeOut(largeShape.begin(), largeShape.end());
+        readSubarray(array, largeOut, largeOffset.begin());
+        for(int i = 0; i < largeShape[0]; ++i) {
+            for(int j = 0; j < largeShape[1]; ++j) {
+                for(int k = 0; k < largeShape[2]; ++k) {
+                    const bool inRoi = (i >= 5 && i < 35) && (j >= 5 && j < 15) && (k >= 5 && k < 15);
+                    const int32_t expected = inRoi ? dataIn(i - 5, j - 5, k - 5) : 42;
+                    ASSERT_EQ(largeOut(i, j, k), expected);
+                }
+            }
+        }
+    }
+
+
+    TEST_F(MarrayTest, TestWriteReadDimensions) {
+        std::default_random_engine gen;
+        std::uniform_int_distribution<int32_t> distr(-100, 100);
+
+        // 2d dataset, goes through the compile-time 2d kernels
+        {
+            const std::string path = "int_2d.zr";
+            types::ShapeType shape({100, 100});
+            types::ShapeType chunkShape({23, 17});
+            auto array = createDataset(path, "int32", shape, chunkShape, true);
+
+            types::ShapeType offset({7, 31});
+            types::ShapeType subShape({58, 46});
+            andres::Marray<int32_t> dataIn(subShape.begin(), subShape.end());
+            for(auto it = dataIn.begin(); it != dataIn.end(); ++it) {
+                *it = distr(gen);
+            }
+            writeSubarray(array, dataIn, offset.begin());
+
+            andres::Marray<int32_t> dataOut(subShape.begin(), subShape.end());
+            readSubarray(array, dataOut, offset.begin());
+            for(int i = 0; i < subShape[0]; ++i) {
+                for(int j = 0; j < subShape[1]; ++j) {
+                    ASSERT_EQ(dataIn(i, j), dataOut(i, j));
+                }
+            }
+            fs::remove_all(fs::path(path));
+        }
+
+        // 4d dataset, goes through the generic implementation
+        {
+            const std::string path = "int_4d.zr";
+            types::ShapeType shape({20, 20, 20, 20});
+            types::ShapeType chunkShape({7, 5, 6, 9});
+            auto array = createDataset(path, "int32", shape, chunkShape, true);
+
+            types::ShapeType offset({3, 2, 5, 1});
+            types::ShapeType subShape({15, 12, 9, 17});
+            andres::Marray<int32_t> dataIn(subShape.begin(), subShape.end());
+            for(auto it = dataIn.begin(); it != dataIn.end(); ++it) {
+                *it = distr(gen);
+            }
+            writeSubarray(array, dataIn, offset.begin());
+
+            andres::Marray<int32_t> dataOut(subShape.begin(), subShape.end());
+            readSubarray(array, dataOut, offset.begin());
+            for(auto itIn = dataIn.begin(), itOut = dataOut.begin(); itIn != dataIn.end(); ++itIn, ++itOut) {
+                ASSERT_EQ(*itIn, *itOut);
+            }
+            fs::remove_all(fs::path(path));
+        }
+
+        // 3d request into a strided view of a larger marray
+        {
+            auto array = openDataset(pathIntRegular_);
+            types::ShapeType offset({10, 20, 30});
+            types::ShapeType subShape({20, 20, 20});
+            types::ShapeType outerShape({30, 30, 30});
+            types::ShapeType outerOffset({5, 5, 5});
+
+            andres::Marray<int32_t> dataIn(subShape.begin(), subShape.end());
+            for(auto it = dataIn.begin(); it != dataIn.end(); ++it) {
+                *it = distr(gen);
+            }
+            andres::Marray<int32_t> outerIn(outerShape.begin(), outerShape.end(), 0);
+            auto viewIn = outerIn.view(outerOffset.begin(), subShape.begin());
+            viewIn = dataIn;
+            writeSubarray(array, viewIn, offset.begin());
+
+            andres::Marray<int32_t> outerOut(outerShape.begin(), outerShape.end(), 0);
+            auto viewOut = outerOut.view(outerOffset.begin(), subShape.begin());
+            readSubarray(array, viewOut, offset.begin());
+            for(int i = 0; i < subShape[0]; ++i) {
+                for(int j = 0; j < subShape[1]; ++j) {
+                    for(int k = 0; k < subShape[2]; ++k) {
+                        ASSERT_EQ(dataIn(i, j, k), viewOut(i, j, k));
+                    }
+                }
+            }
+            // the data outside of the view must not be touched
+            ASSERT_EQ(outerOut(0, 0, 0), 0);
+            ASSERT_EQ(outerOut(25, 25, 25), 0);
+        }
+    }
 }
 }
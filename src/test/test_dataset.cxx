@@ -1,5 +1,6 @@
 #include "gtest/gtest.h"
 
+#include <fstream>
 #include <random>
 
 #include "z5/metadata.hxx"
@@ -247,4 +248,276 @@ namespace z5 {
         }
     }
 
+
+    TEST_F(DatasetTest, ChunkCache) {
+
+        DatasetTyped<int> array(intHandle_);
+        // cache that can hold 2 chunks
+        array.setCacheSize(2 * size_ * sizeof(int));
+        ASSERT_EQ(array.cacheSize(), 2 * size_ * sizeof(int));
+
+        types::ShapeType chunk0({0, 0, 0});
+        types::ShapeType chunk1({0, 0, 1});
+        types::ShapeType chunk2({0, 1, 0});
+        array.writeChunk(chunk0, dataInt_);
+
+        // first read is a miss, second one a hit
+        int dataTmp[size_];
+        array.readChunk(chunk0, dataTmp);
+        array.readChunk(chunk0, dataTmp);
+        ASSERT_EQ(array.cacheMisses(), 1);
+        ASSERT_EQ(array.cacheHits(), 1);
+        for(size_t i = 0; i < size_; ++i) {
+            ASSERT_EQ(dataTmp[i], dataInt_[i]);
+        }
+
+        // writing the chunk must invalidate the cached chunk
+        int dataConst[size_];
+        std::fill(dataConst, dataConst + size_, 7);
+        array.writeChunk(chunk0, dataConst);
+        array.readChunk(chunk0, dataTmp);
+        ASSERT_EQ(array.cacheMisses(), 2);
+        for(size_t i = 0; i < size_; ++i) {
+            ASSERT_EQ(dataTmp[i], 7);
+        }
+
+        // reading two more chunks evicts the least recently used one (chunk0)
+        array.readChunk(chunk1, dataTmp);
+        array.readChunk(chunk2, dataTmp);
+        array.resetCacheCounters();
+        array.readChunk(chunk2, dataTmp);
+        array.readChunk(chunk1, dataTmp);
+        array.readChunk(chunk0, dataTmp);
+        ASSERT_EQ(array.cacheHits(), 2);
+        ASSERT_EQ(array.cacheMisses(), 1);
+        for(size_t i = 0; i < size_; ++i) {
+            ASSERT_EQ(dataTmp[i], 7);
+        }
+
+        // reading a chunk for the read-modify-write does not put it into the cache
+        array.clearCache();
+        array.readChunkForUpdate(chunk1, dataTmp);
+        array.resetCacheCounters();
+        array.readChunk(chunk1, dataTmp);
+        ASSERT_EQ(array.cacheHits(), 0);
+        ASSERT_EQ(array.cacheMisses(), 1);
+
+        // disable the cache
+        array.setCacheSize(0);
+        ASSERT_EQ(array.cacheSize(), 0);
+        array.readChunk(chunk0, dataTmp);
+        ASSERT_EQ(array.cacheHits(), 0);
+        ASSERT_EQ(array.cacheMisses(), 0);
+    }
+
+
+    TEST_F(DatasetTest, ChunkCacheWriteGeneration) {
+
+        util::ChunkCache<int> cache(2 * size_ * sizeof(int));
+        types::CoordinateType chunk0({0, 0, 0});
+        int dataTmp[size_];
+
+        // a reader gets the generation before reading the chunk,
+        // then the chunk is written concurrently and erased from the cache
+        const size_t generation = cache.writeGeneration(chunk0);
+        cache.erase(chunk0);
+        // the data the reader read is outdated and must not be cached
+        cache.put(chunk0, dataInt_, size_, generation);
+        ASSERT_FALSE(cache.contains(chunk0));
+        ASSERT_FALSE(cache.get(chunk0, dataTmp));
+
+        // data that was read after the write is cached
+        cache.put(chunk0, dataInt_, size_, cache.writeGeneration(chunk0));
+        ASSERT_TRUE(cache.get(chunk0, dataTmp));
+        for(size_t i = 0; i < size_; ++i) {
+            ASSERT_EQ(dataTmp[i], dataInt_[i]);
+        }
+    }
+
+
+    TEST_F(DatasetTest, MmapRead) {
+
+        DatasetTyped<int> array(intHandle_);
+        ASSERT_FALSE(array.useMmap());
+        array.setUseMmap(true);
+        ASSERT_TRUE(array.useMmap());
+
+        types::ShapeType chunk0({0, 0, 0});
+        types::ShapeType chunk1({0, 0, 1});
+        array.writeChunk(chunk0, dataInt_);
+
+        // read existing chunk
+        int dataTmp[size_];
+        array.readChunk(chunk0, dataTmp);
+        for(size_t i = 0; i < size_; ++i) {
+            ASSERT_EQ(dataTmp[i], dataInt_[i]);
+        }
+
+        // read chunk that does not exist
+        array.readChunk(chunk1, dataTmp);
+        for(size_t i = 0; i < size_; ++i) {
+            ASSERT_EQ(dataTmp[i], 42);
+        }
+
+        // an empty chunk file is invalid and must not be decoded
+        // from the buffer of the previous chunk
+        std::ofstream((intHandle_.path() / "0.0.1").string());
+        array.setUseMmap(false);
+        array.readChunk(chunk0, dataTmp);
+        ASSERT_THROW(array.readChunk(chunk1, dataTmp), std::runtime_error);
+        array.readChunk(chunk0, dataTmp);
+        array.setUseMmap(true);
+        ASSERT_THROW(array.readChunk(chunk1, dataTmp), std::runtime_error);
+    }
+
+    TEST_F(DatasetTest, CompressorThreads) {
+
+        DatasetTyped<int> array(intHandle_);
+        ASSERT_EQ(array.compressorThreads(), 1);
+        array.setCompressorThreads(4);
+        ASSERT_EQ(array.compressorThreads(), 4);
+
+        types::ShapeType chunk0({0, 0, 0});
+        array.writeChunk(chunk0, dataInt_);
+
+        int dataTmp[size_];
+        array.readChunk(chunk0, dataTmp);
+        for(size_t i = 0; i < size_; ++i) {
+            ASSERT_EQ(dataTmp[i], dataInt_[i]);
+        }
+    }
+
+
+    TEST_F(DatasetTest, IoStats) {
+
+        DatasetTyped<int> array(intHandle_);
+        types::ShapeType chunk0({0, 0, 0});
+        types::ShapeType chunk1({0, 0, 1});
+        array.writeChunk(chunk0, dataInt_);
+
+        int dataTmp[size_];
+        array.readChunk(chunk0, dataTmp);
+        array.readChunk(chunk1, dataTmp);
+
+        auto stats = array.ioStats();
+        #ifdef WITH_INSTRUMENTATION
+        ASSERT_EQ(stats.chunksWritten, 1);
+        ASSERT_EQ(stats.chunksRead, 1);
+        ASSERT_EQ(stats.chunksFilled, 1);
+        ASSERT_EQ(stats.uncompressedBytesWritten, size_ * sizeof(int));
+        ASSERT_EQ(stats.uncompressedBytesRead, size_ * sizeof(int));
+        ASSERT_GT(stats.compressedBytesWritten, 0);
+        // the chunk is read to a buffer of full elements
+        ASSERT_GE(stats.compressedBytesRead, stats.compressedBytesWritten);
+        ASSERT_LT(stats.compressedBytesRead, stats.compressedBytesWritten + sizeof(int));
+        ASSERT_GT(stats.readTime, 0.);
+        ASSERT_GT(stats.decompressTime, 0.);
+        ASSERT_GT(stats.compressTime, 0.);
+        ASSERT_GT(stats.writeTime, 0.);
+        #else
+        // without instrumentation nothing is recorded
+        ASSERT_EQ(stats.chunksWritten, 0);
+        ASSERT_EQ(stats.chunksRead, 0);
+        ASSERT_EQ(stats.readTime, 0.);
+        #endif
+
+        array.resetIoStats();
+        stats = array.ioStats();
+        ASSERT_EQ(stats.chunksWritten, 0);
+        ASSERT_EQ(stats.chunksRead, 0);
+        ASSERT_EQ(stats.chunksFilled, 0);
+        ASSERT_EQ(stats.compressedBytesRead, 0);
+        ASSERT_EQ(stats.readTime, 0.);
+    }
+
+
+    TEST_F(DatasetTest, ChunkUniqueValues) {
+
+        // fallback for compressors without fast path
+        DatasetTyped<int> array(intHandle_);
+        types::ShapeType chunk0({0, 0, 0});
+        array.writeChunk(chunk0, dataInt_);
+        std::vector<int> values;
+        readChunkUniqueValues(array, chunk0, values);
+        std::vector<int> expected(dataInt_, dataInt_ + size_);
+        std::sort(expected.begin(), expected.end());
+        expected.erase(std::unique(expected.begin(), expected.end()), expected.end());
+        ASSERT_EQ(values, expected);
+
+        // chunk that does not exist
+        readChunkUniqueValues(array, types::ShapeType({0, 0, 1}), values);
+        ASSERT_EQ(values, std::vector<int>({42}));
+
+        // compressed segmentation for zarr and N5, the N5 dataset has truncated chunks
+        std::vector<uint64_t> labels(size_);
+        for(size_t i = 0; i < size_; ++i) {
+            labels[i] = (uint64_t(1) << 40) + (i / 128) * 3;
+        }
+        for(const bool isZarr : {true, false}) {
+            handle::Dataset h(isZarr ? "array_int1.zr" : "array_int1.n5");
+            DatasetMetadata labelMeta(types::uint64, types::ShapeType({25, 25, 25}),
+                                      types::ShapeType({10, 10, 10}), isZarr, 0, types::compressedSegmentation);
+            DatasetTyped<uint64_t> labelArray(h, labelMeta);
+            ASSERT_EQ(labelArray.getCompressor(), types::compressedSegmentation);
+
+            std::vector<uint64_t> labelValues, labelTmp(size_);
+            for(const auto & chunkId : {types::ShapeType({0, 0, 0}), types::ShapeType({2, 2, 2})}) {
+                const size_t chunkSize = labelArray.getChunkSize(chunkId);
+                labelArray.writeChunk(chunkId, labels.data());
+                labelArray.readChunk(chunkId, labelTmp.data());
+                for(size_t i = 0; i < chunkSize; ++i) {
+                    ASSERT_EQ(labelTmp[i], labels[i]);
+                }
+
+                readChunkUniqueValues(labelArray, chunkId, labelValues);
+                std::vector<uint64_t> labelExpected(labels.begin(), labels.begin() + chunkSize);
+                labelExpected.erase(std::unique(labelExpected.begin(), labelExpected.end()), labelExpected.end());
+                ASSERT_EQ(labelValues, labelExpected);
+            }
+
+            // the block shape is stored in the metadata
+            DatasetMetadata readMeta;
+            readMetadata(h, readMeta);
+            ASSERT_EQ(readMeta.compressor, types::compressedSegmentation);
+            ASSERT_EQ(readMeta.compressorBlockShape, types::ShapeType({8, 8, 8}));
+            fs::remove_all(h.path());
+        }
+    }
+
+
+    TEST_F(DatasetTest, ChunkUniqueValuesHighCardinality) {
+
+        // random labels, the encoded chunk is larger than the raw chunk
+        std::vector<uint64_t> labels(size_);
+        std::default_random_engine generator;
+        std::uniform_int_distribution<uint64_t> distribution(0, uint64_t(1) << 50);
+        for(auto & label : labels) {
+            label = distribution(generator);
+        }
+        std::vector<uint64_t> labelExpected(labels);
+        std::sort(labelExpected.begin(), labelExpected.end());
+        labelExpected.erase(std::unique(labelExpected.begin(), labelExpected.end()), labelExpected.end());
+
+        const types::ShapeType chunkId({0, 0, 0});
+        for(const bool isZarr : {true, false}) {
+            handle::Dataset h(isZarr ? "array_int1.zr" : "array_int1.n5");
+            DatasetMetadata labelMeta(types::uint64, types::ShapeType({10, 10, 10}),
+                                      types::ShapeType({10, 10, 10}), isZarr, 0, types::compressedSegmentation);
+            DatasetTyped<uint64_t> labelArray(h, labelMeta);
+            labelArray.writeChunk(chunkId, labels.data());
+
+            std::vector<uint64_t> labelTmp(size_);
+            for(const bool useMmap : {false, true}) {
+                labelArray.setUseMmap(useMmap);
+                labelArray.readChunk(chunkId, labelTmp.data());
+                ASSERT_EQ(labelTmp, labels);
+            }
+
+            std::vector<uint64_t> labelValues;
+            readChunkUniqueValues(labelArray, chunkId, labelValues);
+            ASSERT_EQ(labelValues, labelExpected);
+            fs::remove_all(h.path());
+        }
+    }
+
 }
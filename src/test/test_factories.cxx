@@ -165,4 +165,57 @@ namespace z5 {
 
     }
 
+
+    #ifdef WITH_ZFP
+    TEST_F(FactoryTest, CreateZfp) {
+        std::default_random_engine generator;
+        std::uniform_real_distribution<float> distribution(0., 1.);
+        float data[SIZE];
+        for(size_t i = 0; i < SIZE; ++i) {
+            data[i] = distribution(generator);
+        }
+
+        for(const bool isZarr : {true, false}) {
+            // the fixed accuracy mode
+            const double tolerance = 1e-3;
+            auto array = createDataset(
+                handle_.path().string(), "float32",
+                types::ShapeType({100, 100, 100}), types::ShapeType({10, 10, 10}),
+                isZarr, 0, "zfp", "", 5, 1, 0, tolerance
+            );
+            ASSERT_EQ(array->getCompressor(), types::zfp);
+
+            DatasetMetadata metadata;
+            readMetadata(handle_, metadata);
+            ASSERT_EQ(metadata.zfpMode(), 4);
+            ASSERT_EQ(metadata.compressorTolerance, tolerance);
+
+            array->writeChunk(types::ShapeType({0, 0, 0}), data);
+            float dataOut[SIZE];
+            array->readChunk(types::ShapeType({0, 0, 0}), dataOut);
+            for(size_t i = 0; i < SIZE; ++i) {
+                ASSERT_NEAR(data[i], dataOut[i], tolerance);
+            }
+            fs::remove_all(handle_.path());
+
+            // the fixed rate and precision modes
+            createDataset(handle_.path().string(), "float32",
+                          types::ShapeType({100, 100, 100}), types::ShapeType({10, 10, 10}),
+                          isZarr, 0, "zfp", "", 5, 1, 0, -1, 8);
+            readMetadata(handle_, metadata);
+            ASSERT_EQ(metadata.zfpMode(), 2);
+            ASSERT_EQ(metadata.compressorRate, 8);
+            fs::remove_all(handle_.path());
+
+            createDataset(handle_.path().string(), "float32",
+                          types::ShapeType({100, 100, 100}), types::ShapeType({10, 10, 10}),
+                          isZarr, 0, "zfp", "", 5, 1, 0, -1, -1, 16);
+            readMetadata(handle_, metadata);
+            ASSERT_EQ(metadata.zfpMode(), 3);
+            ASSERT_EQ(metadata.compressorPrecision, 16);
+            fs::remove_all(handle_.path());
+        }
+    }
+    #endif
+
 }
@@ -155,6 +155,22 @@ namespace z5 {
     }
 
 
+    TEST_F(MetadataTest, WriteReadMetadataRaw) {
+        fs::path mdata("array.zr/.zarray");
+        fs::remove(mdata);
+
+        DatasetMetadata metaWrite(types::uint8, {100, 100, 100}, {10, 10, 10}, true, 0, types::raw);
+        handle::Dataset h("array.zr");
+        writeMetadata(h, metaWrite);
+        ASSERT_TRUE(fs::exists(mdata));
+
+        DatasetMetadata metaRead;
+        readMetadata(h, metaRead);
+        ASSERT_EQ(metaRead.compressor, types::raw);
+        ASSERT_EQ(metaRead.dtype, types::uint8);
+    }
+
+
     TEST_F(MetadataTest, WriteReadMetadataN5) {
         fs::path mdata("array.n5/attributes.json");
         fs::remove(mdata);
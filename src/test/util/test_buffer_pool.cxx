@@ -0,0 +1,72 @@
+#include "gtest/gtest.h"
+
+#include <thread>
+
+#include "z5/util/buffer_pool.hxx"
+
+namespace z5 {
+namespace util {
+
+    TEST(BufferPoolTest, TestReuse) {
+        const float * ptr;
+        {
+            auto buffer = BufferPool<float>::acquire(1000);
+            ASSERT_EQ(buffer.size(), 1000);
+            ptr = buffer.data();
+        }
+        ASSERT_EQ(BufferPool<float>::numberOfFreeBuffers(), 1);
+
+        // the released buffer is handed out again without a new allocation
+        {
+            auto buffer = BufferPool<float>::acquire(500);
+            ASSERT_EQ(buffer.size(), 500);
+            ASSERT_EQ(buffer.data(), ptr);
+            ASSERT_EQ(BufferPool<float>::numberOfFreeBuffers(), 0);
+
+            // nested buffers are distinct
+            auto other = BufferPool<float>::acquire(1000);
+            ASSERT_NE(other.data(), buffer.data());
+        }
+        ASSERT_EQ(BufferPool<float>::numberOfFreeBuffers(), 2);
+    }
+
+
+    TEST(BufferPoolTest, TestKeepSize) {
+        {
+            auto buffer = BufferPool<int>::acquire(100);
+            buffer.data()[99] = 42;
+        }
+
+        // without a size, the buffer keeps its size and values
+        {
+            auto buffer = BufferPool<int>::acquire();
+            ASSERT_EQ(buffer.size(), 100);
+            ASSERT_EQ(buffer.data()[99], 42);
+        }
+
+        // a new buffer is empty
+        {
+            auto buffer = BufferPool<int>::acquire();
+            auto other = BufferPool<int>::acquire();
+            ASSERT_EQ(other.size(), 0);
+        }
+    }
+
+
+    TEST(BufferPoolTest, TestThreadLocal) {
+        {
+            auto buffer = BufferPool<double>::acquire(10);
+        }
+        ASSERT_EQ(BufferPool<double>::numberOfFreeBuffers(), 1);
+
+        // other threads have their own pool
+        size_t nFree = 0;
+        std::thread thread([&nFree](){
+            nFree = BufferPool<double>::numberOfFreeBuffers();
+        });
+        thread.join();
+        ASSERT_EQ(nFree, 0);
+    }
+
+}
+}
@@ -0,0 +1,98 @@
+#include "gtest/gtest.h"
+
+#include <random>
+#include <vector>
+
+#include "z5/util/util.hxx"
+
+namespace z5 {
+namespace util {
+
+    // compare the vectorized byteswap against the scalar implementation,
+    // sizes are chosen so that the remainders of the vector loops are hit
+    template<typename T>
+    void testByteswap() {
+        std::default_random_engine generator;
+        std::uniform_int_distribution<int> distribution(0, 255);
+        for(size_t size : {0, 1, 3, 7, 15, 16, 17, 33, 100, 1001}) {
+            std::vector<T> data(size);
+            unsigned char * bytes = reinterpret_cast<unsigned char *>(data.data());
+            for(size_t i = 0; i < size * sizeof(T); ++i) {
+                bytes[i] = distribution(generator);
+            }
+
+            std::vector<T> expected(data);
+            reverseEndiannessInplace<T>(expected.begin(), expected.end());
+
+            // copy and swap
+            std::vector<T> out(size);
+            reverseEndianness(data.data(), out.data(), size);
+            ASSERT_EQ(std::memcmp(out.data(), expected.data(), size * sizeof(T)), 0);
+
+            // swap inplace
+            reverseEndiannessInplace(data.data(), size);
+            ASSERT_EQ(std::memcmp(data.data(), expected.data(), size * sizeof(T)), 0);
+        }
+    }
+
+    TEST(ByteswapTest, Uint8) {
+        testByteswap<uint8_t>();
+    }
+
+    TEST(ByteswapTest, Int16) {
+        testByteswap<int16_t>();
+    }
+
+    TEST(ByteswapTest, Uint32) {
+        testByteswap<uint32_t>();
+    }
+
+    TEST(ByteswapTest, Float) {
+        testByteswap<float>();
+    }
+
+    TEST(ByteswapTest, Uint64) {
+        testByteswap<uint64_t>();
+    }
+
+    TEST(ByteswapTest, Double) {
+        testByteswap<double>();
+    }
+
+    TEST(ByteswapTest, Generic) {
+        // 3 byte type to test the fallback
+        struct Bytes3 {unsigned char b[3];};
+        testByteswap<Bytes3>();
+    }
+
+    TEST(ByteswapTest, Kernels) {
+        // check all kernels that are supported by this cpu explicitly
+        std::vector<uint64_t> data(101);
+        for(size_t i = 0; i < data.size(); ++i) {
+            data[i] = 0x0102030405060708ull * (i + 1);
+        }
+        std::vector<uint64_t> expected(data);
+        reverseEndiannessInplace<uint64_t>(expected.begin(), expected.end());
+        std::vector<uint64_t> out(data.size());
+
+        const char * in = reinterpret_cast<const char *>(data.data());
+        char * outBytes = reinterpret_cast<char *>(out.data());
+        byteswap_detail::swapScalar<8>(in, outBytes, data.size());
+        ASSERT_EQ(out, expected);
+
+        #ifdef Z5_BYTESWAP_X86
+        if(__builtin_cpu_supports("ssse3")) {
+            std::fill(out.begin(), out.end(), 0);
+            byteswap_detail::swapSSSE3<8>(in, outBytes, data.size());
+            ASSERT_EQ(out, expected);
+        }
+        if(__builtin_cpu_supports("avx2")) {
+            std::fill(out.begin(), out.end(), 0);
+            byteswap_detail::swapAVX2<8>(in, outBytes, data.size());
+            ASSERT_EQ(out, expected);
+        }
+        #endif
+    }
+
+}
+}
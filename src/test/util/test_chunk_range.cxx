@@ -0,0 +1,90 @@
+#include "gtest/gtest.h"
+
+#include <set>
+
+#include "z5/util/util.hxx"
+
+namespace z5 {
+namespace util {
+
+    TEST(ChunkRangeTest, COrder) {
+        types::ShapeType minCoords({1, 0, 2});
+        types::ShapeType maxCoords({3, 1, 4});
+        ChunkRange range(minCoords, maxCoords);
+        ASSERT_EQ(range.size(), 3 * 2 * 3);
+
+        // compare to nested loops
+        std::vector<types::ShapeType> expected;
+        for(size_t x = 1; x <= 3; ++x) {
+            for(size_t y = 0; y <= 1; ++y) {
+                for(size_t z = 2; z <= 4; ++z) {
+                    expected.emplace_back(types::ShapeType({x, y, z}));
+                }
+            }
+        }
+
+        size_t index = 0;
+        types::ShapeType chunkId;
+        for(const auto & coord : range) {
+            ASSERT_EQ(coord, expected[index]);
+            range.chunkAt(index, chunkId);
+            ASSERT_EQ(chunkId, expected[index]);
+            ++index;
+        }
+        ASSERT_EQ(index, expected.size());
+    }
+
+
+    TEST(ChunkRangeTest, HighDimensional) {
+        // the old grid had a broken 5d loop and did not support more than 5 dimensions
+        for(size_t nDim = 1; nDim <= 7; ++nDim) {
+            types::ShapeType minCoords(nDim, 1);
+            types::ShapeType maxCoords(nDim, 2);
+
+            std::vector<types::ShapeType> grid;
+            makeRegularGrid(minCoords, maxCoords, grid);
+            ASSERT_EQ(grid.size(), 1 << nDim);
+
+            std::set<types::ShapeType> unique(grid.begin(), grid.end());
+            ASSERT_EQ(unique.size(), grid.size());
+            for(const auto & coord : grid) {
+                for(size_t d = 0; d < nDim; ++d) {
+                    ASSERT_TRUE(coord[d] == 1 || coord[d] == 2);
+                }
+            }
+        }
+    }
+
+
+    TEST(ChunkRangeTest, MortonOrder) {
+        // for a 2 x 2 block, the z-order is the same as c-order
+        ChunkRange small(types::ShapeType({0, 0}), types::ShapeType({1, 1}), mortonOrder);
+        std::vector<types::ShapeType> chunks;
+        small.toVector(chunks);
+        ASSERT_EQ(chunks, std::vector<types::ShapeType>({{0, 0}, {0, 1}, {1, 0}, {1, 1}}));
+
+        // for 4 x 4 the second 2 x 2 block comes before the second row
+        ChunkRange square(types::ShapeType({0, 0}), types::ShapeType({3, 3}), mortonOrder);
+        chunks.clear();
+        square.toVector(chunks);
+        ASSERT_EQ(chunks[4], types::ShapeType({0, 2}));
+        ASSERT_EQ(chunks[8], types::ShapeType({2, 0}));
+
+        // irregular range with offset: every chunk must be visited exactly once
+        types::ShapeType minCoords({3, 5, 0});
+        types::ShapeType maxCoords({7, 5, 10});
+        ChunkRange range(minCoords, maxCoords, mortonOrder);
+        ASSERT_EQ(range.size(), 5 * 1 * 11);
+        chunks.clear();
+        range.toVector(chunks);
+        ASSERT_EQ(chunks.size(), range.size());
+        ASSERT_EQ(chunks.front(), minCoords);
+
+        std::vector<types::ShapeType> expected;
+        ChunkRange(minCoords, maxCoords).toVector(expected);
+        std::sort(chunks.begin(), chunks.end());
+        ASSERT_EQ(chunks, expected);
+    }
+
+}
+}
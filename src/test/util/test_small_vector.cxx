@@ -0,0 +1,69 @@
+#include "gtest/gtest.h"
+
+#include <map>
+
+#include "z5/types/types.hxx"
+
+namespace z5 {
+namespace util {
+
+    TEST(SmallVectorTest, Inline) {
+        types::CoordinateType coord({1, 2, 3});
+        ASSERT_EQ(coord.size(), 3);
+        ASSERT_EQ(coord[0], 1);
+        ASSERT_EQ(coord[2], 3);
+
+        coord.resize(5, 7);
+        ASSERT_EQ(coord, types::CoordinateType({1, 2, 3, 7, 7}));
+        coord.push_back(8);
+        ASSERT_EQ(coord.back(), 8);
+        coord.resize(2);
+        ASSERT_EQ(coord, types::CoordinateType({1, 2}));
+    }
+
+
+    TEST(SmallVectorTest, Heap) {
+        // more elements than the inline capacity
+        const size_t n = types::CoordinateType::inlineCapacity() + 4;
+        types::CoordinateType coord;
+        for(size_t i = 0; i < n; ++i) {
+            coord.push_back(i);
+        }
+        ASSERT_EQ(coord.size(), n);
+        for(size_t i = 0; i < n; ++i) {
+            ASSERT_EQ(coord[i], i);
+        }
+
+        types::CoordinateType copy(coord);
+        ASSERT_EQ(copy, coord);
+
+        // go back to the inline storage
+        coord.resize(3);
+        ASSERT_EQ(coord, types::CoordinateType({0, 1, 2}));
+        copy = coord;
+        ASSERT_EQ(copy, coord);
+    }
+
+
+    TEST(SmallVectorTest, Conversion) {
+        types::ShapeType shape({4, 5, 6});
+        types::CoordinateType coord(shape);
+        ASSERT_EQ(coord, shape);
+        ASSERT_EQ(shape, coord);
+
+        types::ShapeType back = coord;
+        ASSERT_EQ(back, shape);
+
+        types::CoordinateType other({4, 5, 7});
+        ASSERT_TRUE(coord != other);
+        ASSERT_TRUE(coord < other);
+
+        // coordinates can be used as map keys
+        std::map<types::CoordinateType, int> map;
+        map[coord] = 1;
+        map[other] = 2;
+        ASSERT_EQ(map.at(shape), 1);
+    }
+
+}
+}
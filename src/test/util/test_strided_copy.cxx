@@ -0,0 +1,108 @@
+#include "gtest/gtest.h"
+
+#include <random>
+#include <vector>
+
+#include "z5/util/strided_copy.hxx"
+
+namespace z5 {
+namespace util {
+
+    // strides of an array with the given shape in C or F order
+    inline std::vector<size_t> makeStrides(const std::vector<size_t> & shape, const bool cOrder) {
+        const int dim = shape.size();
+        std::vector<size_t> strides(dim);
+        if(cOrder) {
+            strides[dim - 1] = 1;
+            for(int d = dim - 2; d >= 0; --d) {
+                strides[d] = strides[d + 1] * shape[d + 1];
+            }
+        } else {
+            strides[0] = 1;
+            for(int d = 1; d < dim; ++d) {
+                strides[d] = strides[d - 1] * shape[d - 1];
+            }
+        }
+        return strides;
+    }
+
+
+    // copy random sub-regions between random arrays and compare
+    // with an element-wise copy
+    TEST(StridedCopyTest, TestCopyAndFill) {
+        std::default_random_engine gen;
+        for(int iter = 0; iter < 1000; ++iter) {
+            const unsigned dim = 1 + gen() % 4;
+            const bool cOrderSrc = gen() % 4 != 0;
+            const bool cOrderDst = gen() % 4 != 0;
+
+            // draw the array shapes, the region shape and the region offsets
+            std::vector<size_t> shape(dim), srcShape(dim), dstShape(dim), srcBegin(dim), dstBegin(dim);
+            for(unsigned d = 0; d < dim; ++d) {
+                shape[d] = 1 + gen() % 6;
+                srcShape[d] = shape[d] + ((gen() % 2) ? 0 : gen() % 3);
+                dstShape[d] = shape[d] + ((gen() % 2) ? 0 : gen() % 3);
+                srcBegin[d] = gen() % (srcShape[d] - shape[d] + 1);
+                dstBegin[d] = gen() % (dstShape[d] - shape[d] + 1);
+            }
+            const auto srcStrides = makeStrides(srcShape, cOrderSrc);
+            const auto dstStrides = makeStrides(dstShape, cOrderDst);
+
+            size_t srcSize = 1, dstSize = 1, regionSize = 1, srcOffset = 0, dstOffset = 0;
+            for(unsigned d = 0; d < dim; ++d) {
+                srcSize *= srcShape[d];
+                dstSize *= dstShape[d];
+                regionSize *= shape[d];
+                srcOffset += srcBegin[d] * srcStrides[d];
+                dstOffset += dstBegin[d] * dstStrides[d];
+            }
+
+            std::vector<int> src(srcSize);
+            for(size_t i = 0; i < srcSize; ++i) {
+                src[i] = i;
+            }
+            std::vector<int> dst(dstSize, -1), expected(dstSize, -1);
+
+            // element-wise reference copy
+            std::vector<size_t> coord(dim);
+            for(size_t i = 0; i < regionSize; ++i) {
+                size_t remainder = i;
+                for(int d = dim - 1; d >= 0; --d) {
+                    coord[d] = remainder % shape[d];
+                    remainder /= shape[d];
+                }
+                size_t srcPos = srcOffset, dstPos = dstOffset;
+                for(unsigned d = 0; d < dim; ++d) {
+                    srcPos += coord[d] * srcStrides[d];
+                    dstPos += coord[d] * dstStrides[d];
+                }
+                expected[dstPos] = src[srcPos];
+            }
+
+            copyStridedRegion(src.data() + srcOffset, srcStrides.data(),
+                              dst.data() + dstOffset, dstStrides.data(),
+                              shape.data(), dim);
+            ASSERT_EQ(dst, expected);
+
+            // fill the same region and compare
+            std::vector<int> filled(dstSize, -1);
+            fillStridedRegion(filled.data() + dstOffset, dstStrides.data(), shape.data(), dim, 42);
+            for(size_t i = 0; i < dstSize; ++i) {
+                ASSERT_EQ(filled[i], expected[i] == -1 ? -1 : 42);
+            }
+        }
+    }
+
+
+    TEST(StridedCopyTest, TestEmpty) {
+        std::vector<int> src(10, 1), dst(10, 0);
+        const std::vector<size_t> shape({0, 5});
+        const std::vector<size_t> strides({5, 1});
+        copyStridedRegion(src.data(), strides.data(), dst.data(), strides.data(), shape.data(), 2);
+        for(const int val : dst) {
+            ASSERT_EQ(val, 0);
+        }
+    }
+
+}
+}
@@ -0,0 +1,77 @@
+#include "gtest/gtest.h"
+
+#include <sstream>
+#include <thread>
+
+#include "json.hpp"
+#include "z5/util/trace.hxx"
+
+namespace z5 {
+namespace util {
+
+    TEST(TraceTest, TestDisabled) {
+        auto & tracer = Tracer::instance();
+        tracer.disable();
+        tracer.clear();
+        {
+            TraceScope trace("read");
+        }
+        std::vector<TraceEvent> events;
+        std::vector<size_t> tids;
+        tracer.events(events, tids);
+        ASSERT_TRUE(events.empty());
+    }
+
+
+    TEST(TraceTest, TestEvents) {
+        auto & tracer = Tracer::instance();
+        tracer.enable();
+        tracer.clear();
+
+        const types::CoordinateType chunkId({1, 2, 3});
+        {
+            TraceScope outer("read_chunk", chunkId);
+            TraceScope inner("decompress");
+            inner.stop();
+            // stopping twice only records one event
+            inner.stop();
+        }
+        std::thread worker([](){
+            TraceScope trace("copy");
+        });
+        worker.join();
+        tracer.disable();
+
+        std::vector<TraceEvent> events;
+        std::vector<size_t> tids;
+        tracer.events(events, tids);
+        ASSERT_EQ(events.size(), 3);
+
+        // the events of a thread are recorded in the order they end
+        ASSERT_EQ(std::string(events[0].name), "decompress");
+        ASSERT_EQ(std::string(events[1].name), "read_chunk");
+        ASSERT_EQ(events[1].chunkId, chunkId);
+        ASSERT_LE(events[1].begin, events[0].begin);
+        ASSERT_GE(events[1].end, events[0].end);
+        ASSERT_EQ(tids[0], tids[1]);
+
+        ASSERT_EQ(std::string(events[2].name), "copy");
+        ASSERT_NE(tids[2], tids[0]);
+
+        // the chrome trace must be valid json
+        std::stringstream ss;
+        tracer.writeChromeTrace(ss);
+        const auto trace = nlohmann::json::parse(ss.str());
+        const auto & traceEvents = trace["traceEvents"];
+        ASSERT_EQ(traceEvents.size(), 3);
+        ASSERT_EQ(traceEvents[1]["name"], "read_chunk");
+        ASSERT_EQ(traceEvents[1]["ph"], "X");
+        ASSERT_EQ(traceEvents[1]["args"]["chunk"], "1.2.3");
+
+        tracer.clear();
+        tracer.events(events, tids);
+        ASSERT_TRUE(events.empty());
+    }
+
+}
+}